@@ -4,7 +4,7 @@
  * Copyright: This program is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation with the author information being cited
  *
  * Discription: 
- *      This file includes the source code of the tool, DoA, which can be used to analyze the simulation results of FDS files created by the other tool, GenFiles. the analysis results are stored into FDS_DoA which includes anything simulated, FDS_RSM which includes the information needed for RSM (response surface method) analysis, FDS_CMB which includes the combined fire scenario results and the comparison between FDS simulation results, SMM(sensitivity matrix method) prediction and the RSM prediction, FDS_SenMat which includes the sensitivity matrix details, FDS_RSMResults which includes the power curve fitting parameters of RSM, and SenMatx which is a 2D string array including only the sensitivity matrix. 
+ *      This file includes the source code of the tool, DoA, which can be used to analyze the simulation results of FDS files created by the other tool, GenFiles. the analysis results are stored into FDS_DoA which includes anything simulated, FDS_RSM which includes the information needed for RSM (response surface method) analysis, FDS_CMB which includes the combined fire scenario results and the comparison between FDS simulation results, SMM(sensitivity matrix method) prediction and the RSM prediction, FDS_SenMat which includes the sensitivity matrix details, FDS_RSMResults which includes the power curve fitting parameters of RSM, and SenMatxNum which is a numeric array including only the sensitivity matrix. 
  *
  * How to Run this tool: ./DoA SM_Info.txt
  *
@@ -16,8 +16,11 @@
  ***************************************************************************************************************************************************/
 
 #include "FirePM.h"
+#include <pthread.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/inotify.h>
 
-struct ThreeDCoordinate ThreeDC[3]; //to store the 3d coordinates;
 struct SMInfo FDS_SmInfo[MAXLINENUM]; //to store the input initial configuration  file (SM_Info.txt in this case )
 struct DoAlxInfo FDS_DoA[MAXLINENUM]; //to store the calculated the outputnewvalue based on the configuration file information
 struct DoAlxInfo FDS_RSM[MAXLINENUM]; //to store information refined from the FDS_DoA for Response Surface Method (RSM)
@@ -87,7 +90,8 @@ int GetDirList( struct SMInfo *_si, char _dl[][100] )
 }
 
 /* ************************************************************************************************************************************************
- * Functions: check if a file is what we need because we are only dealing with devc or evac csv files
+ * Functions: check if a file is what we need because we are only dealing with devc or evac csv files. the compressed csv files (*.csv.gz,
+ *            *.csv.zst) are also accepted, they are streamed through the decompressor by DevcOpen()
  * _fn: input parameter indication a fire name
  * Return: 0: Yes, this file may be useful, -1: No, we don't need this file
  *************************************************************************************************************************************************/
@@ -171,16 +175,629 @@ int getInputBaseValue( char *_Ibv, struct SMInfo _single_si )
     return -1;
 }
 
+/************************************************************************************************************************************************
+ * the campaign manifest of DoA (-m): the DoA records built from every csv file are saved in DOAMANIFEST together with the size, the last
+ * modified time and the FNV-1a hash of the csv file. in the next run a csv file whose size and time (or, if only the time is changed, whose
+ * content) are the same reuses its records instead of being parsed again, so a re-analysis only costs the new or changed FDS runs.
+ * the manifest is dropped as a whole when SM_Info.txt, the base case or the output base values found in its csv files (FDS_BaseOutputs, they
+ * are saved in every record) are changed since every record depends on them
+ ***********************************************************************************************************************************************/
+#define DOAMANIFEST "DoA.manifest"
+#define DOAMANIFESTMAGIC "FPMMANI"
+#define DOAMANIFESTVERSION 1
+
+int DoAManifestMode = 0; // 1: use the manifest, set by the option -m
+
+struct DoAManifestHead
+{
+    char magic[8];     // DOAMANIFESTMAGIC
+    int version;       // DOAMANIFESTVERSION
+    int rec_size;      // sizeof(struct DoAlxInfo)
+    unsigned long key; // the hash of SM_Info.txt, the base case and the output base values
+    long num;          // the number of entries following this structure
+};
+
+struct DoAManifestRecord
+{
+    long csv_len;       // the length of the csv file name following this structure
+    long size;          // the size of the csv file
+    long mtime;         // the last modified time of the csv file
+    unsigned long hash; // the FNV-1a hash of the csv file
+    int rt;             // 0: the csv file builds n DoA records, 1: the csv file is not what we need (CheckCSV())
+    int n;              // the number of DoA records following the csv file name
+};
+
+struct DoAManifestEntry
+{
+    struct DoAManifestRecord r;
+    char *csv;              // the csv file name
+    struct DoAlxInfo *DoA;  // the DoA records built from the csv file
+    int used;               // 1: the csv file is seen in this run, only these entries are saved
+};
+
+struct DoAManifest
+{
+    unsigned long key;
+    long num;
+    long cap;
+    struct DoAManifestEntry *entries;
+};
+
+struct DoAManifest DoAMani;
+
+/*************************************************************************************************************************************************
+ * Function: get the size, the last modified time and (if _hash is not NULL) the FNV-1a hash of a csv file. the sidecar is used if the csv
+ *           file is replaced by its sidecar (DoA -a)
+ * _fn: input parameter indicating the csv file name
+ * _r: output parameter holding the size, the time and the hash
+ * _hash: input parameter, 1: calculate the hash, 0: no
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAFileStamp( const char *_fn, struct DoAManifestRecord *_r, int _hash )
+{
+    char tmp_fn[MAXSTRINGSIZE];
+    struct stat tmp_st;
+    struct MapFile tmp_mf;
+
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    sprintf( tmp_fn, "%s", _fn );
+    if( stat(tmp_fn, &tmp_st) != 0 )
+    {
+        sprintf( tmp_fn, "%s%s", _fn, DEVCCACHESUFFIX );
+        if( stat(tmp_fn, &tmp_st) != 0 )
+        {
+            printf( "DoAFileStamp() error: stat [%s] failed!\n", _fn );
+            return -1;
+        }
+    }
+    _r->size = (long)tmp_st.st_size;
+    _r->mtime = (long)tmp_st.st_mtime;
+    if( _hash == 0 )
+        return 0;
+    if( _r->size == 0 ) // an empty file can't be mapped
+    {
+        _r->hash = HashFNV1a( "", 0 );
+        return 0;
+    }
+    if( MapFileOpen(tmp_fn, &tmp_mf) != 0 )
+        return -1;
+    _r->hash = HashFNV1a( tmp_mf.data, tmp_mf.size );
+    MapFileClose( &tmp_mf );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: load the manifest file. the entries are dropped if the manifest is made from another SM_Info.txt, base case or output base
+ *           values, so GenBaseOutputs() should be called first
+ * _sm_fn: input parameter indicating the configuration file (SM_Info.txt)
+ * Return: 0: success (a missing or stale manifest is also a success, with no entries)
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAManifestLoad( const char *_sm_fn )
+{
+    FILE *fp = NULL;
+    struct DoAManifestHead tmp_mh;
+    struct DoAManifestRecord tmp_si, tmp_base;
+    long i=0;
+
+    memset( &DoAMani, 0x0, sizeof(DoAMani) );
+    memset( &tmp_mh, 0x0, sizeof(tmp_mh) );
+    memset( &tmp_si, 0x0, sizeof(tmp_si) );
+    memset( &tmp_base, 0x0, sizeof(tmp_base) );
+
+    if( DoAFileStamp(_sm_fn, &tmp_si, 1) != 0 || DoAFileStamp(basefile, &tmp_base, 1) != 0 )
+        return -1;
+    if( BaseOutputsNum < 0 )
+    {
+        printf( "DoAManifestLoad() error: the output base values are not generated, call GenBaseOutputs() first!\n" );
+        return -1;
+    }
+    // the baseline case may be run again with the same .fds file, so the values found in its csv files are hashed as well
+    DoAMani.key = (tmp_si.hash * 1099511628211UL) ^ tmp_base.hash;
+    DoAMani.key = (DoAMani.key * 1099511628211UL) ^ HashFNV1a( (const char *)FDS_BaseOutputs, sizeof(struct BaseOutput)*BaseOutputsNum );
+
+    fp = fopen( DOAMANIFEST, "rb" );
+    if( fp == NULL )
+        return 0;
+    if( fread(&tmp_mh, sizeof(tmp_mh), 1, fp) != 1 || memcmp(tmp_mh.magic, DOAMANIFESTMAGIC, sizeof(tmp_mh.magic)) != 0
+                                                   || tmp_mh.version != DOAMANIFESTVERSION || tmp_mh.rec_size != (int)sizeof(struct DoAlxInfo) )
+    {
+        printf( "[%s] is not a valid manifest file, rebuild it\n", DOAMANIFEST );
+        fclose( fp );
+        return 0;
+    }
+    if( tmp_mh.key != DoAMani.key )
+    {
+        printf( "[%s] is made from another [%s], base case or output base values, rebuild it\n", DOAMANIFEST, _sm_fn );
+        fclose( fp );
+        return 0;
+    }
+
+    DoAMani.entries = calloc( tmp_mh.num > 0 ? tmp_mh.num : 1, sizeof(struct DoAManifestEntry) );
+    if( DoAMani.entries == NULL )
+    {
+        printf( "DoAManifestLoad() error: calloc() [%ld] entries failed!\n", tmp_mh.num );
+        fclose( fp );
+        return -1;
+    }
+    DoAMani.cap = tmp_mh.num > 0 ? tmp_mh.num : 1;
+
+    for( i=0; i<tmp_mh.num; i++ )
+    {
+        struct DoAManifestEntry *tmp_me = &(DoAMani.entries[i]);
+
+        if( fread(&(tmp_me->r), sizeof(tmp_me->r), 1, fp) != 1 || tmp_me->r.csv_len <= 0 || tmp_me->r.csv_len >= MAXSTRINGSIZE
+                                                               || tmp_me->r.n < 0 || tmp_me->r.n > MAXLINENUM )
+            break;
+        tmp_me->csv = calloc( tmp_me->r.csv_len+1, 1 );
+        tmp_me->DoA = malloc( sizeof(struct DoAlxInfo) * (tmp_me->r.n > 0 ? tmp_me->r.n : 1) );
+        if( tmp_me->csv == NULL || tmp_me->DoA == NULL )
+        {
+            printf( "DoAManifestLoad() error: memory allocation for entry [%ld] failed!\n", i );
+            DoAMani.num = i+1;
+            fclose( fp );
+            return -1;
+        }
+        if( fread(tmp_me->csv, 1, tmp_me->r.csv_len, fp) != (size_t)tmp_me->r.csv_len
+            || fread(tmp_me->DoA, sizeof(struct DoAlxInfo), tmp_me->r.n, fp) != (size_t)tmp_me->r.n )
+        {
+            free( tmp_me->csv );
+            free( tmp_me->DoA );
+            break;
+        }
+    }
+    if( i < tmp_mh.num )
+        printf( "[%s] is truncated, [%ld] of [%ld] entries are used\n", DOAMANIFEST, i, tmp_mh.num );
+    DoAMani.num = i;
+    fclose( fp );
+    printf( "[%s]: [%ld] entries are loaded\n", DOAMANIFEST, DoAMani.num );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: find the entry of a csv file in the manifest which can be reused. the stamp of the csv file is returned so that the records built
+ *           from a new or changed csv file can be added by DoAManifestAdd() without reading the file again
+ * _csv: input parameter indicating the csv file name
+ * _r: output parameter holding the size, the time and the hash of the csv file
+ * Return: the entry, NULL if the csv file is new or changed
+ *************************************************************************************************************************************************/
+struct DoAManifestEntry *DoAManifestFind( const char *_csv, struct DoAManifestRecord *_r )
+{
+    struct DoAManifestEntry *tmp_me = NULL;
+    long i=0;
+
+    memset( _r, 0x0, sizeof(struct DoAManifestRecord) );
+    _r->csv_len = -1; // DoAManifestAdd() ignores the csv file if it can't be stamped
+    if( DoAFileStamp(_csv, _r, 0) != 0 )
+        return NULL;
+    for( i=0; i<DoAMani.num; i++ )
+    {
+        if( strcmp(DoAMani.entries[i].csv, _csv) == 0 )
+        {
+            tmp_me = &(DoAMani.entries[i]);
+            break;
+        }
+    }
+    if( tmp_me != NULL && tmp_me->r.size == _r->size && tmp_me->r.mtime == _r->mtime )
+    {
+        _r->hash = tmp_me->r.hash;
+        tmp_me->used = 1;
+        return tmp_me;
+    }
+    if( DoAFileStamp(_csv, _r, 1) != 0 ) // new or touched, the content tells
+        return NULL;
+    _r->csv_len = (long)strlen( _csv );
+    if( tmp_me != NULL && tmp_me->r.size == _r->size && tmp_me->r.hash == _r->hash )
+    {
+        tmp_me->r.mtime = _r->mtime;
+        tmp_me->used = 1;
+        return tmp_me;
+    }
+    return NULL;
+}
+
+/*************************************************************************************************************************************************
+ * Function: add the DoA records built from a new or changed csv file to the manifest, an old entry of the same csv file is replaced
+ * _csv: input parameter indicating the csv file name
+ * _r: input parameter indicating the stamp returned by DoAManifestFind()
+ * _rt: input parameter, 0: the csv file builds _n DoA records, 1: the csv file is not what we need
+ * _DoA: input parameter indicating the DoA records
+ * _n: input parameter indicating the number of _DoA
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAManifestAdd( const char *_csv, const struct DoAManifestRecord *_r, int _rt, const struct DoAlxInfo *_DoA, int _n )
+{
+    struct DoAManifestEntry *tmp_me = NULL;
+    long i=0;
+
+    if( _r->csv_len < 0 ) // DoAFileStamp() failed, the records can't be checked in the next run
+        return 0;
+    for( i=0; i<DoAMani.num; i++ )
+    {
+        if( strcmp(DoAMani.entries[i].csv, _csv) == 0 )
+        {
+            tmp_me = &(DoAMani.entries[i]);
+            free( tmp_me->DoA );
+            tmp_me->DoA = NULL;
+            break;
+        }
+    }
+    if( tmp_me == NULL )
+    {
+        if( DoAMani.num == DoAMani.cap )
+        {
+            long tmp_cap = DoAMani.cap > 0 ? DoAMani.cap*2 : 64;
+            struct DoAManifestEntry *tmp_entries = realloc( DoAMani.entries, sizeof(struct DoAManifestEntry) * tmp_cap );
+            if( tmp_entries == NULL )
+            {
+                printf( "DoAManifestAdd() error: realloc() [%ld] entries failed!\n", tmp_cap );
+                return -1;
+            }
+            DoAMani.entries = tmp_entries;
+            DoAMani.cap = tmp_cap;
+        }
+        tmp_me = &(DoAMani.entries[DoAMani.num]);
+        memset( tmp_me, 0x0, sizeof(struct DoAManifestEntry) );
+        tmp_me->csv = strdup( _csv );
+        if( tmp_me->csv == NULL )
+        {
+            printf( "DoAManifestAdd() error: strdup() [%s] failed!\n", _csv );
+            return -1;
+        }
+        DoAMani.num++;
+    }
+
+    tmp_me->r = *_r;
+    tmp_me->r.rt = _rt;
+    tmp_me->r.n = (_rt == 0) ? _n : 0;
+    tmp_me->used = 1;
+    tmp_me->DoA = malloc( sizeof(struct DoAlxInfo) * (tmp_me->r.n > 0 ? tmp_me->r.n : 1) );
+    if( tmp_me->DoA == NULL )
+    {
+        printf( "DoAManifestAdd() error: malloc() [%d] DoA records failed!\n", tmp_me->r.n );
+        tmp_me->r.n = 0;
+        tmp_me->used = 0;
+        return -1;
+    }
+    if( tmp_me->r.n > 0 )
+        memcpy( tmp_me->DoA, _DoA, sizeof(struct DoAlxInfo) * tmp_me->r.n );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: save the entries seen in this run to the manifest file, the csv files removed from the campaign are dropped. the content is
+ *           written to a temporary file first and then renamed to DOAMANIFEST so that a broken run never leaves a half written manifest
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAManifestSave( void )
+{
+    FILE *fp = NULL;
+    struct DoAManifestHead tmp_mh;
+    char tmp_fn[MAXSTRINGSIZE];
+    long i=0;
+    int rt=0;
+
+    memset( &tmp_mh, 0x0, sizeof(tmp_mh) );
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+
+    memcpy( tmp_mh.magic, DOAMANIFESTMAGIC, sizeof(tmp_mh.magic) );
+    tmp_mh.version = DOAMANIFESTVERSION;
+    tmp_mh.rec_size = (int)sizeof(struct DoAlxInfo);
+    tmp_mh.key = DoAMani.key;
+    for( i=0; i<DoAMani.num; i++ )
+        tmp_mh.num += DoAMani.entries[i].used;
+
+    sprintf( tmp_fn, "%s.tmp", DOAMANIFEST );
+    fp = fopen( tmp_fn, "wb" );
+    if( fp == NULL )
+    {
+        printf( "DoAManifestSave() error: fopen [%s] failed!\n", tmp_fn );
+        return -1;
+    }
+    if( fwrite(&tmp_mh, sizeof(tmp_mh), 1, fp) != 1 )
+        rt = -1;
+    for( i=0; i<DoAMani.num && rt == 0; i++ )
+    {
+        struct DoAManifestEntry *tmp_me = &(DoAMani.entries[i]);
+
+        if( tmp_me->used == 0 )
+            continue;
+        if( fwrite(&(tmp_me->r), sizeof(tmp_me->r), 1, fp) != 1 || fwrite(tmp_me->csv, 1, tmp_me->r.csv_len, fp) != (size_t)tmp_me->r.csv_len
+            || fwrite(tmp_me->DoA, sizeof(struct DoAlxInfo), tmp_me->r.n, fp) != (size_t)tmp_me->r.n )
+            rt = -1;
+    }
+    if( rt != 0 )
+    {
+        printf( "DoAManifestSave() error: fwrite [%s] failed!\n", tmp_fn );
+        fclose( fp );
+        remove( tmp_fn );
+        return -1;
+    }
+    if( fclose(fp) != 0 || rename(tmp_fn, DOAMANIFEST) != 0 )
+    {
+        printf( "DoAManifestSave() error: rename [%s] to [%s] failed!\n", tmp_fn, DOAMANIFEST );
+        remove( tmp_fn );
+        return -1;
+    }
+    printf( "[%s]: [%ld] entries are saved\n", DOAMANIFEST, tmp_mh.num );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: copy the DoA records of a manifest entry to the DoA list at the position of *_p
+ * _me: input parameter indicating the manifest entry returned by DoAManifestFind()
+ * _DoA: output parameter indicating the DoA list
+ * _p: input/output parameter indicating the end position of the DoA list
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAManifestCopy( const struct DoAManifestEntry *_me, struct DoAlxInfo *_DoA, int *_p )
+{
+    if( *_p + _me->r.n > MAXLINENUM )
+    {
+        printf( "the size limitation of _DoA is met: _p=%d\n", *_p );
+        return -1;
+    }
+    if( _me->r.rt == 0 )
+        printf( "tmp_whole_fn=%s (reused from %s)\n", _me->csv, DOAMANIFEST );
+    if( _me->r.n > 0 )
+        memcpy( &(_DoA[*_p]), _me->DoA, sizeof(struct DoAlxInfo) * _me->r.n );
+    (*_p) += _me->r.n;
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * which VarTypes and aliases of the configuration file (FPMSyms) are included in a file name. it is built once for a file by FileMatchBuild(),
+ * then IsFileMatchID() checks a record of the configuration file by its IDs instead of searching the file name for its strings again
+ *************************************************************************************************************************************************/
+struct FileMatch
+{
+    const char *fn;                       // the file name
+    unsigned char vartype[MAXLINENUM];    // 1: the file name includes the VarType with this ID
+    unsigned char in[MAXINPUTSNUM];       // 1: the file name includes the input alias with this ID
+    unsigned char out[MAXOUTPUTSNUM];     // 1: the file name includes the output alias with this ID
+};
+
+// find the VarTypes and aliases of FPMSyms included in the file name _fn
+void FileMatchBuild( const char *_fn, struct FileMatch *_fm )
+{
+    int i=0;
+
+    memset( _fm, 0x0, sizeof(struct FileMatch) );
+    _fm->fn = _fn;
+    for( i=0; i<FPMSyms.vartype.num && i<MAXLINENUM; i++ )
+        _fm->vartype[i] = (strstr(_fn, FPMSyms.vartype.str[i]) != NULL);
+    for( i=0; i<FPMSyms.in.num; i++ )
+        _fm->in[i] = (strstr(_fn, FPMSyms.in.str[i]) != NULL);
+    for( i=0; i<FPMSyms.out.num; i++ )
+        _fm->out[i] = (strstr(_fn, FPMSyms.out.str[i]) != NULL);
+}
+
+/******************************************************************************************************************************************
+ * Functions: the same as IsFileMatch() but it uses the IDs of _si[_i] in FPMSyms, _si should be the array read by readin()
+ *_fm: input parameter indicating the result of FileMatchBuild() for a file name
+ *_si: input parameter indicating the content of the configuration file
+ *_i: input parameter indicating one single record in _si
+ * Return: 0: if the file matchs the vartype and alias provided by _si[_i]
+ *         -1: the file doesn't match the vartype and alias provided by _si[_i]
+ *******************************************************************************************************************************************/
+int IsFileMatchID( const struct FileMatch *_fm, struct SMInfo *_si, int _i )
+{
+    int tmp_vt = FPMSyms.si_vartype[_i];
+    int tmp_alias = FPMSyms.si_alias[_i];
+
+    if( tmp_vt < 0 || tmp_vt >= MAXLINENUM || tmp_alias < 0 ) // not a record of FPMSyms
+        return IsFileMatch( (char *)_fm->fn, _si[_i] );
+    if( _fm->vartype[tmp_vt] == 0 )
+        return -1;
+    if( _si[_i].VarType[0] == 'I' ? _fm->in[tmp_alias] == 0 : _fm->out[tmp_alias] == 0 )
+        return -1;
+    return 0;
+}
+
+/***************************************************************************************************************************************************
+ * Function: set up one OutCross structure for each output record of the configuration file (_si) from the head line of a csv file
+ *_head: Input parameter indicating the head line of the csv file
+ *_fn: Input parameter indicating the csv file name
+ *_si: Input parameter indicating the content in the configuration file, only the output part of the file will be used in this function.
+ *_oc: Output parameter holding the OutCross structures in the order of the output records
+ *_basevalue: Output parameter holding the output base values in the order of the output records
+ *_columns: Output parameter, _columns[2*n] is the column of the output variable, _columns[2*n+1] is the column of the target variable
+ *Return: the number of the output records, -1: failure
+ **************************************************************************************************************************************************/
+int InitOutputCross( struct Span _head, const char *_fn, const struct SMInfo *_si, struct OutCross *_oc, double *_basevalue, int *_columns )
+{
+    int i=0,n=0;
+
+    //find the column positions of every output record, only one time for each csv file
+    for( i=0; i<MAXLINENUM; i++ )
+    {
+        int column,column_TN;  //column indicates the column number of the output critical variable, and column_TN means column number of the target variable
+
+        if( strlen(_si[i].VarType) == 0 )
+            break;
+        if( _si[i].VarType[0] != 'O' ) //only seek output records
+            continue;
+        if( n == MAXOUTPUTSNUM )
+        {
+            printf( "too many output records: MAXOUTPUTSNUM=[%d], _si[%d].Alias=[%s]\n", MAXOUTPUTSNUM, i, _si[i].Alias );
+            return -1;
+        }
+
+        column = SpanColumnPos(_head, _si[i].FileVarName, s[0]);
+        if( column == -1 )
+        {
+            printf("output variable [%s] not found in [%.*s]!\n", _si[i].FileVarName, (int)(_head.tail-_head.head), _head.head );
+            return -1;
+        }
+        column_TN = SpanColumnPos(_head, _si[i].TargetName, s[0]);
+        if( column_TN == -1 )
+        {
+            printf("output variable [%s] not found in [%.*s]!\n", _si[i].TargetName, (int)(_head.tail-_head.head), _head.head );
+            return -1;
+        }
+
+        //basefile is a global variable holding the baseline FDS file name which is assigned when reading in the configuration file
+        if( getOutputBaseValue(basefile, _si[i], &(_basevalue[n])) == -1 ) 
+        {
+            printf( "getOutputBaseValue() error: basefile=[%s], _si[%d], column=[%d], csv=[%s]!\n", basefile, i, column, _fn);
+            return -1;
+        }
+
+        InitOutCross( &(_oc[n]), &(_si[i]), i, column, column_TN );
+        _columns[2*n] = column;
+        _columns[2*n+1] = column_TN;
+        n++;
+    }
+    return n;
+}
+
+/***************************************************************************************************************************************************
+ * Function: copy the results of the OutCross structures to _DoA[_index] in the order of the output records. if the critical value of an output
+ *           record cannot be met, print to the screen this information and set the flag of _DoA to 1 so that this record will not be processed
+ *           later on. This happens when the simulation time is not enough or the FDS file is not set up well.
+ *_DoA: Output parameter indicating a struct list of analysis data
+ *_index: Input parameter indicating the position at _DoA needing information 
+ *_fn: Input parameter indicating the csv file name
+ *_si: Input parameter indicating the content in the configuration file
+ *_oc: Input parameter indicating the OutCross structures set up by InitOutputCross()
+ *_basevalue: Input parameter indicating the output base values set up by InitOutputCross()
+ *_n: Input parameter indicating the number of _oc
+ *Return: void
+ **************************************************************************************************************************************************/
+void PutOutputValues( struct DoAlxInfo *_DoA, int _index, const char *_fn, const struct SMInfo *_si, const struct OutCross *_oc, const double *_basevalue, int _n )
+{
+    int i=0,k=0;
+
+    // put the results into _DoA in the order of the output records
+    for( i=0; i<_n; i++ )
+    {
+        const struct SMInfo *tmp_si = &(_si[_oc[i].si_index]);
+
+        if( _oc[i].met == 0 ) // the critical value is not met, maybe the simulation time is not enough, check the csv file
+        {
+            printf( "critical value [%s] cannot be met in csv [%s] !\n", tmp_si->CriticalValue, _fn);
+            _DoA[_index].flag = 1; // the simulationg time may be too short to meet the critical value, or the critical value is too small or too big to be met, in thiese cases set the DoA.flag to 1 indicates that this record will not be processed later on.
+            continue;
+        }
+
+        _DoA[_index].OutputNewValue[k] = _oc[i].result;
+        printf( "_DoA[%d].OutputNewValue[%d]=[%lf], CV=[%lf], rows=[%ld]\n", _index, k, _DoA[_index].OutputNewValue[k], _oc[i].CV, _oc[i].rows );
+        _DoA[_index].OutputBaseValue[k] = _basevalue[i];
+        sprintf( _DoA[_index].OutputVarType[k],"%s", tmp_si->VarType );
+        sprintf( _DoA[_index].OutputAlias[k],"%s", tmp_si->Alias);
+        sprintf( _DoA[_index].TargetName[k],"%s", tmp_si->TargetName);
+        sprintf( _DoA[_index].OutputFileVarName[k],"%s", tmp_si->FileVarName);
+        if( k> 0 )
+            sprintf( _DoA[_index].comment[k], "%s", _DoA[_index].comment[0]);
+        k++; //there may be more than one output variables, k indicates the position 
+    }
+}
+
+/************************************************************************************************************************************************
+ * the follow mode of DoA (-f): the *_devc.csv files of the FDS runs still in progress are tailed, each data line is fed to the OutCross
+ * structures of the file as soon as it is written, and the provisional results are reported whenever a critical value is met
+ ***********************************************************************************************************************************************/
+struct DoAFollow
+{
+    struct DevcTail tail;                   // the tail reader of the csv file
+    int state;                              // 0: waiting for the head line, 1: followed, 2: not what we need, -1: failure
+    int n;                                  // the number of output records
+    int left;                               // the number of output records whose critical values are not met yet
+    struct OutCross oc[MAXOUTPUTSNUM];      // the crossing state of every output record
+    double basevalue[MAXOUTPUTSNUM];        // the output base values
+    struct DevcProjection pj;               // the columns of the output and target variables, and the Time column
+    int live;                               // 1: the end of the file has been reached once, the lines read later are written by a running FDS
+    double stop_at;                         // the Time at which the CHID.stop file is written (-s), -1 until all the critical values are met
+    int stopped;                            // 1: the CHID.stop file has been written
+};
+
+/************************************************************************************************************************************************
+ * Functions: fill the DoA list with the records built from one csv file (_csv) which could match the input and output records in _si. *_p
+ *            indicates the tail of the DoA list.
+ *            flow chat:
+ *            for each record in configuration file (_si)
+ *            1. check if it matches the csv file. if yes, keep going, otherwise go to next line
+ *            2. collect the input information and put them into the _DoA list at position of *_p (getInputBasevalue(), getInputNewValue())
+ *            3. collect the output information and put them into the _DoA list at [position of *_p(getOutputValue());
+ *            4. move to next position (*_p++)
+ *_csv: input parameter indicating a csv file already checked by CheckCSV()
+ *_si: input parameter indicating input and output variables' information by which the csv file is checked
+ *_DoA: output parameter inidcating the analysis results from _si and the csv file
+ *_p: output parameter indicating the end position of the structure _DoA so that the next addition can becan from this point
+ *_max: input parameter indicating the size of _DoA
+ *_fw: input parameter indicating the crossing state of a csv file in progress (follow mode) whose output values are used instead of reading the
+ *     file again, NULL for reading the file (getOutputValues())
+ *Return: 0: success, -1: failure
+ *********************************************************************************************************************************************/
+int FillOneCSV( char *_csv, struct SMInfo *_si, struct DoAlxInfo *_DoA, int *_p, int _max, const struct DoAFollow *_fw )
+{
+    int tmp_i=0;
+    struct FileMatch tmp_fm;
+
+    FileMatchBuild( _csv, &tmp_fm );
+
+    // this for sentense builds one or many _DoA elements based on the file (_csv) and the _si[tmp_i]
+    for( tmp_i = 0; tmp_i < MAXLINENUM; tmp_i++ ) 
+    {
+        int rt = 0;
+        if( strlen(_si[tmp_i].VarType) == 0 )
+            break;
+
+        //Although in CheckCSV(), IsFileMatch() is called to make sure _csv is what we needed, here IsFileMatch() needs to be called again to make sure the single struct _si[tmp_i] can match the file of _csv
+        if( IsFileMatchID(&tmp_fm, _si, tmp_i) != 0)
+            continue;
+
+        if( *_p == _max ) //Although _DoA is defined with quite a large array size, we need to check  if the limitation will be met 
+        {
+            printf( "the size limitation of _DoA is met: _p=%d\n", *_p );
+            return -1;
+        }
+
+        // copy information from _si[tmp_i] to _DoA[*_p]
+        sprintf( _DoA[*_p].InputVarType, "%s", _si[tmp_i].VarType ); 
+        sprintf( _DoA[*_p].InputAlias, "%s", _si[tmp_i].Alias); 
+        sprintf( _DoA[*_p].InputFileVarName, "%s", _si[tmp_i].FileVarName); 
+        sprintf( _DoA[*_p].comment[0],"LowerLimit=[%s]   UpperLimit=[%s]", _si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
+
+        // find inputBaseValue from _si[tmp_i]
+        if( getInputBaseValue( _DoA[*_p].InputBaseValue, _si[tmp_i]) != 0 )
+        {
+            printf( "getInputBaseValue() error: *_p = [%d], tmp_i = [%d]\n", *_p, tmp_i );
+            return -1;
+        }
+        
+        if( (rt=getInputNewValue( _DoA[*_p].InputNewValue, _csv, _si[tmp_i])) == -1 )
+        {
+            printf( "getInputNewValue() error, _DoA[%d], _csv=[%s], _si[%d].FileVarName=[%s]\n", *_p, _csv,tmp_i, _si[tmp_i].FileVarName );
+            return -1;
+        } else if ( rt == 1 ) //basevalue is same to InputNewValue
+        {
+            sprintf( _DoA[*_p].InputNewValue, "%s", _si[tmp_i].BaseValue); 
+        }
+        
+        if( _fw != NULL )
+            PutOutputValues( _DoA, *_p, _csv, _si, _fw->oc, _fw->basevalue, _fw->n );
+        else if( getOutputValues( _DoA, *_p, _csv, _si ) != 0 )
+        {
+            printf( "getOutputValue() error, _DoA[%d], _csv=[%s], _si[%d].FileVarName=[%s]\n", *_p, _csv, tmp_i, _si[tmp_i].FileVarName );
+            return -1;
+        }
+        (*_p)++;
+    }
+    return 0;
+}
+
 /************************************************************************************************************************************************
  * Functions: fill the DoA list by using the csv files in _dir which could mach the input and output records in  _si. *P indicates the tail
  *            of the DoA list. 
  *            flow chat:
  *            for each file in the _dir (while{})
  *            1. check if we need this file ( CheckCSV() ). if the answer is yes, keep going, otherwise go to check next file
- *            2. for each record in configuration file (_si), check if it matches the current file. if yes, keep going, otherwise go to next line
- *            3. collect the input information and put them into the _DoA list at position of *_p (getInputBasevalue(), getInputNewValue())
- *            4. collect the output information and put them into the _DoA list at [position of *_p(getOutputValue());
- *            5. move to next position (*_p++)
+ *            2. build the DoA records of this file at the position of *_p (FillOneCSV())
  *_Dir: input parameter indicating the directory including the *devc.csv or *evac.csv files
  *_si: input parameter indicating input and output variables' information by which the csv files in _dir are checked
  *_DoA: output parameter inidcating the analysis results from _si and the .csv files in _dir
@@ -192,8 +809,6 @@ int FillDoA( char * _dir, struct SMInfo * _si, struct DoAlxInfo *_DoA, int *_p)
     DIR *tmp_dir = NULL;
     struct dirent *en = NULL;
 
-    char Info[MAXSTRINGSIZE];
-
     //Although _DoA is defined with quite a large array size (MAXLINENUM), we need to check  if the limitation will be met 
     if( *_p == MAXLINENUM )
     {
@@ -208,9 +823,6 @@ int FillDoA( char * _dir, struct SMInfo * _si, struct DoAlxInfo *_DoA, int *_p)
         return -1;
     }
 
-    // clean the buff of Info
-    memset( Info, '\0', sizeof(Info));
-
     tmp_dir = opendir(_dir); //open the directory
     if (tmp_dir == NULL)
     {
@@ -222,266 +834,419 @@ int FillDoA( char * _dir, struct SMInfo * _si, struct DoAlxInfo *_DoA, int *_p)
     // for each file in the _dir, seek the useful file (*devc.csv or *evac.csv) and use the informaiton from _si to fill the _DoA 
     while ((en = readdir(tmp_dir)) != NULL)
     {
-        FILE *fp = NULL;
-        FILE *tmp_fp = NULL;
-        char tmp_fn[MAXSTRINGSIZE];
         char tmp_whole_fn[MAXSTRINGSIZE];
-        int tmp_i=0;
+        struct DoAManifestRecord tmp_r;
+        struct DoAManifestEntry *tmp_me = NULL;
+        int tmp_start = *_p, tmp_mani = 0, rt = 0;
 
         //clean the buffers 
-        memset( tmp_fn, 0x0, sizeof(tmp_fn));
         memset( tmp_whole_fn, 0x0, sizeof(tmp_whole_fn));
+        memset( &tmp_r, 0x0, sizeof(tmp_r));
 
         //compose the whole file name
         sprintf( tmp_whole_fn, "%s/%s", _dir, en->d_name );
-        if( CheckCSV(tmp_whole_fn, _si ) != 0 ) // to make sure this file is what we need 
+        if( DevcResolveName(tmp_whole_fn) != 0 ) // a sidecar whose csv file is processed instead
+            continue;
+        tmp_mani = ( DoAManifestMode == 1 && FileFilter(tmp_whole_fn) == 0 ); // only the csv files we may need are in the manifest
+
+        if( tmp_mani == 1 && (tmp_me = DoAManifestFind(tmp_whole_fn, &tmp_r)) != NULL ) // not changed since the last run
+            rt = DoAManifestCopy( tmp_me, _DoA, _p );
+        else if( CheckCSV(tmp_whole_fn, _si ) != 0 ) // to make sure this file is what we need 
         {
             // printf( "file [%s] doesn't match!\n", tmp_whole_fn );
-            continue;
+            if( tmp_mani == 1 )
+                rt = DoAManifestAdd( tmp_whole_fn, &tmp_r, 1, NULL, 0 );
         }
+        else
+        {
+            printf( "tmp_whole_fn=%s\n", tmp_whole_fn); //print all directory name
 
-        printf( "tmp_whole_fn=%s\n", tmp_whole_fn); //print all directory name
-
-        // this for sentense builds one or many _DoA elements based on the file (tmp_whole_fn) and the _si[tmp_i]
-        for( tmp_i = 0; tmp_i < MAXLINENUM; tmp_i++ ) 
+            rt = FillOneCSV(tmp_whole_fn, _si, _DoA, _p, MAXLINENUM, NULL);
+            if( rt == 0 && tmp_mani == 1 )
+                rt = DoAManifestAdd( tmp_whole_fn, &tmp_r, 0, &(_DoA[tmp_start]), *_p - tmp_start );
+        }
+        if( rt != 0 )
         {
-            int rt = 0;
-            if( strlen(_si[tmp_i].VarType) == 0 )
-                break;
+            closedir( tmp_dir );
+            return -1;
+        }
+    }
+    closedir( tmp_dir );
+    return 0;
+} 
 
-            //printf( "in for 1. si[%d].VarType=%s\n", tmp_i, _si[tmp_i].VarType );
+/************************************************************************************************************************************************
+ * the parallel mode of DoA (-j N): every csv file of every directory in the DirList is one job. the jobs are dealt to the deques of N threads
+ * from the biggest file to the smallest, each thread takes the jobs from the tail of its own deque and, when its deque is empty, steals jobs
+ * from the head of the other deques, so that a few huge files don't keep the other threads idle. each job builds its DoA records into its own
+ * buffer and the buffers are merged into the DoA list in the order of the job list, which is the order of the sequential mode
+ ***********************************************************************************************************************************************/
+int DoAThreads = 1; // the number of threads set by the option -j, 1 means the sequential mode
 
-            //Although in CheckCSV(), IsFileMatch() is called to make sure tmp_whole_fn is what we needed, here IsFileMatch() needs to be called again to make sure the single struct _si[tmp_i] can match the file of tmp_whole fn
-            if( IsFileMatch(tmp_whole_fn, _si[tmp_i] ) != 0)
-                continue;
+struct DoAJob
+{
+    char csv[MAXSTRINGSIZE];  // the csv file name
+    long size;                // the size of the csv file, used to deal the big files first
+    int rt;                   // 0: success, 1: the file is not what we need (CheckCSV()), -1: failure
+    int n;                    // the number of DoA records built from the file
+    struct DoAlxInfo *DoA;    // the DoA records built from the file
+    struct DoAManifestRecord r;   // the stamp of the file for the manifest (-m)
+    struct DoAManifestEntry *me;  // the manifest entry reused by the file, NULL if the file is parsed
+};
+
+struct DoADeque
+{
+    pthread_mutex_t lock;
+    int *jobs;   // the positions in the job list
+    int head;    // the thieves take jobs from the head
+    int tail;    // the owner takes jobs from the tail
+};
+
+struct DoAPool
+{
+    struct DoAJob *jobs;
+    int njobs;
+    struct DoADeque *deques;
+    int nthreads;
+    struct SMInfo *si;
+};
+
+struct DoAWorker
+{
+    struct DoAPool *pool;
+    int id;
+};
 
-            //printf( "in for 2. si[%d].VarType=%s, Alias=%s, FileVarName=%s, LowerLimit=%s, UpperLimit=%s\n", tmp_i, _si[tmp_i].VarType, _si[tmp_i].Alias, _si[tmp_i].FileVarName,_si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
+// take one job from the tail (_steal == 0) or the head (_steal == 1) of a deque, return the position of the job in the job list, -1 if empty
+int DoADequeTake( struct DoADeque *_dq, int _steal )
+{
+    int tmp_job = -1;
 
-            // copy information from _si[tmp_i] to _DoA[*_p]
-            sprintf( _DoA[*_p].InputVarType, "%s", _si[tmp_i].VarType ); 
-            sprintf( _DoA[*_p].InputAlias, "%s", _si[tmp_i].Alias); 
-            sprintf( _DoA[*_p].InputFileVarName, "%s", _si[tmp_i].FileVarName); 
-            sprintf( _DoA[*_p].comment[0],"LowerLimit=[%s]   UpperLimit=[%s]", _si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
+    pthread_mutex_lock( &(_dq->lock) );
+    if( _dq->head < _dq->tail )
+        tmp_job = (_steal == 1) ? _dq->jobs[_dq->head++] : _dq->jobs[--_dq->tail];
+    pthread_mutex_unlock( &(_dq->lock) );
+    return tmp_job;
+}
 
-            //printf( "in for 3. *_p = %d, si[%d].VarType=%s, Alias=%s, FileVarName=%s, LowerLimit=%s, UpperLimit=%s\n", *_p, tmp_i, _si[tmp_i].VarType, _si[tmp_i].Alias, _si[tmp_i].FileVarName,_si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
-            // find inputBaseValue from _si[tmp_i]
-            if( getInputBaseValue( _DoA[*_p].InputBaseValue, _si[tmp_i]) != 0 )
-            {
-                printf( "getInputBaseValue() error: *_p = [%d], tmp_i = [%d]\n", *_p, tmp_i );
-                return -1;
-            }
-            //printf( "in for 4. *_p = %d, si[%d].VarType=%s, Alias=%s, FileVarName=%s, LowerLimit=%s, UpperLimit=%s\n", *_p, tmp_i, _si[tmp_i].VarType, _si[tmp_i].Alias, _si[tmp_i].FileVarName,_si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
-            
-            if( (rt=getInputNewValue( _DoA[*_p].InputNewValue, tmp_whole_fn, _si[tmp_i])) == -1 )
+// run one job: check the csv file and build its DoA records into the buffer of the job
+void DoARunJob( struct DoAJob *_job, struct SMInfo *_si )
+{
+    int i=0, tmp_max=0;
+    struct FileMatch tmp_fm;
+
+    if( DoAManifestMode == 1 && (_job->me = DoAManifestFind(_job->csv, &(_job->r))) != NULL ) // not changed since the last run
+    {
+        _job->rt = _job->me->r.rt;
+        _job->n = _job->me->r.n;
+        return;
+    }
+    if( CheckCSV(_job->csv, _si) != 0 ) // to make sure this file is what we need
+    {
+        _job->rt = 1;
+        return;
+    }
+    printf( "tmp_whole_fn=%s\n", _job->csv );
+
+    FileMatchBuild( _job->csv, &tmp_fm );
+    for( i=0; i<MAXLINENUM; i++ ) // the file builds one DoA record for each matching record in _si
+    {
+        if( strlen(_si[i].VarType) == 0 )
+            break;
+        if( IsFileMatchID(&tmp_fm, _si, i) == 0 )
+            tmp_max++;
+    }
+    _job->DoA = calloc( tmp_max > 0 ? tmp_max : 1, sizeof(struct DoAlxInfo) );
+    if( _job->DoA == NULL )
+    {
+        printf( "DoARunJob() error: calloc() [%d] DoA records failed, csv=[%s]\n", tmp_max, _job->csv );
+        _job->rt = -1;
+        return;
+    }
+    _job->rt = FillOneCSV( _job->csv, _si, _job->DoA, &(_job->n), tmp_max, NULL );
+}
+
+// the thread function of the pool: run the jobs of its own deque, then steal the jobs of the other deques until all the deques are empty
+void *DoAWorkerRun( void *_arg )
+{
+    struct DoAWorker *tmp_w = (struct DoAWorker *)_arg;
+    struct DoAPool *tmp_pool = tmp_w->pool;
+
+    while( 1 )
+    {
+        int tmp_job = DoADequeTake( &(tmp_pool->deques[tmp_w->id]), 0 );
+        int i=0;
+
+        for( i=1; tmp_job == -1 && i<tmp_pool->nthreads; i++ ) // no jobs are added once the pool starts, so empty deques mean the end
+            tmp_job = DoADequeTake( &(tmp_pool->deques[(tmp_w->id+i) % tmp_pool->nthreads]), 1 );
+        if( tmp_job == -1 )
+            break;
+        DoARunJob( &(tmp_pool->jobs[tmp_job]), tmp_pool->si );
+    }
+    return NULL;
+}
+
+/*************************************************************************************************************************************************
+ * Function: add the csv files in _dir to the job list of the parallel mode, in the order of readdir() which is the order of FillDoA()
+ * _dir: input parameter indicating the directory including the *devc.csv or *evac.csv files
+ * _pool: input/output parameter holding the job list
+ * _cap: input/output parameter indicating the allocated length of the job list
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoACollectJobs( char *_dir, struct DoAPool *_pool, int *_cap )
+{
+    DIR *tmp_dir = NULL;
+    struct dirent *en = NULL;
+
+    tmp_dir = opendir(_dir); //open the directory
+    if (tmp_dir == NULL)
+    {
+        printf( "opendir error: %s\n", _dir );
+        perror("Error:");
+        return -1;
+    }
+
+    while ((en = readdir(tmp_dir)) != NULL)
+    {
+        struct DoAJob *tmp_job = NULL;
+        struct stat tmp_st;
+
+        if( _pool->njobs == *_cap )
+        {
+            struct DoAJob *tmp_jobs = realloc( _pool->jobs, sizeof(struct DoAJob) * (*_cap) * 2 );
+            if( tmp_jobs == NULL )
             {
-                printf( "getInputNewValue() error, _DoA[%d], tmp_whole_fn=[%s], _si[%d].FileVarName=[%s]\n", *_p, tmp_whole_fn,tmp_i, _si[tmp_i].FileVarName );
+                printf( "DoACollectJobs() error: realloc() [%d] jobs failed!\n", (*_cap)*2 );
+                closedir( tmp_dir );
                 return -1;
-            } else if ( rt == 1 ) //basevalue is same to InputNewValue
-            {
-                sprintf( _DoA[*_p].InputNewValue, "%s", _si[tmp_i].BaseValue); 
             }
-            
-            //printf( "in for 5. *_p = %d, si[%d].VarType=%s, Alias=%s, FileVarName=%s, LowerLimit=%s, UpperLimit=%s\n", *_p, tmp_i, _si[tmp_i].VarType, _si[tmp_i].Alias, _si[tmp_i].FileVarName,_si[tmp_i].LowerLimit, _si[tmp_i].UpperLimit);
-            if( getOutputValues( _DoA, *_p, tmp_whole_fn, _si ) != 0 )
+            _pool->jobs = tmp_jobs;
+            (*_cap) *= 2;
+        }
+
+        tmp_job = &(_pool->jobs[_pool->njobs]);
+        memset( tmp_job, 0x0, sizeof(struct DoAJob) );
+        sprintf( tmp_job->csv, "%s/%s", _dir, en->d_name );
+        if( DevcResolveName(tmp_job->csv) != 0 || FileFilter(tmp_job->csv) != 0 ) // the cheap checks are done here, CheckCSV() in the job
+            continue;
+        if( stat(tmp_job->csv, &tmp_st) == 0 )
+            tmp_job->size = (long)tmp_st.st_size;
+        _pool->njobs++;
+    }
+    closedir( tmp_dir );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: the parallel version of calling FillDoA() for each directory in _DirList. the DoA records are the same and in the same order as
+ *           the sequential mode
+ * _DirList: input parameter indicating the directories including the *devc.csv or *evac.csv files
+ * _si: input parameter indicating input and output variables' information
+ * _DoA: output parameter inidcating the analysis results
+ * _p: output parameter indicating the end position of the structure _DoA
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FillDoAParallel( char _DirList[MAXNEWDIRNUM][100], struct SMInfo *_si, struct DoAlxInfo *_DoA, int *_p )
+{
+    struct DoAPool tmp_pool;
+    pthread_t *tmp_threads = NULL;
+    struct DoAWorker *tmp_workers = NULL;
+    int *tmp_order = NULL; // the job positions sorted from the biggest file to the smallest
+    int i=0, j=0, tmp_cap=64, rt=0;
+
+    memset( &tmp_pool, 0x0, sizeof(tmp_pool) );
+    tmp_pool.si = _si;
+    tmp_pool.jobs = malloc( sizeof(struct DoAJob) * tmp_cap );
+    if( tmp_pool.jobs == NULL )
+    {
+        printf( "FillDoAParallel() error: malloc() jobs failed!\n" );
+        return -1;
+    }
+    for( i=0; i<MAXNEWDIRNUM; i++ )
+    {
+        if( strlen(_DirList[i]) == 0 )
+            break;
+        if( DoACollectJobs(_DirList[i], &tmp_pool, &tmp_cap) != 0 )
+        {
+            free( tmp_pool.jobs );
+            return -1;
+        }
+    }
+
+    tmp_pool.nthreads = (DoAThreads < tmp_pool.njobs) ? DoAThreads : tmp_pool.njobs;
+    if( tmp_pool.nthreads < 1 )
+        tmp_pool.nthreads = 1;
+    printf( "FillDoAParallel(): [%d] csv files, [%d] threads\n", tmp_pool.njobs, tmp_pool.nthreads );
+
+    tmp_order = malloc( sizeof(int) * (tmp_pool.njobs > 0 ? tmp_pool.njobs : 1) );
+    tmp_pool.deques = calloc( tmp_pool.nthreads, sizeof(struct DoADeque) );
+    tmp_threads = calloc( tmp_pool.nthreads, sizeof(pthread_t) );
+    tmp_workers = calloc( tmp_pool.nthreads, sizeof(struct DoAWorker) );
+    for( i=0; tmp_pool.deques != NULL && i<tmp_pool.nthreads; i++ )
+    {
+        tmp_pool.deques[i].jobs = malloc( sizeof(int) * (tmp_pool.njobs > 0 ? tmp_pool.njobs : 1) );
+        if( tmp_pool.deques[i].jobs == NULL )
+            rt = -1;
+        pthread_mutex_init( &(tmp_pool.deques[i].lock), NULL );
+    }
+    if( tmp_order == NULL || tmp_pool.deques == NULL || tmp_threads == NULL || tmp_workers == NULL || rt != 0 )
+    {
+        printf( "FillDoAParallel() error: memory allocation failed!\n" );
+        rt = -1;
+        goto end;
+    }
+
+    // deal the jobs from the biggest file to the smallest, round robin. the owner takes from the tail, so the deque is filled backwards
+    for( i=0; i<tmp_pool.njobs; i++ )
+    {
+        int k=i;
+        for( ; k>0 && tmp_pool.jobs[tmp_order[k-1]].size < tmp_pool.jobs[i].size; k-- )
+            tmp_order[k] = tmp_order[k-1];
+        tmp_order[k] = i;
+    }
+    for( i=tmp_pool.njobs-1; i>=0; i-- )
+    {
+        struct DoADeque *tmp_dq = &(tmp_pool.deques[i % tmp_pool.nthreads]);
+        tmp_dq->jobs[tmp_dq->tail++] = tmp_order[i];
+    }
+
+    for( i=0; i<tmp_pool.nthreads; i++ )
+    {
+        tmp_workers[i].pool = &tmp_pool;
+        tmp_workers[i].id = i;
+        if( pthread_create(&(tmp_threads[i]), NULL, DoAWorkerRun, &(tmp_workers[i])) != 0 )
+        {
+            printf( "pthread_create() error: thread [%d]\n", i );
+            DoAWorkerRun( &(tmp_workers[i]) ); // run the jobs in this thread instead, the other threads steal them as usual
+            tmp_threads[i] = pthread_self();
+        }
+    }
+    for( i=0; i<tmp_pool.nthreads; i++ )
+    {
+        if( pthread_equal(tmp_threads[i], pthread_self()) == 0 )
+            pthread_join( tmp_threads[i], NULL );
+    }
+
+    // merge the DoA records of the jobs in the order of the job list
+    for( i=0; i<tmp_pool.njobs && rt == 0; i++ )
+    {
+        struct DoAJob *tmp_job = &(tmp_pool.jobs[i]);
+
+        if( tmp_job->rt == -1 )
+        {
+            printf( "FillOneCSV() error: csv=[%s]\n", tmp_job->csv );
+            rt = -1;
+            break;
+        }
+        if( tmp_job->me != NULL )
+        {
+            rt = DoAManifestCopy( tmp_job->me, _DoA, _p );
+            continue;
+        }
+        for( j=0; j<tmp_job->n; j++ )
+        {
+            if( *_p == MAXLINENUM )
             {
-                printf( "getOutputValue() error, _DoA[%d], tmp_whole_fn=[%s], _si[%d].FileVarName=[%s]\n", *_p, tmp_whole_fn, tmp_i, _si[tmp_i].FileVarName );
-                return -1;
+                printf( "the size limitation of _DoA is met: _p=%d\n", *_p );
+                rt = -1;
+                break;
             }
-            //printf( "after getOutputValues: _DoA[%d].OutputNewValue[0]=[%lf],_si[%d].VarType=%s\n", *_p, _DoA[*_p].OutputNewValue[0],tmp_i, _si[tmp_i].VarType );
-            (*_p)++;
+            _DoA[(*_p)++] = tmp_job->DoA[j];
         }
+    }
 
-     }
-} 
+    // the parsed files are added to the manifest after the merge since DoAManifestAdd() may move the entries reused by the other jobs
+    for( i=0; i<tmp_pool.njobs && rt == 0 && DoAManifestMode == 1; i++ )
+    {
+        if( tmp_pool.jobs[i].me == NULL )
+            rt = DoAManifestAdd( tmp_pool.jobs[i].csv, &(tmp_pool.jobs[i].r), tmp_pool.jobs[i].rt, tmp_pool.jobs[i].DoA, tmp_pool.jobs[i].n );
+    }
+
+end:
+    for( i=0; i<tmp_pool.njobs; i++ )
+        free( tmp_pool.jobs[i].DoA );
+    for( i=0; tmp_pool.deques != NULL && i<tmp_pool.nthreads; i++ )
+    {
+        free( tmp_pool.deques[i].jobs );
+        pthread_mutex_destroy( &(tmp_pool.deques[i].lock) );
+    }
+    free( tmp_pool.deques );
+    free( tmp_pool.jobs );
+    free( tmp_order );
+    free( tmp_threads );
+    free( tmp_workers );
+    return rt;
+}
 
 /***************************************************************************************************************************************************
- * Function: fill _DoA with output data in file _fn which match _si's output records.
- *           Flow chat: for each record in the configuration file,
- *           1. check if the record is output record, if Yes, keep going, otherwise do nothing and go to next record
- *           2. get the second line of the csv file (_fn)
- *           3. find the column position of the output variable of FDS on which the critical value is put(getColumnPos())
- *           4. find the column position of the output variable of FDS which is the target corresponding to the critical value
- *           5. find the output base value of the target variable which should be in the FDS simulation data file of the baseline case
- *           6. find two pairs of values of critical variable and target variable which are neighbor
- *           7. if the last critical variable met the critical value, then calculate the value of the target variable by interpolation
- *           8. if the last critical variable finally cannot be met, print to the screen this information and set the flog of _DoA to 1 so that this                 record will not be processed later on. This happens when the simulation time is not enough or the FDS file is not set up well.
+ * Function: fill _DoA with output data in file _fn which match _si's output records. the csv file is read only once no matter how many output
+ *           records there are in the configuration file.
+ *           Flow chat:
+ *           1. open the csv file (_fn) or its binary sidecar (DevcOpen()) and get the second line, namely the head line. the lines of the csv
+ *              are walked in place and never copied
+ *           2. for each output record in the configuration file, find the column position of the output variable of FDS on which the critical
+ *              value is put and the column position of the target variable (SpanColumnPos()), look up the output base value of the target
+ *              variable generated from the baseline case at startup (getOutputBaseValue()), and set up one OutCross structure (InitOutputCross())
+ *           3. if the columns come from a sidecar, scan each column for the critical value at one time (DevcCrossAll()). otherwise, for
+ *              each data line, get the values of all the needed columns at one time (DevcProject() and DevcNextRow()), the other
+ *              columns are skipped without being converted, and feed them to every OutCross
+ *              structure (FeedOutCross()). when the critical value of an output record is met, the value of the target variable is calculated
+ *              by interpolation. the reading stops as soon as all the critical values are met
+ *           4. copy the results to _DoA in the order of the output records (PutOutputValues())
  *_DoA: Output parameter indicating a struct list of analysis data
  *_index: Input parameter indicating the position at _DoA needing information 
+ *_fn: Input parameter indicating the csv file name
  *_si: Input parameter indicating the content in the configuration file, only the output part of the file will be used in this function.
  *Return: 0: success, -1: failure
  **************************************************************************************************************************************************/
 int getOutputValues( struct DoAlxInfo *_DoA, int _index, char * _fn, const struct SMInfo *_si )
 {
-    FILE *fp = NULL;
-    int i=0,k=0;
-    char buff_1[MAXSTRINGSIZE];
-    char buff_2[MAXSTRINGSIZE];
-
-    memset( buff_1, 0x0, sizeof(buff_1));
-    memset( buff_2, 0x0, sizeof(buff_2));
+    struct DevcReader tmp_dr;
+    int rt=0;
+    int n=0,left=0;
+    struct OutCross tmp_oc[MAXOUTPUTSNUM];
+    double tmp_basevalue[MAXOUTPUTSNUM];
+    int tmp_columns[2*MAXOUTPUTSNUM]; // tmp_columns[2*n] is the column of the output variable, tmp_columns[2*n+1] is the column of the target variable
+    double tmp_values[2*MAXOUTPUTSNUM];
+
+    memset( tmp_oc, 0x0, sizeof(tmp_oc));
+    memset( tmp_basevalue, 0x0, sizeof(tmp_basevalue));
     
-    fp=fopen(_fn,"r");
-    if( fp == NULL )
+    if( DevcOpen(_fn, &tmp_dr) != 0 ) // the csv file itself or its sidecar
     {
         printf( "open file [%s]failed!\n",_fn);
         return -1;
     }
 
-    printf( "before for in getOutputValues: \n" );
-
-    for( i=0; i<MAXLINENUM; i++ )
-    {
-        if( _si[i].VarType[0] == 'O' ) //only seek output records
-        {
-           fseek(fp, 0, SEEK_SET);
-           fgets(buff_1,sizeof(buff_1),fp); // first line of csv file is not used
-           if( fgets(buff_1, sizeof(buff_1), fp ) != NULL )
-           {
-               double tmp_first_value=0.00;
-               double tmp_basevalue = 0.00;
-               double tmp_first_NV= 0.00;
-               double tmp_first_CV = atof(_si[i].CriticalValue);
-               int tmp_first_direction = atoi(_si[i].Divisions);
-               //column indicates the column number of the output critical variable, and column_TN means column number of the target variable
-               int column,column_TN;  
-               int flag=0; // check if the critical value is met in the file fp
-
-               //printf( "in for 1 in  getOutputValues(): buff_1 = %s, _si[%d].FileVarName=%s, s=%s\n", buff_1, i,_si[i].FileVarName, s );
-               //find the column number of the output critical variable in the csv file
-               column = getColumnPos(buff_1, _si[i].FileVarName,s);
-               if( column == -1 )
-               {
-                   printf("output variable [%s] not found in [%s]!\n", _si[i].FileVarName, buff_1 );
-                   fclose(fp);
-                   return -1;
-               }
-
-               //printf( "in for 2 in  getOutputValues(): buff_1 = %s, _si[%d].FileVarName=%s, s=%s, column=%d\n", buff_1, i,_si[i].FileVarName, s, column );
-               //find the column number of the output target variable in the csv file
-               column_TN = getColumnPos(buff_1, _si[i].TargetName,s);
-               if( column_TN == -1 )
-               {
-                   printf("output variable [%s] not found in [%s]!\n", _si[i].TargetName, buff_1 );
-                   fclose(fp);
-                   return -1;
-               }
-
-               //printf( "in for 3 in  getOutputValues(): buff_1 = %s, _si[%d].TargetName=%s, s=%s, column_TN=%d\n", buff_1, i,_si[i].TargetName, s, column_TN );
-
-               //basefile is a global variable holding the baseline FDS file name which is assigned when reading in the configuration file
-               if( getOutputBaseValue(basefile, _si[i], &tmp_basevalue) == -1 ) 
-               {
-                   printf( "getOutputBaseValue() error: basefile=[%s], _si[%d], column=[%d]!\n", basefile, i, column);
-                   fclose( fp );
-                   return -1;
-               }
-               //printf( "in for 4 in  getOutputValues(): buff_1 = %s, _si[%d].TargetName=%s, s=%s, column_TN=%d\n", buff_1, i,_si[i].TargetName, s, column_TN );
-
-               if( column == -1 )
-               {
-                   printf("output variable [%s] not found in [%s]!\n", _si[i].FileVarName, buff_1 );
-                   fclose( fp );
-                   return -1;
-               }
-               fgets(buff_1,sizeof(buff_1),fp); // get the first data line in the file _fn
-
-               //find the value at the column and put it into tmp_first_value
-               if( getValueByCol(buff_1, column,s,&tmp_first_value) != 0 )
-               {
-                   printf("getValueByCol() error, buff_1 = [%s], column = [%d], sep=[%s]!\n", buff_1, column, s );
-                   fclose( fp );
-                   return -1;
-               }
-
-               //printf( "in for 5 in  getOutputValues(): buff_1 = %s, _si[%d].TargetName=%s, s=%s, column_TN=%d\n", buff_1, i,_si[i].TargetName, s, column_TN );
-               //find the value at the column and put it into tmp_first_NV. 
-               if( getValueByCol(buff_1, column_TN, s, &tmp_first_NV) != 0 )
-               {
-                   printf("getValueByCol() error, buff_1 = [%s], column = [1], sep=[%s]!\n", buff_1, s );
-                   fclose( fp );
-                   return -1;
-               }
-               printf( "in for 6 in  getOutputValues(): buff_1 = %s, _si[%d].TargetName=%s, s=%s, column_TN=%d\n", buff_1, i,_si[i].TargetName, s, column_TN );
+    n = InitOutputCross( tmp_dr.head, _fn, _si, tmp_oc, tmp_basevalue, tmp_columns );
+    if( n == -1 )
+    {
+        DevcClose( &tmp_dr );
+        return -1;
+    }
 
-               // the first line may be what we need, although the possibility is very very very very very low
-               if( (tmp_first_direction == 1 && tmp_first_value > tmp_first_CV )|| ( tmp_first_direction == -1 && tmp_first_value < tmp_first_CV ))
-               {
-                   double tmp_d=0.0;
-               	   if( getValueByCol(buff_1, column_TN, s, &tmp_d) != 0 )
-                   {
-                       printf("getValueByCol() error, buff_1 = [%s], column_TN = [%d], sep=[%s]!\n", buff_1, column_TN, s );
-                       fclose( fp );
-                       return -1;
-                   }
-                   _DoA[_index].OutputNewValue[k] = tmp_d;
-                   _DoA[_index].OutputBaseValue[k] = tmp_basevalue; 
-                   sprintf( _DoA[_index].OutputVarType[k],"%s", _si[i].VarType );
-                   sprintf( _DoA[_index].OutputAlias[k],"%s", _si[i].Alias);
-                   sprintf( _DoA[_index].TargetName[k],"%s", _si[i].TargetName);
-                   sprintf( _DoA[_index].OutputFileVarName[k],"%s", _si[i].FileVarName);
-                   sprintf( _DoA[_index].OutputFileVarName[k],"%s", _si[i].FileVarName);
-
-                   if( k> 0 )
-                       sprintf( _DoA[_index].comment[k], "%s", _DoA[_index].comment[0]);
-                   k++; //there may be more than one output variables, k indicates the position 
-                   continue;
-               }
- 
-               do 
-               {
-                  int tmp_direction = tmp_first_direction;
-                  double tmp_value_1 = tmp_first_value;
-                  double tmp_value_2 = 0.0;
-                  double tmp_CV= tmp_first_CV;
-                  double tmp_NV_1=tmp_first_NV; 
-                  double tmp_NV_2=0.0; 
-                 
-                  fgets(buff_2,sizeof(buff_2),fp);
-               	  if( getValueByCol(buff_2, column, s, &tmp_value_2) != 0 ) //find the second pair of data
-                  {
-                      printf("getValueByCol() error, buff_1 = [%s], column = [%d], sep=[%s]!\n", buff_2, column, s );
-                      fclose( fp );
-                      return -1;
-                  }
-               	  if( getValueByCol(buff_2, column_TN, s, &tmp_NV_2) != 0 ) //find the second pair of data
-                  {
-                      printf("getValueByCol() error, buff_1 = [%s], column_TN = [%d], sep=[%s]!\n", buff_2, column_TN, s );
-                      fclose( fp );
-                      return -1;
-                  }
-
-                  if((tmp_direction == 1 && tmp_value_2 > tmp_CV )||
-                     ( tmp_direction == -1 && tmp_value_2 < tmp_CV ))
-                  { //the critical value is met, call the interpolation function CalMidVal()
-                     _DoA[_index].OutputNewValue[k] = CalMidVal(tmp_NV_1, tmp_NV_2, tmp_value_1, tmp_value_2, tmp_CV); 
-printf( "_DoA[%d].OutputNewValue[%d]=[%lf],tmp_NV_1=[%lf],tmp_NV_2=[%lf],tmp_value_1=[%lf], tmp_Value_2=[%lf],  tmp_CV=[%lf]\n", _index, k, _DoA[_index].OutputNewValue[k], tmp_NV_1, tmp_NV_2, tmp_value_1, tmp_value_2, tmp_CV);
-                     _DoA[_index].OutputBaseValue[k] = tmp_basevalue;
-                     sprintf( _DoA[_index].OutputVarType[k],"%s", _si[i].VarType );
-                     sprintf( _DoA[_index].OutputAlias[k],"%s", _si[i].Alias);
-                     sprintf( _DoA[_index].TargetName[k],"%s", _si[i].TargetName);
-                     sprintf( _DoA[_index].OutputFileVarName[k],"%s", _si[i].FileVarName);
-                     sprintf( _DoA[_index].OutputFileVarName[k],"%s", _si[i].FileVarName);
-                     if( k> 0 )
-                         sprintf( _DoA[_index].comment[k], "%s", _DoA[_index].comment[0]);
-                     flag = 1;
-                     k++;
-                     break;
-                  }
-                  tmp_first_value = tmp_value_2; //marching the data pair ahead by updating the first value with the second one
-                  tmp_first_NV= tmp_NV_2; //marching the data pair ahead by updating the first value with the second one
-    	       }while((getc(fp))!=EOF); //stop at EOF
-
-
-               if( flag == 0 ) // the critical value is not met, maybe the simulation time is not enough, check the csv file
-               {
-                   printf( "critical value [%s] cannot be met in csv [%s] !\n", _si[i].CriticalValue, _fn);
-                   _DoA[_index].flag = 1; // the simulationg time may be too short to meet the critical value, or the critical value is too small or too big to be met, in thiese cases set the DoA.flag to 1 indicates that this record will not be processed later on.
-                   //return -1;
-               }
-           }
-        } 
+    // the columns from a sidecar are scanned with the SIMD crossing search, otherwise there is one single pass over the data lines,
+    // every data line is walked only once for all the output records
+    if( (rt=DevcCrossAll(&tmp_dr, tmp_oc, n)) == 1 && (rt=DevcProject(&tmp_dr, tmp_columns, 2*n)) == 0 )
+    {
+        left = n;
+        while( left > 0 && (rt=DevcNextRow(&tmp_dr, tmp_values)) == 0 )
+        {
+            int j=0;
+            for( j=0; j<n; j++ )
+                left -= FeedOutCross( &(tmp_oc[j]), tmp_values[2*j], tmp_values[2*j+1] );
+        }
     }
-    fclose( fp );
+    DevcClose( &tmp_dr );
+    if( rt == -1 )
+    {
+        printf("DevcNextRow() error, csv = [%s]!\n", _fn );
+        return -1;
+    }
+
+    PutOutputValues( _DoA, _index, _fn, _si, tmp_oc, tmp_basevalue, n );
     return 0;
 }
 
@@ -502,6 +1267,7 @@ int getInputNewValue( char * _Inv, const char *_fn, const struct SMInfo _single_
     char *tmp_tail=NULL;
     char tmp_middle[MAXSTRINGSIZE];
     char tmp_fn[MAXSTRINGSIZE];
+    struct ThreeDCoordinate ThreeDC[3]; //to store the 3d coordinates, local so that many csv files can be processed at the same time
 
     memset( ThreeDC, 0x0, sizeof(ThreeDC) );
     memset( tmp_middle, 0x0, sizeof(tmp_middle) );
@@ -708,7 +1474,16 @@ int GenDoA( struct SMInfo *_si, struct DoAlxInfo *_DoA )
     
     printf( "DoALength is %d\n", DoALength );
 
-    for( i=0; i<MAXNEWDIRNUM; i++ )
+    if( DoAThreads > 1 ) // the parallel mode, the DoA records are the same as the sequential mode
+    {
+        if( FillDoAParallel(DirList, _si, _DoA, &DoALength) != 0 )
+        {
+            printf( "FillDoAParallel() error: DoALength is %d\n", DoALength );
+            return -1;
+        }
+    }
+
+    for( i=0; i<MAXNEWDIRNUM && DoAThreads <= 1; i++ )
     {
         if(strlen(DirList[i]) == 0 )
            break; 
@@ -719,6 +1494,9 @@ int GenDoA( struct SMInfo *_si, struct DoAlxInfo *_DoA )
         }
     }
 
+    if( DoAManifestMode == 1 && DoAManifestSave() != 0 ) // the DoA list is still right, only the next run can't reuse it
+        printf( "DoAManifestSave() error!\n" );
+
     if ( PrintAllDoA(_DoA, "DoA.csv") != 0 ) //output the _DoA to a file 
     {
         printf( "PrintAllDoA() error!\n" );
@@ -728,6 +1506,40 @@ int GenDoA( struct SMInfo *_si, struct DoAlxInfo *_DoA )
     return 0;
 }
 
+/************************************************************************************************************************************************* 
+ * Function: check if the head line of the file _csv includes the output variables needed by the input records matching _csv
+ * _head: input parameter indicating the head line of the csv file
+ * _csv: input parameter indicating a csv file name
+ * _si: input parameter indicating the input/output information structure array
+ * Return: 0: Yes, the file _csv is what we need
+ *         -1: No, we don't need the file _csv
+ *************************************************************************************************************************************************/
+int CheckHead( struct Span _head, char *_csv, struct SMInfo *_si )
+{
+    int i=0,j=0;
+    struct FileMatch tmp_fm;
+
+    FileMatchBuild( _csv, &tmp_fm );
+
+    for( i=0; i<MAXLINENUM; i++ ) // search each line in the _si array
+    {
+       if( strlen(_si[i].VarType) == 0 ) // only non empty records in the _si array are considered 
+           break;
+       if( IsFileMatchID(&tmp_fm, _si, i) != 0 )  // check if the filename includes the VarType and Alias provided in _si[i]
+           continue;
+       for( j=i;j<MAXLINENUM;j++) //output records are always behind the input records in SM_Info.txt
+       {
+           if( strlen(_si[j].VarType) == 0 ) // screen out the empty records
+               break;
+           if( _si[j].VarType[0] != 'O' ) // screen out the input records and only use the output records
+               continue;
+           if( SpanHasStr( _head, _si[j].FileVarName) != 0 ) // check if the head line of the csv file include the varname existing in _si[j]
+               return 0;
+       }
+    }
+    return -1;
+}
+
 /************************************************************************************************************************************************* 
  * Function: check if the file _csv is what we need 
  * _csv: input parameter indicating a csv file name
@@ -737,9 +1549,8 @@ int GenDoA( struct SMInfo *_si, struct DoAlxInfo *_DoA )
  *************************************************************************************************************************************************/
 int CheckCSV(char *_csv, struct SMInfo *_si )
 {
-    char buff[MAXSTRINGSIZE];
-    int i=0,j=0;
-    FILE *fp = NULL; 
+    struct DevcReader tmp_dr;
+    int rt=0;
 
     //make sure the input parameters are not NULL otherwise we will be in big trouble
     if( _csv == NULL || _si == NULL )
@@ -753,64 +1564,404 @@ int CheckCSV(char *_csv, struct SMInfo *_si )
         return -1;
     }
 
-    fp=fopen(_csv,"r");
-    if( fp == NULL )
+    if( DevcOpen(_csv, &tmp_dr) != 0 ) // we need the second line, namely the head line
     {
-        printf( "fopen() error: _csv=%s", _csv );
+        printf( "DevcOpen() error: _csv=%s", _csv );
         return -1;
     }
 
-    fgets( buff, sizeof(buff),fp); //first line isn't needed 
-    fgets( buff, sizeof(buff),fp); // we need the second line
+    rt = CheckHead( tmp_dr.head, _csv, _si );
+    DevcClose( &tmp_dr );
+    return rt;
+}
 
-    for( i=0; i<MAXLINENUM; i++ ) // search each line in the _si array
+/*************************************************************************************************************************************************
+ * the typed columnar view of a DoA list (FDS_DoA, FDS_RSM or FDS_CMB): DoA builds it once and the SMT/RSM/CMB stages scan its columns instead of
+ * calling trim(), strcmp() and atof() on the strings of struct DoAlxInfo again and again. the string columns are trimmed and interned: the
+ * aliases, VarTypes and FDS variables into FPMSyms, the input values into DoAStrs, so that two strings are the same if and only if their IDs are
+ * the same. the input values are also converted by atof() once. the output
+ * values of record i are at [i*MAXOUTPUTSNUM+k]. the records are still kept for printing the result files
+ *************************************************************************************************************************************************/
+#define DOAKIND_IS 1 // InputVarType includes "IS": sensitivity matrix records
+#define DOAKIND_IR 2 // InputVarType includes "IR": response surface method records
+#define DOAKIND_C  4 // InputVarType[2] is 'C': combined fire scenario records
+
+struct SymTable DoAStrs; // the input values of all the DoATables, so that one string has the same ID in all of them
+
+struct DoATable
+{
+    int n;                         // the number of records
+    const struct DoAlxInfo *rec;   // the records the table is built from
+    unsigned char *kind;           // DOAKIND_IS, DOAKIND_IR, DOAKIND_C
+    unsigned char *flag;           // the flag of every record, initially the flag of the record
+    int *vartype;                  // the ID of InputVarType in FPMSyms.vartype
+    int *alias;                    // the ID of InputAlias in FPMSyms.in
+    int *filevar;                  // the ID of InputFileVarName in FPMSyms.filevar
+    int *basestr;                  // the ID of InputBaseValue in DoAStrs
+    int *newstr;                   // the ID of InputNewValue in DoAStrs
+    double *base;                  // atof(InputBaseValue)
+    double *newv;                  // atof(InputNewValue)
+    unsigned char *nout;           // the number of outputs, namely the non-empty OutputVarType
+    int *out_alias;                // the ID of OutputAlias[k] in FPMSyms.out
+    double *out_base;              // OutputBaseValue[k]
+    double *out_new;               // OutputNewValue[k]
+};
+
+// free the columns of a DoATable
+void DoATableFree( struct DoATable *_dt )
+{
+    free( _dt->kind );
+    free( _dt->flag );
+    free( _dt->vartype );
+    free( _dt->alias );
+    free( _dt->filevar );
+    free( _dt->basestr );
+    free( _dt->newstr );
+    free( _dt->base );
+    free( _dt->newv );
+    free( _dt->nout );
+    free( _dt->out_alias );
+    free( _dt->out_base );
+    free( _dt->out_new );
+    memset( _dt, 0x0, sizeof(struct DoATable) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: build the typed columnar view of a DoA list, the list ends at the first record with an empty InputVarType
+ * _rec: input parameter indicating the DoA list (FDS_DoA, FDS_RSM or FDS_CMB)
+ * _dt: output parameter holding the table, it should be freed by DoATableFree()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoATableBuild( const struct DoAlxInfo *_rec, struct DoATable *_dt )
+{
+    int i=0, k=0, n=0;
+
+    memset( _dt, 0x0, sizeof(struct DoATable) );
+    for( n=0; n<MAXLINENUM && strlen(_rec[n].InputVarType) != 0; n++ )
+        ;
+    _dt->n = n;
+    _dt->rec = _rec;
+    if( n == 0 )
+        n = 1; // no records, the columns are still allocated
+    _dt->kind = calloc( n, sizeof(unsigned char) );
+    _dt->flag = calloc( n, sizeof(unsigned char) );
+    _dt->vartype = calloc( n, sizeof(int) );
+    _dt->alias = calloc( n, sizeof(int) );
+    _dt->filevar = calloc( n, sizeof(int) );
+    _dt->basestr = calloc( n, sizeof(int) );
+    _dt->newstr = calloc( n, sizeof(int) );
+    _dt->base = calloc( n, sizeof(double) );
+    _dt->newv = calloc( n, sizeof(double) );
+    _dt->nout = calloc( n, sizeof(unsigned char) );
+    _dt->out_alias = calloc( (size_t)n*MAXOUTPUTSNUM, sizeof(int) );
+    _dt->out_base = calloc( (size_t)n*MAXOUTPUTSNUM, sizeof(double) );
+    _dt->out_new = calloc( (size_t)n*MAXOUTPUTSNUM, sizeof(double) );
+    if( _dt->kind == NULL || _dt->flag == NULL || _dt->vartype == NULL || _dt->alias == NULL || _dt->filevar == NULL || _dt->basestr == NULL
+        || _dt->newstr == NULL || _dt->base == NULL || _dt->newv == NULL || _dt->nout == NULL || _dt->out_alias == NULL || _dt->out_base == NULL
+        || _dt->out_new == NULL )
     {
-       if( strlen(_si[i].VarType) == 0 ) // only non empty records in the _si array are considered 
-           break;
-       if( IsFileMatch(_csv, _si[i] ) != 0 )  // check if the filename includes the VarType and Alias provided in _si[i]
-           continue;
-       for( j=i;j<MAXLINENUM;j++) //output records are always behind the input records in SM_Info.txt
-       {
-           if( strlen(_si[j].VarType) == 0 ) // screen out the empty records
-               break;
-           if( _si[j].VarType[0] != 'O' ) // screen out the input records and only use the output records
-               continue;
-           if( strstr( buff, _si[j].FileVarName) != NULL ) // check if the head line of the csv file include the varname existing in _si[j]
-           {
-               fclose(fp);
-               return 0;
-           }
-       }
+        printf( "DoATableBuild() error: memory allocation for [%d] records failed!\n", n );
+        DoATableFree( _dt );
+        return -1;
     }
 
-    fclose(fp);
+    for( i=0; i<_dt->n; i++ )
+    {
+        const struct DoAlxInfo *tmp_r = &(_rec[i]);
+
+        _dt->kind[i] = (strstr(tmp_r->InputVarType, "IS") != NULL ? DOAKIND_IS : 0) | (strstr(tmp_r->InputVarType, "IR") != NULL ? DOAKIND_IR : 0)
+                     | (tmp_r->InputVarType[2] == 'C' ? DOAKIND_C : 0);
+        _dt->flag[i] = (unsigned char)tmp_r->flag;
+        _dt->vartype[i] = SymID( &(FPMSyms.vartype), tmp_r->InputVarType, 1 );
+        _dt->alias[i] = SymID( &(FPMSyms.in), tmp_r->InputAlias, 0 );
+        _dt->filevar[i] = SymID( &(FPMSyms.filevar), tmp_r->InputFileVarName, 1 );
+        _dt->basestr[i] = SymID( &DoAStrs, tmp_r->InputBaseValue, 1 );
+        _dt->newstr[i] = SymID( &DoAStrs, tmp_r->InputNewValue, 1 );
+        if( _dt->vartype[i] < 0 || _dt->alias[i] < 0 || _dt->filevar[i] < 0 || _dt->basestr[i] < 0 || _dt->newstr[i] < 0 )
+        {
+            printf( "DoATableBuild() error: record [%d], InputVarType=[%s], InputAlias=[%s] is not in the configuration file!\n", i,
+                    tmp_r->InputVarType, tmp_r->InputAlias );
+            DoATableFree( _dt );
+            return -1;
+        }
+        _dt->base[i] = atof( tmp_r->InputBaseValue );
+        _dt->newv[i] = atof( tmp_r->InputNewValue );
+        for( k=0; k<MAXOUTPUTSNUM; k++ )
+        {
+            _dt->out_base[i*MAXOUTPUTSNUM+k] = tmp_r->OutputBaseValue[k];
+            _dt->out_new[i*MAXOUTPUTSNUM+k] = tmp_r->OutputNewValue[k];
+            _dt->out_alias[i*MAXOUTPUTSNUM+k] = -1;
+            if( _dt->nout[i] == k && strlen(tmp_r->OutputVarType[k]) != 0 )
+            {
+                _dt->nout[i]++;
+                _dt->out_alias[i*MAXOUTPUTSNUM+k] = SymID( &(FPMSyms.out), tmp_r->OutputAlias[k], 0 );
+            }
+        }
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * an open addressing hash table of integer tuples (e.g. the ID columns of a DoA table), every key holds one int value
+ *************************************************************************************************************************************************/
+struct DoAKeys
+{
+    int width;      // the number of ints of one key
+    int num;        // the number of keys
+    int cap;        // the allocated number of keys
+    int *key;       // the keys, key i is at [i*width]
+    int *value;     // the value of every key
+    int *bucket;    // the indexes of the keys, -1 means empty
+    int nbucket;    // the length of bucket, a power of 2
+};
+
+// free a DoAKeys
+void DoAKeysFree( struct DoAKeys *_ks )
+{
+    free( _ks->key );
+    free( _ks->value );
+    free( _ks->bucket );
+    memset( _ks, 0x0, sizeof(struct DoAKeys) );
+}
+
+// return the bucket of _key in _ks: the bucket holding _key, or the empty bucket where _key should be added
+int DoAKeysSlot( const struct DoAKeys *_ks, const int *_key )
+{
+    int tmp_b = (int)(HashFNV1a((const char *)_key, sizeof(int)*_ks->width) & (_ks->nbucket-1));
+
+    while( _ks->bucket[tmp_b] != -1 && memcmp(&(_ks->key[_ks->bucket[tmp_b]*_ks->width]), _key, sizeof(int)*_ks->width) != 0 )
+        tmp_b = (tmp_b+1) & (_ks->nbucket-1);
+    return tmp_b;
+}
+
+// return the value of _key in _ks, -1 if _key is not there
+int DoAKeysGet( const struct DoAKeys *_ks, const int *_key )
+{
+    int tmp_b = 0;
+
+    if( _ks->nbucket == 0 )
+        return -1;
+    tmp_b = DoAKeysSlot( _ks, _key );
+    return (_ks->bucket[tmp_b] == -1) ? -1 : _ks->value[_ks->bucket[tmp_b]];
+}
+
+/*************************************************************************************************************************************************
+ * Function: find the value of a key, and add the key with _value if it isn't there
+ * _ks: input/output parameter indicating the hash table, its width should be set and the rest zeroed before the first call
+ * _key: input parameter indicating the key, _ks->width ints
+ * _value: input parameter indicating the value of the key if it is added
+ * Return: the value of the key which was already there, -1 if the key is added, -2 on failure
+ *************************************************************************************************************************************************/
+int DoAKeysPut( struct DoAKeys *_ks, const int *_key, int _value )
+{
+    int i=0, tmp_b=0;
+
+    if( _ks->nbucket > 0 )
+    {
+        tmp_b = DoAKeysSlot( _ks, _key );
+        if( _ks->bucket[tmp_b] != -1 )
+            return _ks->value[_ks->bucket[tmp_b]];
+    }
+    if( _ks->num == _ks->cap ) // grow the keys and rehash, the hash table is at most half full
+    {
+        int tmp_cap = (_ks->cap > 0) ? _ks->cap*2 : 256;
+        int *tmp_key = realloc( _ks->key, sizeof(int) * tmp_cap * _ks->width );
+        int *tmp_value = NULL;
+
+        if( tmp_key != NULL )
+            _ks->key = tmp_key;
+        tmp_value = realloc( _ks->value, sizeof(int) * tmp_cap );
+        if( tmp_value != NULL )
+            _ks->value = tmp_value;
+        free( _ks->bucket );
+        _ks->nbucket = tmp_cap*2;
+        _ks->bucket = malloc( sizeof(int) * _ks->nbucket );
+        if( tmp_key == NULL || tmp_value == NULL || _ks->bucket == NULL )
+        {
+            printf( "DoAKeysPut() error: memory allocation for [%d] keys failed!\n", tmp_cap );
+            _ks->nbucket = 0;
+            return -2;
+        }
+        _ks->cap = tmp_cap;
+        memset( _ks->bucket, 0xff, sizeof(int) * _ks->nbucket );
+        for( i=0; i<_ks->num; i++ )
+            _ks->bucket[DoAKeysSlot(_ks, &(_ks->key[i*_ks->width]))] = i;
+        tmp_b = DoAKeysSlot( _ks, _key );
+    }
+    memcpy( &(_ks->key[_ks->num*_ks->width]), _key, sizeof(int)*_ks->width );
+    _ks->value[_ks->num] = _value;
+    _ks->bucket[tmp_b] = _ks->num++;
     return -1;
+}
+
+/*************************************************************************************************************************************************
+ * the replicate groups of a DoA table: the records with the same (InputVarType, InputAlias, InputFileVarName, InputBaseValue, InputNewValue) come
+ * from the same FDS file run more than one times (see IsRPDoA()). the groups are found in one pass over the table by hashing the ID columns and
+ * are in the order of their first records. the outputs of every group are accumulated as a sum, which gives the same mean as the former nested
+ * loops, and as a running mean and M2 (Welford's method) for the variance of the replicates
+ *************************************************************************************************************************************************/
+struct DoAGroups
+{
+    int n;           // the number of groups
+    int *row;        // the first record of every group
+    int *count;      // the number of records of every group
+    double *sum;     // the sums of the outputs of every group, output k of group g is at [g*MAXOUTPUTSNUM+k]
+    double *mean;    // the running means of the outputs
+    double *m2;      // the sums of the squared differences from the running means
+};
+
+// free a DoAGroups
+void DoAGroupsFree( struct DoAGroups *_gr )
+{
+    free( _gr->row );
+    free( _gr->count );
+    free( _gr->sum );
+    free( _gr->mean );
+    free( _gr->m2 );
+    memset( _gr, 0x0, sizeof(struct DoAGroups) );
+}
 
+// return the sample variance of output _k of group _g, 0 for a group with one record
+double DoAGroupVar( const struct DoAGroups *_gr, int _g, int _k )
+{
+    if( _gr->count[_g] < 2 )
+        return 0.0;
+    return _gr->m2[_g*MAXOUTPUTSNUM+_k]/(_gr->count[_g]-1);
+}
+
+/*************************************************************************************************************************************************
+ * Function: group the records of a DoA table and accumulate their outputs
+ * _dt: input parameter indicating the DoA table
+ * _kinds: input parameter, only the records of these kinds (DOAKIND_*) are grouped
+ * _skip_flagged: input parameter, 1: the records with flag = 1 (the critical value is not met) are left out, 0: no
+ * _replicates: input parameter, 1: the replicates are grouped together, 0: every record is a group of its own
+ * _gr: output parameter holding the groups, it should be freed by DoAGroupsFree()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAGroupRows( const struct DoATable *_dt, unsigned char _kinds, int _skip_flagged, int _replicates, struct DoAGroups *_gr )
+{
+    int i=0, k=0, rt=0;
+    int *tmp_group = NULL; // the group of every record, -1: left out
+    struct DoAKeys tmp_ks;
+
+    memset( _gr, 0x0, sizeof(struct DoAGroups) );
+    memset( &tmp_ks, 0x0, sizeof(tmp_ks) );
+    tmp_ks.width = 5;
+    tmp_group = malloc( sizeof(int) * (_dt->n > 0 ? _dt->n : 1) );
+    if( tmp_group == NULL )
+    {
+        printf( "DoAGroupRows() error: memory allocation for [%d] records failed!\n", _dt->n );
+        return -1;
+    }
+
+    for( i=0; i<_dt->n; i++ ) // the first pass finds the group of every record
+    {
+        int tmp_key[5];
+
+        tmp_group[i] = -1;
+        if( (_dt->kind[i] & _kinds) == 0 || (_skip_flagged == 1 && _dt->flag[i] == 1) )
+            continue;
+        if( _replicates == 0 )
+        {
+            tmp_group[i] = _gr->n++;
+            continue;
+        }
+        tmp_key[0] = _dt->vartype[i];
+        tmp_key[1] = _dt->alias[i];
+        tmp_key[2] = _dt->filevar[i];
+        tmp_key[3] = _dt->basestr[i];
+        tmp_key[4] = _dt->newstr[i];
+        tmp_group[i] = DoAKeysPut( &tmp_ks, tmp_key, _gr->n );
+        if( tmp_group[i] == -2 )
+        {
+            rt = -1;
+            break;
+        }
+        if( tmp_group[i] == -1 ) // a new group
+            tmp_group[i] = _gr->n++;
+    }
+    DoAKeysFree( &tmp_ks );
+
+    if( rt == 0 && _gr->n > 0 )
+    {
+        _gr->row = malloc( sizeof(int) * _gr->n );
+        _gr->count = calloc( _gr->n, sizeof(int) );
+        _gr->sum = calloc( (size_t)_gr->n*MAXOUTPUTSNUM, sizeof(double) );
+        _gr->mean = calloc( (size_t)_gr->n*MAXOUTPUTSNUM, sizeof(double) );
+        _gr->m2 = calloc( (size_t)_gr->n*MAXOUTPUTSNUM, sizeof(double) );
+        if( _gr->row == NULL || _gr->count == NULL || _gr->sum == NULL || _gr->mean == NULL || _gr->m2 == NULL )
+        {
+            printf( "DoAGroupRows() error: memory allocation for [%d] groups failed!\n", _gr->n );
+            rt = -1;
+        }
+    }
+
+    for( i=0; rt == 0 && i<_dt->n; i++ ) // the second pass accumulates the outputs in the order of the records
+    {
+        int tmp_g = tmp_group[i];
+        const double *tmp_out = &(_dt->out_new[i*MAXOUTPUTSNUM]);
+        double *tmp_sum = NULL, *tmp_mean = NULL, *tmp_m2 = NULL;
+
+        if( tmp_g < 0 )
+            continue;
+        if( _gr->count[tmp_g]++ == 0 )
+            _gr->row[tmp_g] = i;
+        tmp_sum = &(_gr->sum[tmp_g*MAXOUTPUTSNUM]);
+        tmp_mean = &(_gr->mean[tmp_g*MAXOUTPUTSNUM]);
+        tmp_m2 = &(_gr->m2[tmp_g*MAXOUTPUTSNUM]);
+        for( k=0; k<MAXOUTPUTSNUM; k++ )
+        {
+            double tmp_d = tmp_out[k] - tmp_mean[k];
+
+            tmp_sum[k] += tmp_out[k];
+            tmp_mean[k] += tmp_d/_gr->count[tmp_g];
+            tmp_m2[k] += tmp_d*(tmp_out[k] - tmp_mean[k]);
+        }
+    }
+
+    free( tmp_group );
+    if( rt != 0 )
+        DoAGroupsFree( _gr );
+    return rt;
 }
 
+/*************************************************************************************************************************************************
+ * the typed view of a sensitivity matrix record (struct SenMat) which is built along with the record by InsertSMT() and UpdateSMTOneSide()
+ *************************************************************************************************************************************************/
+struct SMTIndex
+{
+    int vartype;    // the ID of InputVarType
+    int alias;      // the ID of InputAlias
+    int filevar;    // the ID of InputFileVarName
+    int basestr;    // the ID of InputBaseValue
+    double base;    // atof(InputBaseValue)
+    double left;    // atof(InputLeftValue)
+    double right;   // atof(InputRightValue)
+};
+
 /************************************************************************************************************************************************* 
- * Function: check if one _DoA record(_single_DoA)  has already been addressed in the sensitivity matrix record (_single_SMT)
- * _single_DoA: input parameter indicating one DoA record
- * _single_SMT: input parameter indicating one sensitivity matrix record
+ * Function: check if one DoA record has already been addressed in the sensitivity matrix record (_single_SMT)
+ * _dt: input parameter indicating the DoA table
+ * _row: input parameter indicating the DoA record in _dt
+ * _single_SMT: input parameter indicating the typed view of one sensitivity matrix record
  * _rt: return value
- * Return: _rt=0: Yes, the _single_DoA has already been addressed in the _single_SMT
+ * Return: _rt=0: Yes, the DoA record has already been addressed in the _single_SMT
  *         -1: the left side value of the sensitivity matrix record is occupied
  *         1: the right side value of the sensitivity matrix record is occupied
  *************************************************************************************************************************************************/
-void IsDoAInSMT( struct DoAlxInfo _single_DoA, struct SenMat _single_SMT, int *_rt )
+void IsDoAInSMT( const struct DoATable *_dt, int _row, const struct SMTIndex *_single_SMT, int *_rt )
 {
-    if( strcmp(trim(_single_DoA.InputVarType,NULL), trim(_single_SMT.InputVarType,NULL)) != 0||
-        strcmp(trim(_single_DoA.InputAlias,NULL), trim(_single_SMT.InputAlias,NULL)) != 0||
-        strcmp(trim(_single_DoA.InputFileVarName, NULL),trim(_single_SMT.InputFileVarName,NULL)) != 0||
-        strcmp(trim(_single_DoA.InputBaseValue,NULL), trim(_single_SMT.InputBaseValue,NULL)) != 0|| 
-        fabs(atof(_single_DoA.InputNewValue)-atof(_single_SMT.InputLeftValue)) < ZERO &&
-        fabs(atof(_single_DoA.InputNewValue)-atof(_single_SMT.InputRightValue)) < ZERO  )
+    if( _dt->vartype[_row] != _single_SMT->vartype || _dt->alias[_row] != _single_SMT->alias || _dt->filevar[_row] != _single_SMT->filevar ||
+        _dt->basestr[_row] != _single_SMT->basestr ||
+        (fabs(_dt->newv[_row]-_single_SMT->left) < ZERO && fabs(_dt->newv[_row]-_single_SMT->right) < ZERO) )
     {
         *_rt = 0;
         return;
     }
   
-    if( fabs(atof(_single_SMT.InputLeftValue)) > ZERO )
+    if( fabs(_single_SMT->left) > ZERO )
         *_rt = -1;
     else 
         *_rt = 1;
@@ -818,32 +1969,29 @@ void IsDoAInSMT( struct DoAlxInfo _single_DoA, struct SenMat _single_SMT, int *_
 }
 
 /************************************************************************************************************************************************* 
- * Function: use the information from -single_doA to fill one side of the _single_SMT (for sensitivity analysis we need left side and right side)
- * _single_DoA: input parameter indicating a calculated analysis data record
+ * Function: use the information from one DoA record to fill one side of the _single_SMT (for sensitivity analysis we need left side and right side)
+ * _dt: input parameter indicating the DoA table
+ * _row: input parameter indicating the DoA record in _dt
+ * _out: input parameter indicating the (averaged) output values of the DoA record
  * _single_SMT: output parameter indicating a sensitivity matrix record
+ * _single_idx: output parameter indicating the typed view of _single_SMT
  * flag: 
  * Return:  void
  *************************************************************************************************************************************************/
-void UpdateSMTOneSide( struct DoAlxInfo _single_DoA, struct SenMat *_single_SMT, int _flag )
+void UpdateSMTOneSide( const struct DoATable *_dt, int _row, const double *_out, struct SenMat *_single_SMT, struct SMTIndex *_single_idx, int _flag )
 {
     int k = 0;
     if( _flag == -1 ) //the left side has already been filled, then fill the right side
     {
-        sprintf( _single_SMT->InputLeftValue, "%s", _single_DoA.InputNewValue );
-        for(k=0;k<MAXOUTPUTSNUM;k++)
-        {
-           if( strlen(_single_DoA.OutputVarType[k] ) == 0 )
-               break;
-           _single_SMT->OutputLeftValue[k] = _single_DoA.OutputNewValue[k];
-        }
+        sprintf( _single_SMT->InputLeftValue, "%s", _dt->rec[_row].InputNewValue );
+        _single_idx->left = _dt->newv[_row];
+        for(k=0;k<_dt->nout[_row];k++)
+           _single_SMT->OutputLeftValue[k] = _out[k];
     } else if (_flag == 1 ){ //the right side has already been filled, then fill the left side
-        sprintf( _single_SMT->InputRightValue, "%s", _single_DoA.InputNewValue );
-        for(k=0;k<MAXOUTPUTSNUM;k++)
-        {
-           if( strlen(_single_DoA.OutputVarType[k] ) == 0 )
-               break;
-           _single_SMT->OutputRightValue[k] = _single_DoA.OutputNewValue[k];
-        }
+        sprintf( _single_SMT->InputRightValue, "%s", _dt->rec[_row].InputNewValue );
+        _single_idx->right = _dt->newv[_row];
+        for(k=0;k<_dt->nout[_row];k++)
+           _single_SMT->OutputRightValue[k] = _out[k];
     } else 
        printf( "wrong parameter: flag can only be -1 or 1, you pass flag=[%d]\n", _flag );
 
@@ -852,46 +2000,55 @@ void UpdateSMTOneSide( struct DoAlxInfo _single_DoA, struct SenMat *_single_SMT,
 
 /************************************************************************************************************************************************* 
  * Function: insert a new record to the sensitivity matrix list
- * _single_DoA: input parameter indicating  one calculated analysis record
+ * _dt: input parameter indicating the DoA table
+ * _row: input parameter indicating the DoA record in _dt
+ * _out: input parameter indicating the (averaged) output values of the DoA record
  * _SMT: output parameter indicating a sensitivity matrix list
+ * _idx: output parameter indicating the typed view of _SMT
  * _index: input parameter indicating the end position of the _SMT where a new record will be put in
  * Return: void
  *************************************************************************************************************************************************/
-void InsertSMT( struct DoAlxInfo _single_DoA, struct SenMat *_SMT, int _index )
+void InsertSMT( const struct DoATable *_dt, int _row, const double *_out, struct SenMat *_SMT, struct SMTIndex *_idx, int _index )
 {
      int k=0, flag = 0;
+     const struct DoAlxInfo *tmp_r = &(_dt->rec[_row]);
 
      _SMT[_index].SenMatType = 0; //0 center, -1 backward, 1 forward 
-     sprintf( _SMT[_index].InputVarType, "%s", _single_DoA.InputVarType );
-     sprintf( _SMT[_index].InputAlias, "%s", _single_DoA.InputAlias);
-     sprintf( _SMT[_index].InputFileVarName, "%s", _single_DoA.InputFileVarName);
-     sprintf( _SMT[_index].InputBaseValue, "%s", _single_DoA.InputBaseValue);
-     if( atof(_single_DoA.InputNewValue) - atof(_single_DoA.InputBaseValue)  > ZERO )
+     sprintf( _SMT[_index].InputVarType, "%s", tmp_r->InputVarType );
+     sprintf( _SMT[_index].InputAlias, "%s", tmp_r->InputAlias);
+     sprintf( _SMT[_index].InputFileVarName, "%s", tmp_r->InputFileVarName);
+     sprintf( _SMT[_index].InputBaseValue, "%s", tmp_r->InputBaseValue);
+     _idx[_index].vartype = _dt->vartype[_row];
+     _idx[_index].alias = _dt->alias[_row];
+     _idx[_index].filevar = _dt->filevar[_row];
+     _idx[_index].basestr = _dt->basestr[_row];
+     _idx[_index].base = _dt->base[_row];
+     if( _dt->newv[_row] - _dt->base[_row]  > ZERO )
      { //if the input new value > the base value, then put the new value to the right side
-         sprintf( _SMT[_index].InputRightValue, "%s", _single_DoA.InputNewValue);
+         sprintf( _SMT[_index].InputRightValue, "%s", tmp_r->InputNewValue);
+         _idx[_index].right = _dt->newv[_row];
          flag = 1;
      }
      else
      { //if the input new value < the base value, then put the new value to the left side
-         sprintf( _SMT[_index].InputLeftValue, "%s", _single_DoA.InputNewValue);
+         sprintf( _SMT[_index].InputLeftValue, "%s", tmp_r->InputNewValue);
+         _idx[_index].left = _dt->newv[_row];
          flag = -1;
      }
      
-     for( k=0;k<MAXOUTPUTSNUM;k++ )
+     for( k=0;k<_dt->nout[_row];k++ )
      { //deal with more than one output variables condition
-         if( strlen(_single_DoA.OutputVarType[k]) == 0 )
-             break;
-         sprintf( _SMT[_index].OutputVarType[k], "%s", _single_DoA.OutputVarType[k]);
-         sprintf( _SMT[_index].OutputAlias[k], "%s", _single_DoA.OutputAlias[k]);
-         sprintf( _SMT[_index].TargetName[k], "%s", _single_DoA.TargetName[k]);
-         sprintf( _SMT[_index].OutputFileVarName[k], "%s", _single_DoA.OutputFileVarName[k]);
-         sprintf( _SMT[_index].comment[k], "%s", _single_DoA.comment[k]);
-         _SMT[_index].OutputBaseValue[k]= _single_DoA.OutputBaseValue[k];
+         sprintf( _SMT[_index].OutputVarType[k], "%s", tmp_r->OutputVarType[k]);
+         sprintf( _SMT[_index].OutputAlias[k], "%s", tmp_r->OutputAlias[k]);
+         sprintf( _SMT[_index].TargetName[k], "%s", tmp_r->TargetName[k]);
+         sprintf( _SMT[_index].OutputFileVarName[k], "%s", tmp_r->OutputFileVarName[k]);
+         sprintf( _SMT[_index].comment[k], "%s", tmp_r->comment[k]);
+         _SMT[_index].OutputBaseValue[k]= _dt->out_base[_row*MAXOUTPUTSNUM+k];
         
          if( flag == 1 ) // right side
-             _SMT[_index].OutputRightValue[k]= _single_DoA.OutputNewValue[k];
+             _SMT[_index].OutputRightValue[k]= _out[k];
          else  // left side
-             _SMT[_index].OutputLeftValue[k]= _single_DoA.OutputNewValue[k];
+             _SMT[_index].OutputLeftValue[k]= _out[k];
      }
 
      return;
@@ -899,37 +2056,50 @@ void InsertSMT( struct DoAlxInfo _single_DoA, struct SenMat *_SMT, int _index )
 
 /************************************************************************************************************************************************* 
  * Function: Update an existing sensitivity matrix record by calling UpdateSMTOneSide()
- * _single_DoA: input parameter indicating one calculated analysis record
+ * _dt: input parameter indicating the DoA table
+ * _row: input parameter indicating the DoA record in _dt
+ * _out: input parameter indicating the (averaged) output values of the DoA record
  * _SMT: output parameter indicating the sensitivity matrix list
+ * _idx: output parameter indicating the typed view of _SMT, the records are compared by it
+ * _ks: input/output parameter holding the first _SMT record of every (InputVarType, InputAlias, InputFileVarName, InputBaseValue)
+ * _n: input/output parameter indicating the number of records in _SMT
  * Return: 0: success
  *         -1: failure due to the size limitation of sensitivity matrix  list
  *************************************************************************************************************************************************/
-int UpdateSMT( struct DoAlxInfo _single_DoA, struct SenMat *_SMT )
+int UpdateSMT( const struct DoATable *_dt, int _row, const double *_out, struct SenMat *_SMT, struct SMTIndex *_idx, struct DoAKeys *_ks, int *_n )
 {
     int i=0,rt=0;
-    for( i=0;i<MAXINPUTSNUM; i++ )
+    int tmp_key[4];
+
+    tmp_key[0] = _dt->vartype[_row];
+    tmp_key[1] = _dt->alias[_row];
+    tmp_key[2] = _dt->filevar[_row];
+    tmp_key[3] = _dt->basestr[_row];
+    i = DoAKeysGet( _ks, tmp_key );
+    if( i >= 0 )
     {
-        if( strlen(_SMT[i].InputVarType) == 0 )
-            break;
-        IsDoAInSMT(_single_DoA,_SMT[i],&rt); 
+        IsDoAInSMT(_dt, _row, &(_idx[i]), &rt); 
         if( rt == -1 ) // the left side is already occupied, then update the right side
         {
-           UpdateSMTOneSide(_single_DoA, &(_SMT[i]), 1);
+           UpdateSMTOneSide(_dt, _row, _out, &(_SMT[i]), &(_idx[i]), 1);
            return 0;
         } else if ( rt == 1 )//the right side is already occupied, then update the left side
         {
-           UpdateSMTOneSide(_single_DoA, &(_SMT[i]), -1);
+           UpdateSMTOneSide(_dt, _row, _out, &(_SMT[i]), &(_idx[i]), -1);
            return 0;
         } 
     } 
     
-    //at this time i should be at the end of the _SMT list
-    if( i<MAXINPUTSNUM)
+    //at this time *_n should be at the end of the _SMT list
+    if( *_n<MAXINPUTSNUM)
     {
-        InsertSMT( _single_DoA, _SMT, i ); //insert one record to the _SMT list at the end of the _SMT list
+        InsertSMT( _dt, _row, _out, _SMT, _idx, *_n ); //insert one record to the _SMT list at the end of the _SMT list
+        if( DoAKeysPut(_ks, tmp_key, *_n) == -2 )
+            return -1;
+        (*_n)++;
         return 0;
     }else {
-        printf( " MAXLINENUM is met: i= %d\n", i );
+        printf( " MAXLINENUM is met: i= %d\n", *_n );
         return -1;
     }
 }
@@ -937,18 +2107,16 @@ int UpdateSMT( struct DoAlxInfo _single_DoA, struct SenMat *_SMT )
 /************************************************************************************************************************************************* 
  * Function: check if the two records are from the same FDS file which has been run more than one times to reduce the fluctuation of the FDS 
  *           simulation results
- *_single_i: input parameter indicating one DoA record
- *_single_j: input parameter indicating the other DoA record
+ * _dt: input parameter indicating the DoA table
+ * _i: input parameter indicating one DoA record in _dt
+ * _j: input parameter indicating the other DoA record in _dt
  * Return: 0: Yes, the two records are from the same FDS file
  *         -1: No, they come from different FDS file
  *************************************************************************************************************************************************/
-int IsRPDoA(struct DoAlxInfo _single_i, struct DoAlxInfo _single_j ) 
+int IsRPDoA( const struct DoATable *_dt, int _i, int _j )
 {
-    if( strcmp(trim(_single_i.InputVarType,NULL),trim(_single_j.InputVarType,NULL)) != 0|| 
-        strcmp(trim(_single_i.InputAlias,NULL),trim(_single_j.InputAlias,NULL)) != 0|| 
-        strcmp(trim(_single_i.InputFileVarName,NULL),trim(_single_j.InputFileVarName,NULL)) != 0|| 
-        strcmp(trim(_single_i.InputBaseValue,NULL), trim(_single_j.InputBaseValue,NULL) ) != 0|| 
-        strcmp(trim(_single_i.InputNewValue,NULL),trim( _single_j.InputNewValue,NULL) )!=0 )
+    if( _dt->vartype[_i] != _dt->vartype[_j] || _dt->alias[_i] != _dt->alias[_j] || _dt->filevar[_i] != _dt->filevar[_j] ||
+        _dt->basestr[_i] != _dt->basestr[_j] || _dt->newstr[_i] != _dt->newstr[_j] )
         return -1;
 
     return 0;
@@ -957,19 +2125,20 @@ int IsRPDoA(struct DoAlxInfo _single_i, struct DoAlxInfo _single_j )
 /************************************************************************************************************************************************* 
  * Function: calculate the sensitivity value and the change rate of each sensitivity record in _SMT
  * _SMT: input/output parameter indicating a snesitivity matrix list
+ * _idx: input parameter indicating the typed view of _SMT
  * Return:  void
  *************************************************************************************************************************************************/
-void CalSMT( struct SenMat *_SMT )
+void CalSMT( struct SenMat *_SMT, const struct SMTIndex *_idx )
 {
     int i=0,k=0;
-    for( i=0;i<MAXLINENUM; i++ )
+    for( i=0;i<MAXINPUTSNUM; i++ )
     {
         double tmp_d=0.0;
 
         if( strlen(_SMT[i].InputVarType) == 0 )
             return;
-        tmp_d = atof(_SMT[i].InputRightValue)-atof(_SMT[i].InputLeftValue);
-        _SMT[i].ChangeRate = tmp_d/atof(_SMT[i].InputBaseValue);
+        tmp_d = _idx[i].right-_idx[i].left;
+        _SMT[i].ChangeRate = tmp_d/_idx[i].base;
         for( k=0;k<MAXOUTPUTSNUM; k++ )
             _SMT[i].Sensitivity[k] = (_SMT[i].OutputRightValue[k]-_SMT[i].OutputLeftValue[k])/tmp_d;
     }
@@ -1075,11 +2244,11 @@ int UpdateRSM(struct DoAlxInfo _single_DoA, struct DoAlxInfo *_RSM)
     return 0;
 }
 /* *************************************************************************************************************************************************
- * Functions: find experimental data pairs from _RSM based on _IA and _OA for the use of power curve fitting
+ * Functions: find experimental data pairs from the RSM table based on _IA and _OA for the use of power curve fitting
  * Input: 
- * _IA : InputAlias indicating the input variable, 
- * _OA: OutputAlias indicating the output variable, 
- * _RSM: includes the Response surfamce method needed information, 
+ * _IA : the ID of the InputAlias indicating the input variable, 
+ * _OA: the ID of the OutputAlias indicating the output variable, 
+ * _rt: the DoA table of the _RSM list which includes the Response surfamce method needed information, 
  * _num: the array size of _x and _y
  * Output:
  * _x: the input value list;
@@ -1089,32 +2258,30 @@ int UpdateRSM(struct DoAlxInfo _single_DoA, struct DoAlxInfo *_RSM)
  * 0: success;
  * -1: failure ;
  **************************************************************************************************************************************************/ 
-int GetXYFromRSM( char * _IA, char *_OA, struct DoAlxInfo *_RSM, double *_x, double *_y, int *_num)
+int GetXYFromRSM( int _IA, int _OA, const struct DoATable *_rt, double *_x, double *_y, int *_num)
 {
     int i=0,j=0,k=0;
 
-    if( _IA == NULL || _OA == NULL || _RSM == NULL || _x == NULL || _y == NULL || _num == NULL )
+    if( _rt == NULL || _x == NULL || _y == NULL || _num == NULL )
     {
         printf( "at least one of the parameters are NULL !\n");
         return -1;
     }
 
-    for( i=0; i<MAXLINENUM; i++ )
+    for( i=0; i<_rt->n; i++ )
     {
-        if( strlen(trim(_RSM[i].InputVarType, NULL))==0)
-            break;
-        for( k=0; k<MAXOUTPUTSNUM; k++)
+        if( _rt->alias[i] != _IA )
+            continue;
+        for( k=0; k<_rt->nout[i]; k++)
         {
-            if( strlen(trim(_RSM[i].OutputVarType[k], NULL))==0)
-                break;
-            if( strcmp(_IA, _RSM[i].InputAlias)==0 && strcmp(_OA, _RSM[i].OutputAlias[k])==0 )
+            if( _rt->out_alias[i*MAXOUTPUTSNUM+k] == _OA )
             { //for one input variable and one output variable, there maybe several records in RSM depending on the configuration file
-                _x[j] = atof(_RSM[i].InputNewValue);
-                _y[j] = _RSM[i].OutputNewValue[k];
+                _x[j] = _rt->newv[i];
+                _y[j] = _rt->out_new[i*MAXOUTPUTSNUM+k];
                 j++;
                 if( j==*_num)
                 {
-                    printf( "too many experimental data: j=_num=%d, discard the left data set, i=%d,k=%d,inputVarType=%s,outputVarType=%f\n", j,i,k,_RSM[i].InputVarType, _RSM[i].OutputNewValue[k] );
+                    printf( "too many experimental data: j=_num=%d, discard the left data set, i=%d,k=%d,inputVarType=%s,outputVarType=%f\n", j,i,k,_rt->rec[i].InputVarType, _rt->out_new[i*MAXOUTPUTSNUM+k] );
                     return 0;
                 }
             }
@@ -1137,6 +2304,8 @@ int GetOneXY( char *_OA, struct DoAlxInfo _single_CMB, struct RSMResults *_RSMRl
 {
     int i=0,j=0;
     
+    if( RSMCoefs.src != _RSMRlt ) // the coefficients are rebuilt by RSMCoefBuild() whenever _RSMRlt is changed
+        RSMCoefBuild( _RSMRlt, &RSMCoefs );
     for( i=0; i<MAXOUTPUTSNUM; i++ )
     {
         if( strcmp(_OA, _single_CMB.OutputAlias[i])== 0 )
@@ -1158,7 +2327,7 @@ int GetOneXY( char *_OA, struct DoAlxInfo _single_CMB, struct RSMResults *_RSMRl
                 double tmp_a=0.0, tmp_b=0.0;
                 double tmp_input_value = atof(tmp_VIC[1].ColVal[j]);
 
-                if( GetParFromRSMRlt(tmp_VIC[0].ColVal[j], _OA, _RSMRlt, &tmp_a, &tmp_b ) == -1 )
+                if( GetParFromRSMRlt(SymID(&(FPMSyms.in), tmp_VIC[0].ColVal[j], 0), SymID(&(FPMSyms.out), _OA, 0), &RSMCoefs, &tmp_a, &tmp_b ) == -1 )
                 {
                     printf( "GetParFromRSMRlt()error! j=%d, _IA=%s, _OA=%s\n", j, tmp_VIC[0].ColVal[j], _OA );  
                     return -1;
@@ -1256,14 +2425,14 @@ int GetInputAliasFromCMB(char *_OA, struct DoAlxInfo * _CMB, char *_IA )
  * Function: fill _RSMRlt with the information from _RSM, _CMB, and _si.the main purpose is to calculate the parameters of power fitting curves between the inputAlias and OutputAlias. this function is the core of the RSM method which includes two levels of power curve fitting: 
  *        1. power curve fitting between one output and one input, namely how a single input could affect the result of one single output. the (x,y)pair list comes from _RSM  with information from _si being involved: y[j]=a[ij]*x[i]^b[ij], a[ij] and b[ij] will be calcualted for each input and output variable
  *        2. power curve fitting between one output and several/all input variables, namely how a combined fire scenairo with all input variables chaning at the same time could change the result of one output. This is done based on the first round curve fitting results, namely the b value of the regress equation: Y[j]=A[j]*X[j]^B[j] where X[j] *= (x[ij]^b[ij]), A[j] and B[j] will be calculated for each output variable.
- * _RSM: input parameter indicating the response surface method (RSM) record list
+ * _rt: input parameter indicating the DoA table of the response surface method (RSM) record list
  * _CMB: input parameter indicating the combined fire scenarios record list
  * _si:  input parameter indicating the configuration file content
  * _RSMRlt: output parameter indicating the calcualted result of the RSM list
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int CalRSMRlt(struct DoAlxInfo *_RSM, struct DoAlxInfo *_CMB, struct SMInfo *_si, struct RSMResults *_RSMRlt)
+int CalRSMRlt(const struct DoATable *_rt, struct DoAlxInfo *_CMB, struct SMInfo *_si, struct RSMResults *_RSMRlt)
 {
     int i=0,j=0,k=0;
     struct VarInCol FDS_InputsVar[2];
@@ -1302,7 +2471,7 @@ int CalRSMRlt(struct DoAlxInfo *_RSM, struct DoAlxInfo *_CMB, struct SMInfo *_si
             
             if( strlen(FDS_OutputsVar[0].ColVal[j]) == 0)
                 break;
-            if( GetXYFromRSM(FDS_InputsVar[0].ColVal[i], FDS_OutputsVar[0].ColVal[j], _RSM, tmp_x, tmp_y, &num ) != 0 )
+            if( GetXYFromRSM(SymID(&(FPMSyms.in), FDS_InputsVar[0].ColVal[i], 0), SymID(&(FPMSyms.out), FDS_OutputsVar[0].ColVal[j], 0), _rt, tmp_x, tmp_y, &num ) != 0 )
             {
                 printf( "GetXYFromRSM() error!\n, i=%d, j=%d, inputAlias=%s, Output Alias=%s\n",i, j, FDS_InputsVar[0].ColVal[i], FDS_OutputsVar[0].ColVal[j]);
                 return -1;
@@ -1322,6 +2491,8 @@ int CalRSMRlt(struct DoAlxInfo *_RSM, struct DoAlxInfo *_CMB, struct SMInfo *_si
     }
 
 
+    RSMCoefBuild( FDS_RSMResults, &RSMCoefs ); // the second round uses the parameters of the first round
+
     // Second round curve fitting: this for sentence adds records of power curve fitting parameter between one output and many inputs
     for( j=0; j<MAXOUTPUTSNUM; j++)
     {
@@ -1354,252 +2525,201 @@ int CalRSMRlt(struct DoAlxInfo *_RSM, struct DoAlxInfo *_CMB, struct SMInfo *_si
          k++;
     }
 
+    RSMCoefBuild( FDS_RSMResults, &RSMCoefs );
     return 0;
 }
 
 /************************************************************************************************************************************************* 
- * Function: extract the sensitivity matrix information from _SMT which is a detailed sensitivity data source
+ * Function: extract the sensitivity matrix from _SMT which is a detailed sensitivity data source and save it to the file of _SMT_fn
  * _SMT: input parameter indicating detailed sensitivity data source
- * _sen_matx: output parameter indicating the sensitivity matrix
- * _SMT_fn: input parameter indicating a file holding the sensitivity matrix data
+ * _sm: output parameter indicating the sensitivity matrix, the sensitivities are kept as they are printed to _SMT_fn, so that the combined
+ *      fire scenarios are predicted with the same matrix FirePM reads
+ * _SMT_fn: input parameter indicating a file holding the sensitivity matrix data, _sm is extracted even if the file cannot be written
  * Return: void
  *         
  *************************************************************************************************************************************************/
-void GetSenMatx(struct SenMat *_SMT, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128], char *_SMT_fn )
+void GetSenMatx(struct SenMat *_SMT, struct SenMatrix *_sm, char *_SMT_fn )
 {
-    int i=0;
-    FILE *fp=fopen(_SMT_fn, "w+" );
-
-    sprintf(_sen_matx[0][0], "%s", "dy/dx" );
+    int i=0,j=0;
+    FILE *fp=FPMSnapCreate( _SMT_fn, 1 ); // published as a snapshot, FirePM never reads a matrix being written
 
-    //search sensitivity values from _SMT  and put them into the SenMatx  list 
-    for( i=0; i<= MAXINPUTSNUM; i++ )
+    SenMatrixClear( _sm );
+    if( fp == NULL )
+        printf( "GetSenMatx() error: [%s] cannot be written, the sensitivity matrix is only kept in memory!\n", _SMT_fn );
+    if( strlen(_SMT[0].InputVarType) == 0 )
     {
-        int j=0;
-
-        if( i>0 )
-        {
-            if( strlen(_SMT[i-1].InputVarType) == 0 )
-                break;
-        } else {
-            if( strlen(_SMT[i].InputVarType) == 0 )
-                break;
-        }
-
-        for( j=0; j<= MAXOUTPUTSNUM; j++ )
-        {
-           if( i==0 && j==0 )
-           {
-               sprintf(_sen_matx[i][j], "%s", "dy/dx" );
-               printf( "_sen_matx[%d][%d]=[%s]\n", i,j,_sen_matx[i][j] );
-               continue;
-           }
-           if( i==0 && j>0 )
-           {
-               if( strlen(_SMT[i].OutputAlias[j-1]) == 0 )
-                   break;
-               sprintf(_sen_matx[i][j], "%s", _SMT[i].OutputAlias[j-1] );
-               printf( "_sen_matx[%d][%d]=[%s]\n", i,j,_sen_matx[i][j] );
-               continue;
-           }
-           if( i>0 && j==0 )
-           {
-               if( strlen(_SMT[i-1].InputAlias) == 0 )
-                   break;
-               sprintf(_sen_matx[i][j], "%s", _SMT[i-1].InputAlias );
-               printf( "_sen_matx[%d][%d]=[%s]\n", i,j,_sen_matx[i][j] );
-               continue;
-           }
-           if( i>0 && j>0 )
-           {
-               if( fabs(_SMT[i-1].Sensitivity[j-1] ) < ZERO )
-                   break;
-               sprintf(_sen_matx[i][j], "%lf", _SMT[i-1].Sensitivity[j-1]);
-               printf( "_sen_matx[%d][%d]=[%s]\n", i,j, _sen_matx[i][j] );
-               continue;
-           }
-        }
-        
+        if( fp != NULL && FPMSnapPublish( _SMT_fn, fp, 1 ) != 0 )
+            printf( "GetSenMatx() error: FPMSnapPublish() [%s] failed!\n", _SMT_fn );
+        return;
     }
 
+    //the output aliases of the first record are the columns
     printf( "Senmatx is below:\n" );
-    // print the sensitivity matrix to SMT.csv
-    for( i=0; i<=MAXINPUTSNUM; i++ )
+    printf( "dy/dx\t" );
+    if( fp != NULL )
+        fprintf( fp, "dy/dx" );
+    for( j=0; j<MAXOUTPUTSNUM; j++ )
     {
-        int j=0;
+        if( strlen(_SMT[0].OutputAlias[j]) == 0 )
+            break;
+        sprintf(_sm->out_alias[j], "%s", _SMT[0].OutputAlias[j] );
+        printf( "%s\t", _sm->out_alias[j] );
+        if( fp != NULL )
+            fprintf( fp, ",%s", _sm->out_alias[j] );
+    }
+    _sm->nout = j;
+    printf( "\n");
+    if( fp != NULL )
+        fprintf(fp,"\n");
 
-        if( i> 0 )
-        {
-            if( strlen(_SMT[i-1].InputVarType) == 0 )
-                break;
-        }else {
-            if( strlen(_SMT[i].InputVarType) == 0 )
-                break;
-        }
+    //every record of _SMT is a row, a row ends at the first zero sensitivity
+    for( i=0; i<MAXINPUTSNUM; i++ )
+    {
+        if( strlen(_SMT[i].InputVarType) == 0 )
+            break;
 
-        for( j=0; j<=MAXOUTPUTSNUM; j++ )
+        sprintf(_sm->in_alias[i], "%s", _SMT[i].InputAlias );
+        _sm->nin = i+1;
+        if( strlen(_SMT[i].InputAlias) > 0 )
         {
-            if( i>0 && j> 0 )
+            printf( "%s\t", _SMT[i].InputAlias );
+            if( fp != NULL )
+                fprintf( fp, "%s", _SMT[i].InputAlias );
+            for( j=0; j<MAXOUTPUTSNUM; j++ )
             {
-                if( fabs(_SMT[i-1].Sensitivity[j-1] ) < ZERO )
+                char tmp_str[128];
+
+                if( fabs(_SMT[i].Sensitivity[j] ) < ZERO )
                     break;
-            }
-            if( strlen(_sen_matx[i][j]) > 0 )
-            {
-                printf( "%s\t", _sen_matx[i][j] );
-                if( j == 0 )
-                    fprintf(fp, "%s", _sen_matx[i][j] );
-                else 
-                    fprintf(fp, ",%s", _sen_matx[i][j] );
+                memset( tmp_str, 0x0, sizeof(tmp_str) );
+                sprintf( tmp_str, "%lf", _SMT[i].Sensitivity[j]);
+                _sm->sen[i][j] = atof( tmp_str );
+                printf( "%s\t", tmp_str );
+                if( fp != NULL )
+                    fprintf( fp, ",%s", tmp_str );
             }
         }
         printf( "\n");
-        fprintf(fp,"\n");
+        if( fp != NULL )
+            fprintf(fp,"\n");
     }
-    fclose(fp);
+    if( fp != NULL && FPMSnapPublish( _SMT_fn, fp, 1 ) != 0 )
+        printf( "GetSenMatx() error: FPMSnapPublish() [%s] failed!\n", _SMT_fn );
+    SenMatrixIndex( _sm );
     return;
 }
 
 /************************************************************************************************************************************************* 
- * Function: find the sensitivity of _OutputAlias to _InputAlias from SenMatx 
- * _InputAlias: input parameter indicating an input variable name (Alias)
- * _OutputAlias: input parameter indicating an output variable name (Alias)
- * _sen_matx: input parameter indicating a sensitivity matrix
+ * Function: find the sensitivity of an output variable to an input variable from the sensitivity matrix
+ * _ia: input parameter indicating the ID of an input variable name (Alias)
+ * _oa: input parameter indicating the ID of an output variable name (Alias)
+ * _sm: input parameter indicating a sensitivity matrix
  * _OneSen: output parameter indicating  one sensitivity 
  * Return: 0: success
  *         -1: Failure
  *************************************************************************************************************************************************/
-int RtOneSen(char *_InputAlias, char *_OutputAlias, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128], double *_OneSen )
+int RtOneSen( int _ia, int _oa, const struct SenMatrix *_sm, double *_OneSen )
 {
-    int i=0,k=0;
-    int flag = 0;
-
-    // find the location of the input variable matching _InputAlias
-    for( i=0; i<=MAXINPUTSNUM;i++ )
-    {
-         if( strcmp( _sen_matx[i][0], _InputAlias ) == 0 )
-         {
-             flag++ ;
-             break;
-         }
-    }
-
-    // find the location of the output variable matching _OutputAlias
-    for( k=0; k<=MAXOUTPUTSNUM; k++ )
-    {
-         if( strcmp( _sen_matx[0][k], _OutputAlias ) == 0 )
-         {
-             flag++ ;
-             break;
-         }
-    }
-
-    if( flag == 2 ) //both input and output are found 
-    {
-        *_OneSen = atof(_sen_matx[i][k]);
+    if( SenMatrixGet(_sm, _ia, _oa, _OneSen) == 0 ) //both input and output are found 
         return 0;
-    } else {
-        printf( "RtOneSen() error: cannot find the sensitivity: flag=[%d], _InputAlias=[%s], _OutputAlias[%s]\n", flag, _InputAlias, _OutputAlias );
-        return -1;    
-    }
+    printf( "RtOneSen() error: cannot find the sensitivity: _InputAlias=[%s], _OutputAlias[%s]\n", (_ia >= 0 && _ia < FPMSyms.in.num) ? FPMSyms.in.str[_ia] : "",
+            (_oa >= 0 && _oa < FPMSyms.out.num) ? FPMSyms.out.str[_oa] : "" );
+    return -1;    
 }
 
 /************************************************************************************************************************************************* 
  * Function: this function calculates the value of outputalias predicted by the sensitivity matrix method and put them in the PreValueSMT filed to compare with the output results from FDS simulation
  * _CMB: input/output parameter indicating analysis data of combined fire scenairo
- * _sen_matx: input parameter indicating the sensitivity matrx
+ * _ct: input/output parameter indicating the DoA table of _CMB, it is built before the input aliases of _CMB are concatenated
+ * _sm: input parameter indicating the sensitivity matrx
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int CalCMB(struct DoAlxInfo *_CMB, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128] )
+int CalCMB(struct DoAlxInfo *_CMB, struct DoATable *_ct, const struct SenMatrix *_sm )
 {
-    int i=0,j=0;
-    struct DoAlxInfo *tmp_smt = FDS_SenMat;
-    
-    // set flag back to 0 for next step usage
-    for( i=0; i<MAXLINENUM; i++ )
-    {
-       if( strlen(_CMB[i].InputVarType) == 0 )
-           continue;
-       else 
-           _CMB[i].flag = 0; //unprocessed 
-    }
-    for( i=0; i<MAXLINENUM; i++ ) //for every record in _CMB
-    {
-        int tmp_i=0, tmp_k=0;
-        char tmp_VarType[4];
-        double tmp_gap[MAXOUTPUTSNUM];
-
-        printf( "in CalCMB before for: _CMB[%d].flag = [%d]\n", i, _CMB[i].flag );
+    int i=0,j=0,tmp_k=0,rt=0;
+    int *tmp_first = NULL;   // the first record of every InputVarType (indexed by its ID), -1: not yet
+    double *tmp_gap = NULL;  // the gaps of the first records, [i*MAXOUTPUTSNUM+k]
 
-        if( _CMB[i].flag > 0 )
-            continue;
+    if( _ct->n == 0 )
+        return 0;
+    tmp_first = malloc( sizeof(int) * FPMSyms.vartype.num );
+    tmp_gap = calloc( (size_t)_ct->n*MAXOUTPUTSNUM, sizeof(double) );
+    if( tmp_first == NULL || tmp_gap == NULL )
+    {
+        printf( "CalCMB() error: memory allocation for [%d] records failed!\n", _ct->n );
+        free( tmp_first );
+        free( tmp_gap );
+        return -1;
+    }
+    memset( tmp_first, 0xff, sizeof(int) * FPMSyms.vartype.num );
+    
+    // set flag back to 0 for next step usage
+    memset( _ct->flag, 0x0, _ct->n );
+    for( i=0; i<_ct->n; i++ )
+       _CMB[i].flag = 0; //unprocessed 
 
-        if( strlen(_CMB[i].InputVarType) == 0 )
-            break;
+    // for combined records, the first record of a group with the same InputVarType includes all the input variables and input values and the
+    // gap predicted by the sensitivity matrix. one pass adds every record to the first record of its InputVarType
+    for( j=0; j<_ct->n && rt == 0; j++ )
+    {
+        double tmp_input_gap= _ct->newv[j]-_ct->base[j];
 
-        memset( tmp_gap, 0x0, sizeof(tmp_gap) );
+        i = tmp_first[_ct->vartype[j]];
+        if( i < 0 )
+            i = tmp_first[_ct->vartype[j]] = j;
 
-        // add the first addition from the first variable to the gap
-        for( tmp_k=0; tmp_k<MAXOUTPUTSNUM; tmp_k++ )
+        // the outputs behind the last one have no sensitivity
+        for( tmp_k=0; tmp_k<_ct->nout[j]; tmp_k++ )
         {
-             double tmp_rt=0.0;
-             if( RtOneSen(_CMB[i].InputAlias, _CMB[i].OutputAlias[tmp_k],_sen_matx, &tmp_rt) != 0 )
-             {
-                 printf( "CalCMB() error!\n" );
-                 return -1;
-             } else {
-                 tmp_gap[tmp_k] = tmp_rt*(atof(_CMB[i].InputNewValue)-atof(_CMB[i].InputBaseValue));
-             }
+            double tmp_rt=0.0;
+            if( RtOneSen(_ct->alias[j], _ct->out_alias[j*MAXOUTPUTSNUM+tmp_k], _sm, &tmp_rt) != 0 )
+            {
+                printf( "CalCMB() error!\n" );
+                rt = -1;
+                break;
+            }
+            tmp_gap[i*MAXOUTPUTSNUM+tmp_k] += tmp_input_gap*tmp_rt;
         }
 
-        for( j=i+1; j<MAXLINENUM; j++ )
+        if( rt == 0 && i != j )
         {
-            // for combined records, the sentence make sure that the first record of a group with the same InputVarType include all the input variables  and inut values and put the prediction results by sensitivity matrix into comment
-            if( strcmp(_CMB[i].InputVarType, _CMB[j].InputVarType) == 0 )
-            {
-                double tmp_input_gap= atof(_CMB[j].InputNewValue)-atof(_CMB[j].InputBaseValue);
-                for( tmp_k=0; tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-                {
-                    double tmp_rt=0.0;
-                    if( RtOneSen(_CMB[j].InputAlias, _CMB[j].OutputAlias[tmp_k],_sen_matx, &tmp_rt) != 0 )
-                    {
-                        printf( "CalCMB() error!\n" );
-                        return -1;
-                    } else {
-                       tmp_gap[tmp_k] += tmp_input_gap*tmp_rt;
-                    }
-                }
-             
-                strcat(_CMB[i].InputAlias, "+" );
-                strcat(_CMB[i].InputAlias, _CMB[j].InputAlias);
-                strcat(_CMB[i].InputFileVarName, "+" );
-                strcat(_CMB[i].InputFileVarName, _CMB[j].InputFileVarName );
-                strcat(_CMB[i].InputNewValue, "+" );
-                strcat(_CMB[i].InputNewValue, _CMB[j].InputNewValue);
-                _CMB[j].flag = 1;
-            }
+            strcat(_CMB[i].InputAlias, "+" );
+            strcat(_CMB[i].InputAlias, _CMB[j].InputAlias);
+            strcat(_CMB[i].InputFileVarName, "+" );
+            strcat(_CMB[i].InputFileVarName, _CMB[j].InputFileVarName );
+            strcat(_CMB[i].InputNewValue, "+" );
+            strcat(_CMB[i].InputNewValue, _CMB[j].InputNewValue);
+            _ct->flag[j] = 1;
+            _CMB[j].flag = 1;
         }
+    }
 
-        //put the predicted output results into  PreValueSMT
+    //put the predicted output results into  PreValueSMT
+    for( i=0; i<_ct->n && rt == 0; i++ )
+    {
+        if( tmp_first[_ct->vartype[i]] != i )
+            continue;
         for( tmp_k=0; tmp_k<MAXOUTPUTSNUM; tmp_k++ )
         {
-             //sprintf( _CMB[i].comment[tmp_k], "%lf", _CMB[i].OutputBaseValue[tmp_k]+tmp_gap[tmp_k] );
-             _CMB[i].PreValueSMT[tmp_k] = _CMB[i].OutputBaseValue[tmp_k]+tmp_gap[tmp_k];
+             _CMB[i].PreValueSMT[tmp_k] = _CMB[i].OutputBaseValue[tmp_k]+tmp_gap[i*MAXOUTPUTSNUM+tmp_k];
              printf( "_CMB[%d].OutputNewValue[%d]=[%lf], _CMB[%d].PrevalueSMT[%d]=[%lf]\n", i, tmp_k, _CMB[i].OutputNewValue[tmp_k], i, tmp_k, _CMB[i].PreValueSMT[tmp_k] );
         }
 
+        _ct->flag[i] = 2;
         _CMB[i].flag = 2;  //for InputVarType[2]='C', namely combined records, only records with flag=2 are output to CMB.csv
     }
 
-    return 0;
+    free( tmp_first );
+    free( tmp_gap );
+    return rt;
 }
 
 //print the record array of RSMResults  to file _RSMRlt_fn.
 int PrintRSMRlt( struct RSMResults *_RSMRlt, char * _RSMRlt_fn)
 {
     int i=0;
-    FILE *fp=fopen(_RSMRlt_fn, "w+");
+    FILE *fp=FPMSnapCreate( _RSMRlt_fn, 1 ); // published as a snapshot, FirePM never reads the results being written
     if( fp==NULL )
     {
         printf( "fopen() error! _RSMRlt_fn=[%s]\n", _RSMRlt_fn );
@@ -1616,8 +2736,7 @@ int PrintRSMRlt( struct RSMResults *_RSMRlt, char * _RSMRlt_fn)
         i++;
     }while (strlen(trim(_RSMRlt[i].OutputAlias,NULL)) !=0 );
 
-    fclose(fp);
-    return 0;
+    return FPMSnapPublish( _RSMRlt_fn, fp, 1 );
 }
 
 //print the record array of RSM(response surface method)  to file _RSM_fn. Note that _RSM has the same struct type as CMB and DoA
@@ -1715,7 +2834,7 @@ int CmpRSMnSMT( struct DoAlxInfo *_CMB, struct RSMResults *_RSMRlt )
  * Function: generate records for Response surface method (RSM,VarType="IR*" ) and combined fire scenairos (VarType = "**C" ).
  *     Flow chat: 
  *     1. reset the flag to zero for the following uses in this function
- *     2. for each  line in _DoA, check if its VarType to make sure we will process it.
+ *     2. for each  line in _dt, check if its VarType to make sure we will process it.
  *     3. check if its flag == 1, Yes means this record has already been averaged by another record with the same input information, otherwise set it to 1
  *     4. combine and average the records with same input information
  *     5. update the calculated tmp-DoA to _RSM or _CMB
@@ -1723,7 +2842,7 @@ int CmpRSMnSMT( struct DoAlxInfo *_CMB, struct RSMResults *_RSMRlt )
  *     7. calculate  the parameters of power fitting functionsa (CalRSMRlt())
  *     8. calculate  the output values predicted by RSM and put it into CMB to compare with the FDS simulation results and the SMM predicted values
  *     9. print RSM, RSMRlt, and CMB
- * _DoA: input parameter indicating a calculated output array based on input informaiton
+ * _dt: input parameter indicating the DoA table of a calculated output array based on input informaiton
  * _si: input parameter indicating the input information structure array
  * _RSM: output parameter indicating the input information structure array
  * _RSMRlt: output parameter holding the parameters of power fitting functions
@@ -1731,73 +2850,39 @@ int CmpRSMnSMT( struct DoAlxInfo *_CMB, struct RSMResults *_RSMRlt )
  * Return: 0: success
  *         -1: Failure
  *************************************************************************************************************************************************/
-int GenRSMnCMB( struct DoAlxInfo *_DoA, struct SMInfo *_si, struct DoAlxInfo *_RSM, struct RSMResults *_RSMRlt, struct DoAlxInfo *_CMB )
+int GenRSMnCMB( struct DoATable *_dt, struct SMInfo *_si, struct DoAlxInfo *_RSM, struct RSMResults *_RSMRlt, struct DoAlxInfo *_CMB )
 {
+    int g=0,tmp_k=0,rt=0; 
+    struct DoATable tmp_rt, tmp_ct;
+    struct DoAGroups tmp_gr;
     
-    int i=0,j=0; 
-    
-    for( i=0; i<MAXLINENUM; i++ )
+    // the records with flag = 1 are used here. the users should check the DoA.csv if there are some records with flag = 1 which means the FDs simulation time maybe too short for the critical value to be met
+    // there are repeated FDS simulations, namely _DoA include repeated records, we nned to average these repeated records
+    if( DoAGroupRows(_dt, DOAKIND_IR|DOAKIND_C, 0, RPNUMSNR > 0 || RPNUMCMB > 0, &tmp_gr) != 0 )
     {
-        //reset the flag. the users should check the DoA.csv if there are some records with flag = 1 which means the FDs simulation time maybe too short for the critical value to be met
-        _DoA[i].flag = 0 ; 
+        printf( "DoAGroupRows() error!\n" );
+        return -1;
     }
 
-    for( i=0; i<MAXLINENUM; i++ )
+    for( g=0; g<tmp_gr.n && rt == 0; g++ )
     {
-        double tmp_final_d[MAXOUTPUTSNUM];
         struct DoAlxInfo tmp_DoA;
-        int tmp_k=0;
-
-        memset( tmp_final_d, 0x0, sizeof(tmp_final_d) );
-        memset( &tmp_DoA, 0x0, sizeof(tmp_DoA) );
-
-        memcpy( &tmp_DoA, &(_DoA[i]), sizeof(tmp_DoA));
-
-        if( strstr(_DoA[i].InputVarType, "IR" ) == NULL && _DoA[i].InputVarType[2] != 'C' )
-            continue;
-
-        if( strstr(_DoA[i].InputVarType, "IR" ) != NULL )
-            printf( "begin UpdateRSM(), i=%d, tmp_DoA.flag=%d, tmp_DoA.InputVarType=%s,tmp_DoA.InputAlias=%s, tmp_DoA.InputNewValue=%s, tmp_DoA.OutputNewValue=%lf\n", i, tmp_DoA.flag,tmp_DoA.InputVarType, tmp_DoA.InputAlias, tmp_DoA.InputNewValue, tmp_DoA.OutputNewValue[0] );
-
-        // flag = 1 : the record has been processed; flag = 0: not yet
-        if( _DoA[i].flag == 1 ) 
-            continue;
-        else 
-            _DoA[i].flag = 1 ;
+        int i = tmp_gr.row[g];
 
+        memcpy( &tmp_DoA, &(_dt->rec[i]), sizeof(tmp_DoA));
+        tmp_DoA.flag = 0;
         for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-            tmp_DoA.OutputNewValue[tmp_k] = _DoA[i].OutputNewValue[tmp_k]; 
-
-        // there are repeated FDS simulations, namely _DoA include repeated records, we nned to average these repeated records
-        if( RPNUMSNR > 0 || RPNUMCMB > 0 )
-        {
-            int count=0;
-            for( j=i+1;j<MAXLINENUM;j++)
-            {
-               if( _DoA[j].flag == 1 || strstr(_DoA[j].InputVarType, "IR") == NULL && _DoA[j].InputVarType[2] != 'C' )
-                   continue;
-               if( IsRPDoA(_DoA[i], _DoA[j] ) == 0 )
-               {
-                   for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-                       tmp_DoA.OutputNewValue[tmp_k] += _DoA[j].OutputNewValue[tmp_k]; 
-                   _DoA[j].flag = 1;
-                   count++;
-                   printf( "count=[%d],i=[%d],j=[%d],tmp_DoA.OutputNewValue[0]=[%lf]\n", count, i,j, tmp_DoA.OutputNewValue[0] );
-               }
-            }
-            for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-                tmp_DoA.OutputNewValue[tmp_k] /= count+1;
-            printf( "count=[%d],tmp_DoA.OutputNewValue[0]=[%lf]\n", count, tmp_DoA.OutputNewValue[0] );
-        }
+            tmp_DoA.OutputNewValue[tmp_k] = tmp_gr.sum[g*MAXOUTPUTSNUM+tmp_k]/tmp_gr.count[g];
+        printf( "i=[%d],count=[%d],tmp_DoA.OutputNewValue[0]=[%lf],sd=[%lf]\n", i, tmp_gr.count[g], tmp_DoA.OutputNewValue[0], sqrt(DoAGroupVar(&tmp_gr, g, 0)) );
 
-        if( strstr(tmp_DoA.InputVarType, "IR") != NULL )
+        if( _dt->kind[i] & DOAKIND_IR )
         {
            
             printf( "before UpdateRSM(), tmp_DoA.InputVarType=%s,tmp_DoA.InputAlias=%s, tmp_DoA.InputNewValue=%s, tmp_DoA.OutputNewValue=%lf\n", tmp_DoA.InputVarType, tmp_DoA.InputAlias, tmp_DoA.InputNewValue, tmp_DoA.OutputNewValue[0] );
             if ( UpdateRSM(tmp_DoA, _RSM) != 0 )
             {
                 printf( "UpdateRSM() error !\n" );
-                return -1;
+                rt = -1;
             }
         }
         else 
@@ -1805,23 +2890,38 @@ int GenRSMnCMB( struct DoAlxInfo *_DoA, struct SMInfo *_si, struct DoAlxInfo *_R
             if( UpdateCMB(tmp_DoA, _CMB) != 0 )
             {
                 printf( "UpdateCMB() error !\n" );
-                return -1;
+                rt = -1;
             }
         }
 
     }
+    DoAGroupsFree( &tmp_gr );
+    if( rt != 0 )
+        return -1;
 
-    if( CalCMB(_CMB, SenMatx ) != 0 ) 
+    // the RSM and CMB stages scan the typed tables of the averaged records
+    if( DoATableBuild(_RSM, &tmp_rt) != 0 )
+        return -1;
+    if( DoATableBuild(_CMB, &tmp_ct) != 0 )
     {
-        printf( "CalCMB() error!\n" );
+        DoATableFree( &tmp_rt );
         return -1;
     }
 
-    if( CalRSMRlt(_RSM, _CMB, _si, _RSMRlt) != 0 )
+    if( CalCMB(_CMB, &tmp_ct, &SenMatxNum ) != 0 ) 
+    {
+        printf( "CalCMB() error!\n" );
+        rt = -1;
+    }
+    else if( CalRSMRlt(&tmp_rt, _CMB, _si, _RSMRlt) != 0 )
     {
         printf( "CalRSMRlt() error!\n");
-        return -1;
+        rt = -1;
     }
+    DoATableFree( &tmp_rt );
+    DoATableFree( &tmp_ct );
+    if( rt != 0 )
+        return -1;
 
     if( CmpRSMnSMT(_CMB, _RSMRlt ) != 0 )
     {
@@ -1852,84 +2952,485 @@ int GenRSMnCMB( struct DoAlxInfo *_DoA, struct SMInfo *_si, struct DoAlxInfo *_R
 }
 
 /************************************************************************************************************************************************* 
- * Function: generate sensitivity matix based on the simulation result array _DoA
- * _DoA: input parameter indicating a calculated output array based on input informaiton
+ * Function: generate sensitivity matix based on the simulation result table _dt
+ * _dt: input parameter indicating the DoA table of a calculated output array based on input informaiton
  * _SMT: input parameter holding the detail information about the sensitivity matrix
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int GenSMT( struct DoAlxInfo *_DoA, struct SenMat *_SMT )
+int GenSMT( struct DoATable *_dt, struct SenMat *_SMT )
 {
-    int i=0,j=0; 
-    
-    for( i=0; i<MAXLINENUM; i++ )
+    int g=0,tmp_k=0,rt=0,tmp_n=0; 
+    struct SMTIndex tmp_idx[MAXINPUTSNUM];
+    struct DoAKeys tmp_ks;
+    struct DoAGroups tmp_gr;
+
+    memset( tmp_idx, 0x0, sizeof(tmp_idx) );
+    memset( &tmp_ks, 0x0, sizeof(tmp_ks) );
+    tmp_ks.width = 4;
+
+    // the records with flag = 1 are left out because the FDS simulation is too short for the critical value to be met. if there are repeated FDS
+    // simulations, we need to average the output values because the output maybe different when an identical FDS file is run two times due to
+    // the random properties of FDS simulation
+    if( DoAGroupRows(_dt, DOAKIND_IS, 1, RPNUMSNR > 0, &tmp_gr) != 0 )
     {
-        double tmp_final_d[MAXOUTPUTSNUM];
-        struct DoAlxInfo tmp_DoA;
-        int tmp_k=0;
+        printf( "DoAGroupRows() error!\n" );
+        return -1;
+    }
 
-        memset( tmp_final_d, 0x0, sizeof(tmp_final_d) );
-        memset( &tmp_DoA, 0x0, sizeof(tmp_DoA) );
+    for( g=0; g<tmp_gr.n; g++ )
+    {
+        double tmp_out[MAXOUTPUTSNUM];
+        int i = tmp_gr.row[g];
 
-        memcpy( &tmp_DoA, &(_DoA[i]), sizeof(tmp_DoA));
+        for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
+            tmp_out[tmp_k] = tmp_gr.sum[g*MAXOUTPUTSNUM+tmp_k]/tmp_gr.count[g]; 
+        printf( "RPNUMSNR: _DoA[%d].InputVarType=%s,count=[%d],sd=[%lf]\n", i,_dt->rec[i].InputVarType, tmp_gr.count[g], sqrt(DoAGroupVar(&tmp_gr, g, 0)) );
 
-        if( strstr(_DoA[i].InputVarType, "IS" ) == NULL )
-            continue;
-        // flag = 1 : either the FDS simulation is too short for the critical value to be met or the record has been transfered into sensitivity matrix; flag = 0: not yet
-        if( _DoA[i].flag == 1 ) 
-            continue;
-        else 
+        if ( UpdateSMT(_dt, i, tmp_out, _SMT, tmp_idx, &tmp_ks, &tmp_n) != 0 )
         {
-            printf( "RPNUMSNR: _DoA[%d].InputVarType=%s,_DoA[%d].flag=%d\n", j,_DoA[j].InputVarType,j, _DoA[j].flag );
-            _DoA[i].flag = 1 ;
+           printf( "updateSMT() error!\n" );
+           rt = -1;
+           break;
         }
+    }
+    DoAKeysFree( &tmp_ks );
+    DoAGroupsFree( &tmp_gr );
+    if( rt != 0 )
+        return -1;
 
-        for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-            tmp_DoA.OutputNewValue[tmp_k] = _DoA[i].OutputNewValue[tmp_k]; 
+    CalSMT(_SMT, tmp_idx); // calculate the sensitivity matix details
+    GetSenMatx(_SMT, &SenMatxNum, "SMT.csv"); // save the sensitivity matrix to SenMatxNum and the file of "SMT.csv"
+    PrintSMT( _SMT, "SMT_detail.csv"); // save the sensitivity matrix details to  the file of "SMT_detail.csv"
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: build the DoA table of _DoA once and generate the sensitivity matrix, the RSM and the CMB results from it
+ * _DoA: input parameter indicating a calculated output array based on input informaiton
+ * _si: input parameter indicating the input information structure array
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int GenAnalysis( struct DoAlxInfo *_DoA, struct SMInfo *_si )
+{
+    int rt = 0;
+    struct DoATable tmp_dt;
+
+    if( DoATableBuild(_DoA, &tmp_dt) != 0 )
+    {
+        printf( "DoATableBuild() error!\n" );
+        return -1;
+    }
+    if( GenSMT( &tmp_dt, FDS_SenMat ) != 0)
+    {
+        printf( "GenSMT() error!\n" );
+        rt = -1;
+    }
+    else if( GenRSMnCMB( &tmp_dt, _si, FDS_RSM, FDS_RSMResults, FDS_CMB )!= 0 )
+    {
+        printf( "GenRSMnCMB() error !\n" );
+        rt = -1;
+    }
+    DoATableFree( &tmp_dt );
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * the follow mode of DoA (-f seconds): the csv files in the new directories are tailed (DoAFollowFeed()) while the FDS runs are writing them.
+ * inotify wakes the loop up as soon as a file is created or grows, the files are also checked every second so that a file system without
+ * inotify support (e.g. NFS) still works. whenever a critical value is met, the provisional DoA list is rebuilt from the crossing states and
+ * DoA.csv, SMT.csv, RSM.csv etc. are generated again (DoAFollowReport()). the loop ends when no file grows for the given seconds (0: never)
+ * or on SIGINT/SIGTERM
+ *************************************************************************************************************************************************/
+int DoAFollowIdle = -1; // the seconds set by the option -f, -1 means the follow mode is off
+volatile sig_atomic_t DoAFollowStop = 0;
+double DoAStopMargin = -1; // the simulation seconds set by the option -s, -1 means no CHID.stop file is written
+
+/*************************************************************************************************************************************************
+ * Function: write the CHID.stop file of a followed csv file so that FDS ends the run cleanly. FDS checks the file CHID.stop in its working
+ *           directory, namely the directory of CHID_devc.csv
+ * _fw: input/output parameter indicating the followed csv file
+ * _time: input parameter indicating the Time of the data line which triggers the stop
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAWriteStop( struct DoAFollow *_fw, double _time )
+{
+    char tmp_fn[MAXSTRINGSIZE];
+    char *tmp_p = NULL;
+    FILE *fp = NULL;
+
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    sprintf( tmp_fn, "%s", _fw->tail.csv );
+    tmp_p = strrchr( tmp_fn, '_' ); // CHID_devc.csv or CHID_evac.csv
+    if( tmp_p == NULL || strrchr(tmp_fn, '/') > tmp_p )
+    {
+        printf( "DoAWriteStop() error: no CHID in [%s]\n", _fw->tail.csv );
+        return -1;
+    }
+    sprintf( tmp_p, ".stop" );
+
+    fp = fopen( tmp_fn, "w" );
+    if( fp == NULL )
+    {
+        printf( "DoAWriteStop() error: fopen [%s] failed!\n", tmp_fn );
+        return -1;
+    }
+    fprintf( fp, "all the critical values are met, stopped by DoA at Time=[%lf]\n", _time );
+    fclose( fp );
+    _fw->stopped = 1;
+    printf( "[%s] is written: all the critical values of [%s] are met, Time=[%lf], margin=[%lf]\n", tmp_fn, _fw->tail.csv, _time, DoAStopMargin );
+    return 0;
+}
+
+// the handler of SIGINT and SIGTERM in the follow mode
+void DoAFollowSignal( int _sig )
+{
+    (void)_sig;
+    DoAFollowStop = 1;
+}
+
+/*************************************************************************************************************************************************
+ * Function: add the csv files in the new directories which are not followed yet to the follow list. the compressed files and the sidecars are
+ *           the results of finished runs, they are not followed
+ * _DirList: input parameter indicating the directories including the *devc.csv or *evac.csv files
+ * _fw: input/output parameter indicating the follow list
+ * _num: input/output parameter indicating the number of the files in the follow list
+ * _cap: input/output parameter indicating the allocated length of the follow list
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAFollowScan( char _DirList[MAXNEWDIRNUM][100], struct DoAFollow **_fw, int *_num, int *_cap )
+{
+    int i=0, j=0;
+
+    for( i=0; i<MAXNEWDIRNUM; i++ )
+    {
+        DIR *tmp_dir = NULL;
+        struct dirent *en = NULL;
 
-        if( RPNUMSNR > 0 ) // there are repeated FDS simulations, we need to average the output values because the output maybe different when an identical FDS file is run two times due to the random properties of FDS simulation
+        if( strlen(_DirList[i]) == 0 )
+            break;
+        tmp_dir = opendir( _DirList[i] );
+        if( tmp_dir == NULL )
+        {
+            printf( "opendir error: %s\n", _DirList[i] );
+            continue; // may be created later by Mfds.sh
+        }
+        while( (en = readdir(tmp_dir)) != NULL )
         {
-            int count=0;
-            for( j=i+1;j<MAXLINENUM;j++)
+            char tmp_fn[MAXSTRINGSIZE];
+
+            memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+            sprintf( tmp_fn, "%s/%s", _DirList[i], en->d_name );
+            if( FileFilter(tmp_fn) != 0 || DevcDecompressor(tmp_fn) != NULL || strstr(tmp_fn, DEVCCACHESUFFIX) != NULL )
+                continue;
+            for( j=0; j<*_num; j++ )
             {
-               if( _DoA[j].flag == 1 || strstr(_DoA[j].InputVarType, "IS") == NULL )
-                   continue;
-               if( IsRPDoA(_DoA[i], _DoA[j] ) == 0 )
-               {
-                   for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-                       tmp_DoA.OutputNewValue[tmp_k] += _DoA[j].OutputNewValue[tmp_k]; 
-                   _DoA[j].flag = 1;
-                   printf( "RPNUMSNR: _DoA[%d].InputVarType=%s,_DoA[%d].flag=%d\n", j,_DoA[j].InputVarType,j, _DoA[j].flag );
-                   count++;
-               }
+                if( strcmp((*_fw)[j].tail.csv, tmp_fn) == 0 )
+                    break;
+            }
+            if( j < *_num ) // already followed
+                continue;
+
+            if( *_num == *_cap )
+            {
+                int tmp_cap = (*_cap > 0) ? (*_cap)*2 : 64;
+                struct DoAFollow *tmp_fw = realloc( *_fw, sizeof(struct DoAFollow) * tmp_cap );
+                if( tmp_fw == NULL )
+                {
+                    printf( "DoAFollowScan() error: realloc() [%d] files failed!\n", tmp_cap );
+                    closedir( tmp_dir );
+                    return -1;
+                }
+                *_fw = tmp_fw;
+                *_cap = tmp_cap;
             }
-            for(tmp_k=0;tmp_k<MAXOUTPUTSNUM; tmp_k++ )
-                tmp_DoA.OutputNewValue[tmp_k] /= count+1;
+            memset( &((*_fw)[*_num]), 0x0, sizeof(struct DoAFollow) );
+            if( DevcTailOpen(tmp_fn, &((*_fw)[*_num].tail)) != 0 )
+            {
+                closedir( tmp_dir );
+                return -1;
+            }
+            (*_num)++;
+        }
+        closedir( tmp_dir );
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: feed the new complete lines of a followed csv file to its OutCross structures. the second line (the head line) decides if the file
+ *           is what we need (CheckHead()) and sets up the OutCross structures (InitOutputCross()). the provisional value of the target variable
+ *           is printed as soon as a critical value is met
+ * _fw: input/output parameter indicating the followed csv file
+ * _si: input parameter indicating the content in the configuration file
+ * Return: the number of the changes to report, namely the critical values met in the new lines, plus 1 if the file is restarted
+ *************************************************************************************************************************************************/
+int DoAFollowFeed( struct DoAFollow *_fw, struct SMInfo *_si )
+{
+    struct Span tmp_line;
+    int tmp_columns[2*MAXOUTPUTSNUM+1];
+    double tmp_values[2*MAXOUTPUTSNUM+1];
+    int j=0, rt=0, tmp_changed=0;
+
+    // with -s the lines after the last crossing are still needed to know when the margin is over
+    while( _fw->state == 0 || (_fw->state == 1 && (_fw->left > 0 || (DoAStopMargin >= 0 && _fw->stopped == 0))) )
+    {
+        rt = DevcTailNextLine( &(_fw->tail), &tmp_line );
+        if( rt == 1 ) // wait for the next lines
+        {
+            _fw->live = 1;
+            break;
+        }
+        if( rt == -1 )
+        {
+            _fw->state = -1;
+            break;
+        }
+        if( rt == 2 ) // the run is restarted, the former crossings are void
+        {
+            printf( "[%s] is truncated or replaced, follow it from the beginning\n", _fw->tail.csv );
+            tmp_changed += (_fw->state == 1);
+            _fw->state = 0;
+            continue;
         }
 
-        if ( UpdateSMT(tmp_DoA, _SMT) != 0 )
+        if( _fw->state == 0 )
         {
-           printf( "updateSMT() error!\n" );
-           return -1;
+            if( _fw->tail.lines < 2 ) // first line of csv file is not used, the second line is the head line
+                continue;
+            if( CheckHead(tmp_line, _fw->tail.csv, _si) != 0 )
+            {
+                _fw->state = 2;
+                break;
+            }
+            memset( _fw->oc, 0x0, sizeof(_fw->oc) );
+            _fw->n = InitOutputCross( tmp_line, _fw->tail.csv, _si, _fw->oc, _fw->basevalue, tmp_columns );
+            tmp_columns[2*_fw->n] = 0; // the first column of FDS csv files is Time
+            if( _fw->n == -1 || SpanProject(tmp_columns, 2*_fw->n+1, &(_fw->pj)) != 0 )
+            {
+                _fw->state = -1;
+                break;
+            }
+            printf( "tmp_whole_fn=%s (followed)\n", _fw->tail.csv );
+            _fw->left = _fw->n;
+            _fw->stop_at = -1;
+            _fw->stopped = 0;
+            _fw->state = 1;
+            tmp_changed++;
+            continue;
+        }
+
+        if( SpanIsBlank(tmp_line) )
+            continue;
+        if( SpanProjectValues(tmp_line, &(_fw->pj), s[0], tmp_values) != 0 ) // a broken line, the run may be restarted
+            continue;
+        for( j=0; j<_fw->n; j++ )
+        {
+            if( FeedOutCross(&(_fw->oc[j]), tmp_values[2*j], tmp_values[2*j+1]) == 1 )
+            {
+                const struct SMInfo *tmp_si = &(_si[_fw->oc[j].si_index]);
+
+                printf( "provisional: csv=[%s], output [%s] meets [%s] at %s=[%lf], row=[%ld]\n", _fw->tail.csv, tmp_si->Alias,
+                        tmp_si->CriticalValue, tmp_si->TargetName, _fw->oc[j].result, _fw->oc[j].rows );
+                _fw->left--;
+                tmp_changed++;
+            }
+        }
+
+        if( DoAStopMargin >= 0 && _fw->left == 0 )
+        {
+            if( _fw->stop_at < 0 )
+                _fw->stop_at = tmp_values[2*_fw->n] + DoAStopMargin;
+            // a file already finished when it is first read is never stopped, only a run still writing lines is
+            if( _fw->live == 1 && tmp_values[2*_fw->n] >= _fw->stop_at && DoAWriteStop(_fw, tmp_values[2*_fw->n]) != 0 )
+                _fw->stopped = -1; // not stopped, but don't try again
         }
     }
 
-    CalSMT(_SMT); // calculate the sensitivity matix details
-    GetSenMatx(_SMT, SenMatx, "SMT.csv"); // save the sensitivity matrix to SenMatx and the file of "SMT.csv"
-    PrintSMT( _SMT, "SMT_detail.csv"); // save the sensitivity matrix details to  the file of "SMT_detail.csv"
+    if( _fw->state == -1 )
+        printf( "DoAFollowFeed() error: [%s] is not followed any more\n", _fw->tail.csv );
+    if( _fw->state == -1 || _fw->state == 2 || (_fw->state == 1 && _fw->left == 0 && (DoAStopMargin < 0 || _fw->stopped != 0)) ) // nothing more is needed
+        DevcTailClose( &(_fw->tail) );
+    return tmp_changed;
+}
+
+/*************************************************************************************************************************************************
+ * Function: rebuild the DoA list from the crossing states of the followed csv files and generate all the result files again
+ * _fw: input parameter indicating the follow list
+ * _num: input parameter indicating the number of the files in the follow list
+ * _si: input parameter indicating the content in the configuration file
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAFollowReport( struct DoAFollow *_fw, int _num, struct SMInfo *_si )
+{
+    int i=0, tmp_p=0;
+
+    memset( FDS_DoA, '\0', sizeof(FDS_DoA));
+    memset( FDS_SenMat, '\0', sizeof(FDS_SenMat));
+    memset( FDS_RSM, '\0', sizeof(FDS_RSM));
+    memset( FDS_CMB, '\0', sizeof(FDS_CMB));
+    memset( FDS_RSMResults, '\0', sizeof(FDS_RSMResults));
+    SenMatrixClear( &SenMatxNum );
+
+    for( i=0; i<_num; i++ )
+    {
+        if( _fw[i].state != 1 )
+            continue;
+        if( FillOneCSV(_fw[i].tail.csv, _si, FDS_DoA, &tmp_p, MAXLINENUM, &(_fw[i])) != 0 )
+            return -1;
+    }
+    printf( "provisional DoA: [%d] records\n", tmp_p );
+
+    if( PrintAllDoA(FDS_DoA, "DoA.csv") != 0 )
+    {
+        printf( "PrintAllDoA() error!\n" );
+        return -1;
+    }
+    if( GenAnalysis( FDS_DoA, _si ) != 0 )
+    {
+        printf( "GenAnalysis() error!\n" );
+        return -1;
+    }
     return 0;
 }
 
+/*************************************************************************************************************************************************
+ * Function: the main loop of the follow mode
+ * _si: input parameter indicating the content in the configuration file
+ * _idle: input parameter indicating the seconds without any new data after which the loop ends, 0 means never
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DoAFollowRun( struct SMInfo *_si, int _idle )
+{
+    char DirList[MAXNEWDIRNUM][100];
+    struct DoAFollow *tmp_fw = NULL;
+    int tmp_num=0, tmp_cap=0, tmp_ifd=-1, tmp_rescan=1, tmp_report=1, i=0, rt=0;
+    time_t tmp_last = time(NULL);
+
+    memset( DirList, 0x0, sizeof(DirList) );
+    if( GetDirList(_si, DirList) != 0 )
+    {
+        printf( "GetDirList error!\n" );
+        return -1;
+    }
+
+    signal( SIGINT, DoAFollowSignal );
+    signal( SIGTERM, DoAFollowSignal );
+    tmp_ifd = inotify_init1( IN_NONBLOCK );
+    if( tmp_ifd < 0 )
+        printf( "inotify_init1() failed, the files are checked every second\n" );
+    for( i=0; i<MAXNEWDIRNUM && tmp_ifd >= 0; i++ )
+    {
+        if( strlen(DirList[i]) == 0 )
+            break;
+        if( inotify_add_watch(tmp_ifd, DirList[i], IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO) < 0 )
+            printf( "inotify_add_watch() [%s] failed, it is checked every second\n", DirList[i] );
+    }
+
+    while( DoAFollowStop == 0 )
+    {
+        struct pollfd tmp_pfd;
+        off_t tmp_read = 0;
+        int tmp_changed = 0;
+
+        if( tmp_rescan == 1 && DoAFollowScan(DirList, &tmp_fw, &tmp_num, &tmp_cap) != 0 )
+        {
+            rt = -1;
+            break;
+        }
+        tmp_rescan = (tmp_ifd < 0);
+
+        for( i=0; i<tmp_num; i++ )
+        {
+            off_t tmp_offset = tmp_fw[i].tail.offset;
+
+            tmp_changed += DoAFollowFeed( &(tmp_fw[i]), _si );
+            tmp_read += (tmp_fw[i].tail.offset != tmp_offset);
+        }
+        if( tmp_read > 0 )
+            tmp_last = time(NULL);
+        if( tmp_changed > 0 || tmp_report == 1 )
+        {
+            if( DoAFollowReport(tmp_fw, tmp_num, _si) != 0 )
+                printf( "DoAFollowReport() error, keep following\n" );
+            tmp_report = 0;
+        }
+        if( _idle > 0 && time(NULL) - tmp_last >= _idle )
+        {
+            printf( "no new data in [%d] seconds, stop following\n", _idle );
+            break;
+        }
+
+        // sleep until a file is created or changed, or at most one second
+        tmp_pfd.fd = tmp_ifd;
+        tmp_pfd.events = POLLIN;
+        tmp_pfd.revents = 0;
+        if( poll(&tmp_pfd, tmp_ifd >= 0 ? 1 : 0, 1000) > 0 )
+        {
+            char tmp_events[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+            ssize_t tmp_len = 0;
+
+            while( (tmp_len = read(tmp_ifd, tmp_events, sizeof(tmp_events))) > 0 )
+            {
+                char *tmp_p = tmp_events;
+                for( ; tmp_p < tmp_events + tmp_len; tmp_p += sizeof(struct inotify_event) + ((struct inotify_event *)tmp_p)->len )
+                {
+                    if( ((struct inotify_event *)tmp_p)->mask & (IN_CREATE | IN_MOVED_TO) )
+                        tmp_rescan = 1;
+                }
+            }
+        }
+    }
+
+    if( tmp_ifd >= 0 )
+        close( tmp_ifd );
+    for( i=0; i<tmp_num; i++ )
+        DevcTailClose( &(tmp_fw[i].tail) );
+    free( tmp_fw );
+    return rt;
+}
+
 int main( int argc, char ** argv )
 {
     char *tmp_ret=NULL;
+    int tmp_opt=0;
     
-    if ( argc != 2 )
+    // -c: cache the parsed csv files in binary sidecars and reuse them, -a: as -c, and remove the csv files once they are cached
+    // -j N: process the csv files with N threads, -m: reuse the DoA records of the csv files which are not changed since the last run
+    // -f seconds: follow the csv files of the FDS runs in progress until no file grows for the given seconds (0: until interrupted)
+    // -s margin: follow the csv files and write CHID.stop when all the critical values of a run are met and margin more seconds are simulated
+    while( (tmp_opt = getopt(argc, argv, "caj:mf:s:")) != -1 )
+    {
+        if( tmp_opt == 'c' && DevcCacheMode == 0 )
+            DevcCacheMode = 1;
+        else if( tmp_opt == 'a' )
+            DevcCacheMode = 2;
+        else if( tmp_opt == 'j' && atoi(optarg) > 0 )
+            DoAThreads = atoi(optarg);
+        else if( tmp_opt == 'm' )
+            DoAManifestMode = 1;
+        else if( tmp_opt == 'f' && atoi(optarg) >= 0 )
+            DoAFollowIdle = atoi(optarg);
+        else if( tmp_opt == 's' && atof(optarg) >= 0 )
+            DoAStopMargin = atof(optarg);
+        else if( tmp_opt != 'c' )
+        {
+            printf( "usage: %s [-c] [-a] [-j threads] [-m] [-f seconds] [-s margin] SM_Info.txt\n", argv[0] );
+            return -1;
+        }
+    }
+    if ( argc - optind != 1 )
     {
         int i=0;
         for ( i=0; i<argc; i++ )
            printf( "%s\n", argv[i] );
         printf( "only one argument is needed, you have [%d] arguments\n" , argc);
+        printf( "usage: %s [-c] [-a] [-j threads] [-m] [-f seconds] [-s margin] SM_Info.txt\n", argv[0] );
         return -1;
     }
     memset( FDS_SmInfo, '\0', sizeof(FDS_SmInfo));
@@ -1937,25 +3438,34 @@ int main( int argc, char ** argv )
     memset( FDS_SenMat, '\0', sizeof(FDS_SenMat));
     memset( FDS_RSM, '\0', sizeof(FDS_RSM));
     memset( FDS_CMB, '\0', sizeof(FDS_CMB));
-    memset( SenMatx, '\0', sizeof(SenMatx));
+    SenMatrixClear( &SenMatxNum );
 
-    if ( readin(argv[1], FDS_SmInfo) != 0 ){ 
+    if ( readin(argv[optind], FDS_SmInfo) != 0 ){ 
         printf( "read SMInfo to structure error!\n" );
         return -1;
     }
-    if( GenDoA( FDS_SmInfo, FDS_DoA ) != 0 )
+    if( GenBaseOutputs(basefile, FDS_SmInfo) != 0 ) // the output base values are searched only once and shared by all the csv files
     {
-        printf( "GenDoA() error!\n" );
+        printf( "GenBaseOutputs() error!\n" );
         return -1;
     }
-    if( GenSMT( FDS_DoA, FDS_SenMat ) != 0)
+    if( DoAStopMargin >= 0 && DoAFollowIdle < 0 ) // -s works in the follow mode
+        DoAFollowIdle = 0;
+    if( DoAFollowIdle >= 0 ) // the follow mode generates all the result files by itself
+        return DoAFollowRun( FDS_SmInfo, DoAFollowIdle );
+    if( DoAManifestMode == 1 && DoAManifestLoad(argv[optind]) != 0 )
     {
-        printf( "GenSMT() error!\n" );
+        printf( "DoAManifestLoad() error!\n" );
         return -1;
     }
-    if( GenRSMnCMB( FDS_DoA, FDS_SmInfo, FDS_RSM, FDS_RSMResults, FDS_CMB )!= 0 )
+    if( GenDoA( FDS_SmInfo, FDS_DoA ) != 0 )
     {
-        printf( "GenRSMnCMB() error !\n" );
+        printf( "GenDoA() error!\n" );
+        return -1;
+    }
+    if( GenAnalysis( FDS_DoA, FDS_SmInfo ) != 0 )
+    {
+        printf( "GenAnalysis() error!\n" );
         return -1;
     }
 
@@ -7,6 +7,28 @@
  ***************************************************************************************************************************************************/
 #include "FirePM.h"
 #include <tgmath.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * the AVX2 kernels (SpanSepIndex(), SpanSkipFields(), FirstCrossing(), CalMidVals(), SenMatrixGemm()): FPMAVX2 is 1 if they are built in by -mavx2 (or
+ * -march=native on an AVX2 cpu), 2 if they are compiled for AVX2 by the target attribute and used only when the cpu supports AVX2
+ * (gcc 4.9 or later, clang), 0 if only the SSE2 kernels are available (e.g. gcc 4.8 without -mavx2)
+ */
+#if defined(__AVX2__)
+#define FPMAVX2 1
+#define FPMAVX2TARGET
+#define FPMHasAVX2() 1
+#elif defined(__x86_64__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define FPMAVX2 2
+#define FPMAVX2TARGET __attribute__((target("avx2")))
+#define FPMHasAVX2() __builtin_cpu_supports("avx2")
+#else
+#define FPMAVX2 0
+#endif
 
 const char s[2]=",";
 // trim the left side
@@ -77,6 +99,378 @@ int rand_int(int a, int b)
    return (int)((b - a + 1)*rand_double()) + a;
 }
 
+/*************************************************************************************************************************************************
+ * the symbol table of the configuration file: readin() assigns a dense integer ID to every input alias, output alias, VarType and FDS variable
+ * (FDS_VarName) in SM_Info.txt. the input aliases are numbered in the same order as GetVIC() lists them and the output aliases in the same order
+ * as GetVOC() lists them, so the IDs can index the sensitivity and RSM coefficient matrices directly. the strings are trimmed before they are
+ * interned, and two strings have the same ID if and only if they are the same
+ *************************************************************************************************************************************************/
+struct SymTable
+{
+    int num;       // the number of the interned strings
+    char **str;    // the interned strings, the ID of str[i] is i
+    int *bucket;   // the open addressing hash table of the IDs, -1 means empty
+    int nbucket;   // the length of bucket, a power of 2 (0 before the first string is interned)
+};
+
+struct FPMSymbols
+{
+    struct SymTable in;              // the input aliases, 0 .. MAXINPUTSNUM-1
+    struct SymTable out;             // the output aliases, 0 .. MAXOUTPUTSNUM-1
+    struct SymTable vartype;         // the VarTypes
+    struct SymTable filevar;         // the FDS variables (FDS_VarName)
+    int si_vartype[MAXLINENUM];      // the VarType ID of every record in the configuration file
+    int si_alias[MAXLINENUM];        // the alias ID of every record, in "in" for an input record and in "out" for an output record
+    int si_filevar[MAXLINENUM];      // the FDS variable ID of every record
+};
+
+struct FPMSymbols FPMSyms; // built by readin()
+
+// return the FNV-1a hash of _size bytes in _data
+unsigned long HashFNV1a( const char *_data, size_t _size )
+{
+    unsigned long tmp_hash = 14695981039346656037UL;
+    size_t i=0;
+
+    for( i=0; i<_size; i++ )
+    {
+        tmp_hash ^= (unsigned char)_data[i];
+        tmp_hash *= 1099511628211UL;
+    }
+    return tmp_hash;
+}
+
+/*************************************************************************************************************************************************
+ * Function: find the ID of a string in a symbol table, and add the string if it isn't there
+ * _st: input/output parameter indicating the symbol table
+ * _str: input parameter indicating a string, the leading and trailing blanks are not a part of it
+ * _add: input parameter, 1: add _str if it is not interned yet, 0: no
+ * Return: the ID of _str, -1 if _str is not interned (_add == 0) or on failure
+ *************************************************************************************************************************************************/
+int SymID( struct SymTable *_st, const char *_str, int _add )
+{
+    char tmp_str[MAXSTRINGSIZE];
+    unsigned long tmp_hash = 0;
+    int i=0, tmp_b=0;
+
+    memset( tmp_str, 0x0, sizeof(tmp_str) );
+    snprintf( tmp_str, sizeof(tmp_str), "%s", _str );
+    trim( tmp_str, NULL );
+    tmp_hash = HashFNV1a( tmp_str, strlen(tmp_str) );
+
+    for( tmp_b = (int)(tmp_hash & (_st->nbucket-1)); _st->nbucket > 0 && _st->bucket[tmp_b] != -1; tmp_b = (tmp_b+1) & (_st->nbucket-1) )
+    {
+        if( strcmp(_st->str[_st->bucket[tmp_b]], tmp_str) == 0 )
+            return _st->bucket[tmp_b];
+    }
+    if( _add == 0 )
+        return -1;
+
+    if( 2*(_st->num+1) > _st->nbucket ) // keep the hash table at most half full
+    {
+        int tmp_nbucket = (_st->nbucket > 0) ? _st->nbucket*2 : 64;
+        int *tmp_bucket = malloc( sizeof(int) * tmp_nbucket );
+        char **tmp_strs = realloc( _st->str, sizeof(char *) * (tmp_nbucket/2) );
+
+        if( tmp_strs != NULL )
+            _st->str = tmp_strs;
+        if( tmp_bucket == NULL || tmp_strs == NULL )
+        {
+            printf( "SymID() error: memory allocation for [%d] strings failed!\n", tmp_nbucket/2 );
+            free( tmp_bucket );
+            return -1;
+        }
+        memset( tmp_bucket, 0xff, sizeof(int) * tmp_nbucket );
+        for( i=0; i<_st->num; i++ ) // rehash
+        {
+            int tmp_rb = (int)(HashFNV1a(_st->str[i], strlen(_st->str[i])) & (tmp_nbucket-1));
+            while( tmp_bucket[tmp_rb] != -1 )
+                tmp_rb = (tmp_rb+1) & (tmp_nbucket-1);
+            tmp_bucket[tmp_rb] = i;
+        }
+        free( _st->bucket );
+        _st->bucket = tmp_bucket;
+        _st->nbucket = tmp_nbucket;
+        for( tmp_b = (int)(tmp_hash & (_st->nbucket-1)); _st->bucket[tmp_b] != -1; tmp_b = (tmp_b+1) & (_st->nbucket-1) )
+            ;
+    }
+
+    _st->str[_st->num] = strdup( tmp_str );
+    if( _st->str[_st->num] == NULL )
+    {
+        printf( "SymID() error: strdup() [%s] failed!\n", tmp_str );
+        return -1;
+    }
+    _st->bucket[tmp_b] = _st->num;
+    return _st->num++;
+}
+
+// free the strings and the hash table of a symbol table
+void SymFree( struct SymTable *_st )
+{
+    int i=0;
+
+    for( i=0; i<_st->num; i++ )
+        free( _st->str[i] );
+    free( _st->str );
+    free( _st->bucket );
+    memset( _st, 0x0, sizeof(struct SymTable) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: build FPMSyms from the records of the configuration file
+ * _si: input parameter indicating the content of the configuration file
+ * Return: 0: success
+ *         -1: failure, e.g. there are more than MAXINPUTSNUM input aliases
+ *************************************************************************************************************************************************/
+int FPMSymsBuild( const struct SMInfo *_si )
+{
+    int i=0;
+
+    SymFree( &(FPMSyms.in) );
+    SymFree( &(FPMSyms.out) );
+    SymFree( &(FPMSyms.vartype) );
+    SymFree( &(FPMSyms.filevar) );
+    memset( FPMSyms.si_vartype, 0xff, sizeof(FPMSyms.si_vartype) );
+    memset( FPMSyms.si_alias, 0xff, sizeof(FPMSyms.si_alias) );
+    memset( FPMSyms.si_filevar, 0xff, sizeof(FPMSyms.si_filevar) );
+
+    for( i=0; i<MAXLINENUM; i++ )
+    {
+        if( strlen(_si[i].VarType) == 0 )
+            break;
+        FPMSyms.si_vartype[i] = SymID( &(FPMSyms.vartype), _si[i].VarType, 1 );
+        FPMSyms.si_filevar[i] = SymID( &(FPMSyms.filevar), _si[i].FileVarName, 1 );
+        if( _si[i].VarType[0] == 'I' )
+            FPMSyms.si_alias[i] = SymID( &(FPMSyms.in), _si[i].Alias, 1 );
+        else if( _si[i].VarType[0] == 'O' )
+            FPMSyms.si_alias[i] = SymID( &(FPMSyms.out), _si[i].Alias, 1 );
+        if( FPMSyms.si_vartype[i] < 0 || FPMSyms.si_filevar[i] < 0 )
+            return -1;
+    }
+    if( FPMSyms.in.num > MAXINPUTSNUM || FPMSyms.out.num > MAXOUTPUTSNUM )
+    {
+        printf( "FPMSymsBuild() error: [%d] input aliases and [%d] output aliases, MAXINPUTSNUM=%d, MAXOUTPUTSNUM=%d\n", FPMSyms.in.num,
+                FPMSyms.out.num, MAXINPUTSNUM, MAXOUTPUTSNUM );
+        return -1;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * the numeric sensitivity matrix: sen[i][j] is the sensitivity of the output in column j to the input in row i (dy/dx). the aliases of the rows and
+ * the columns are kept as labels and as alias IDs, row[ia] is the row of the input alias ia and col[oa] is the column of the output alias oa, -1
+ * means the alias is not in the matrix. the text form of the matrix only exists in SMT.csv, which is written by GetSenMatx() and read by readinSMT()
+ *************************************************************************************************************************************************/
+struct SenMatrix
+{
+    int nin;                                 // the number of rows (input aliases)
+    int nout;                                // the number of columns (output aliases)
+    char in_alias[MAXINPUTSNUM][128];        // the label of every row
+    char out_alias[MAXOUTPUTSNUM][128];      // the label of every column
+    int row[MAXINPUTSNUM];                   // the row of every input alias ID
+    int col[MAXOUTPUTSNUM];                  // the column of every output alias ID
+    double sen[MAXINPUTSNUM][MAXOUTPUTSNUM]; // the sensitivities, 0 for a missing value
+};
+
+struct SenMatrix SenMatxNum; // the sensitivity matrix used by the predictions
+
+// empty a sensitivity matrix
+void SenMatrixClear( struct SenMatrix *_sm )
+{
+    memset( _sm, 0x0, sizeof(struct SenMatrix) );
+    memset( _sm->row, 0xff, sizeof(_sm->row) );
+    memset( _sm->col, 0xff, sizeof(_sm->col) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: build the alias index of a sensitivity matrix from the labels of its rows and columns, the first row (column) wins if an alias repeats
+ * _sm: input/output parameter indicating the sensitivity matrix
+ * Return: void
+ *************************************************************************************************************************************************/
+void SenMatrixIndex( struct SenMatrix *_sm )
+{
+    int i=0, j=0;
+
+    memset( _sm->row, 0xff, sizeof(_sm->row) );
+    memset( _sm->col, 0xff, sizeof(_sm->col) );
+    for( i=0; i<_sm->nin; i++ )
+    {
+        int tmp_id = SymID( &(FPMSyms.in), _sm->in_alias[i], 0 );
+        if( tmp_id >= 0 && _sm->row[tmp_id] < 0 )
+            _sm->row[tmp_id] = i;
+    }
+    for( j=0; j<_sm->nout; j++ )
+    {
+        int tmp_id = SymID( &(FPMSyms.out), _sm->out_alias[j], 0 );
+        if( tmp_id >= 0 && _sm->col[tmp_id] < 0 )
+            _sm->col[tmp_id] = j;
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: find the sensitivity of an output alias to an input alias
+ * _sm: input parameter indicating the sensitivity matrix
+ * _ia: input parameter indicating the ID of the input alias
+ * _oa: input parameter indicating the ID of the output alias
+ * _one_sen: output parameter holding the sensitivity
+ * Return: 0: success
+ *         -1: failure, either alias is not in the matrix
+ *************************************************************************************************************************************************/
+int SenMatrixGet( const struct SenMatrix *_sm, int _ia, int _oa, double *_one_sen )
+{
+    if( _ia < 0 || _ia >= MAXINPUTSNUM || _sm->row[_ia] < 0 || _oa < 0 || _oa >= MAXOUTPUTSNUM || _sm->col[_oa] < 0 )
+        return -1;
+    *_one_sen = _sm->sen[_sm->row[_ia]][_sm->col[_oa]];
+    return 0;
+}
+
+#if FPMAVX2
+// the AVX2 part of one row of SenMatrixGemm(): _p[j] += _di*_s[j] 4 outputs at a time, return the number of outputs done
+FPMAVX2TARGET int SenMatrixGemmAVX2( double *_p, const double *_s, double _di, int _nout )
+{
+    __m256d tmp_vd = _mm256_set1_pd( _di );
+    int j=0;
+
+    for( ; j+4<=_nout; j+=4 )
+        _mm256_storeu_pd( _p+j, _mm256_add_pd(_mm256_loadu_pd(_p+j), _mm256_mul_pd(tmp_vd, _mm256_loadu_pd(_s+j))) );
+    return j;
+}
+#endif
+
+/*************************************************************************************************************************************************
+ * Function: predict the outputs of a batch of records with a sensitivity matrix, _p = _base + _d * _s, namely
+ *           _p[k][j] = _base[j] + _d[k][0]*_s[0][j] + _d[k][1]*_s[1][j] + ... which is the sum FirePM has always calculated, in the same order
+ * _d: input parameter indicating the input gaps of the records, _d[k*_nin+i] is the gap of input i of record k
+ * _rows: input parameter indicating the number of records
+ * _nin: input parameter indicating the number of inputs
+ * _s: input parameter indicating the sensitivities, _s[i*_nout+j] is the sensitivity of output j to input i
+ * _nout: input parameter indicating the number of outputs
+ * _base: input parameter indicating the output base values
+ * _p: output parameter holding the predictions, _p[k*_nout+j] is output j of record k
+ * Return: void
+ *************************************************************************************************************************************************/
+void SenMatrixGemm( const double *_d, int _rows, int _nin, const double *_s, int _nout, const double *_base, double *_p )
+{
+    int k=0, i=0, j=0;
+#if FPMAVX2
+    int tmp_avx2 = FPMHasAVX2(); // the cpu is asked once for the batch
+#endif
+
+    for( k=0; k<_rows; k++ )
+    {
+        double *tmp_p = _p + (size_t)k*_nout;
+        const double *tmp_d = _d + (size_t)k*_nin;
+
+        memcpy( tmp_p, _base, sizeof(double)*_nout );
+        for( i=0; i<_nin; i++ )
+        {
+            const double *tmp_s = _s + (size_t)i*_nout;
+            double tmp_di = tmp_d[i];
+
+            j = 0;
+            // the outputs of one record are added up in vectors, the multiplication and the addition are kept apart so that the result is the
+            // same as the scalar one
+#if FPMAVX2
+            if( tmp_avx2 )
+                j = SenMatrixGemmAVX2( tmp_p, tmp_s, tmp_di, _nout );
+#endif
+#if defined(__SSE2__)
+            {
+                __m128d tmp_vd = _mm_set1_pd( tmp_di );
+                for( ; j+2<=_nout; j+=2 )
+                    _mm_storeu_pd( tmp_p+j, _mm_add_pd(_mm_loadu_pd(tmp_p+j), _mm_mul_pd(tmp_vd, _mm_loadu_pd(tmp_s+j))) );
+            }
+#endif
+            for( ; j<_nout; j++ )
+                tmp_p[j] += tmp_di*tmp_s[j];
+        }
+    }
+}
+
+/*************************************************************************************************************************************************
+ * the power curve fitting parameters of a RSMResults list indexed by the alias IDs: a[ia][oa], b[ia][oa] are the parameters between one input and
+ * one output (y=a*x^b), A[oa], B[oa] are the parameters between one output and the combined inputs marked in all_in[oa] (Y=A*X^B). it is built
+ * by RSMCoefBuild() whenever the list changes
+ *************************************************************************************************************************************************/
+struct RSMCoef
+{
+    const struct RSMResults *src;                     // the RSMResults list the coefficients come from
+    unsigned char has[MAXINPUTSNUM][MAXOUTPUTSNUM];   // 1: a[ia][oa] and b[ia][oa] are set
+    double a[MAXINPUTSNUM][MAXOUTPUTSNUM];
+    double b[MAXINPUTSNUM][MAXOUTPUTSNUM];
+    unsigned char has_all[MAXOUTPUTSNUM];             // 1: A[oa] and B[oa] are set
+    unsigned char all_in[MAXOUTPUTSNUM][MAXINPUTSNUM];// 1: the input is one of the combined inputs of A[oa] and B[oa]
+    double A[MAXOUTPUTSNUM];
+    double B[MAXOUTPUTSNUM];
+};
+
+struct RSMCoef RSMCoefs; // the coefficients of FDS_RSMResults
+
+/*************************************************************************************************************************************************
+ * Function: split a series of input aliases separated by "+" into a set of input alias IDs
+ * _IAs: input parameter indicating the input aliases
+ * _in: output parameter, _in[ia] = 1 if the input alias ia is in _IAs
+ * Return: the number of the aliases, -1 if one of them is not an input alias of the configuration file
+ *************************************************************************************************************************************************/
+int SymSetFromStrs( const char *_IAs, unsigned char _in[MAXINPUTSNUM] )
+{
+    char tmp_IAs[MAXSTRINGSIZE];
+    char *tmp_save = NULL, *tk = NULL;
+    int n = 0;
+
+    memset( _in, 0x0, MAXINPUTSNUM );
+    memset( tmp_IAs, 0x0, sizeof(tmp_IAs) );
+    snprintf( tmp_IAs, sizeof(tmp_IAs), "%s", _IAs );
+    for( tk = strtok_r(tmp_IAs, "+", &tmp_save); tk != NULL; tk = strtok_r(NULL, "+", &tmp_save) )
+    {
+        int tmp_id = SymID( &(FPMSyms.in), tk, 0 );
+        if( tmp_id < 0 )
+            return -1;
+        _in[tmp_id] = 1;
+        n++;
+    }
+    return n;
+}
+
+/*************************************************************************************************************************************************
+ * Function: build the coefficient matrices of a RSMResults list, the first record of an alias pair wins just as in the list scan it replaces
+ * _RSMRlt: input parameter indicating the power curve fitting results
+ * _rc: output parameter holding the coefficients
+ * Return: void
+ *************************************************************************************************************************************************/
+void RSMCoefBuild( const struct RSMResults *_RSMRlt, struct RSMCoef *_rc )
+{
+    int i=0;
+
+    memset( _rc, 0x0, sizeof(struct RSMCoef) );
+    _rc->src = _RSMRlt;
+    for( i=0; i<(MAXINPUTSNUM+1)*(MAXOUTPUTSNUM+1); i++ )
+    {
+        int tmp_oa = 0;
+        if( strlen(_RSMRlt[i].OutputAlias) == 0 )
+            break;
+        tmp_oa = SymID( &(FPMSyms.out), _RSMRlt[i].OutputAlias, 0 );
+        if( tmp_oa < 0 )
+            continue;
+        if( strchr(_RSMRlt[i].InputAlias, '+') == NULL ) // one output and one input
+        {
+            int tmp_ia = SymID( &(FPMSyms.in), _RSMRlt[i].InputAlias, 0 );
+            if( tmp_ia < 0 || _rc->has[tmp_ia][tmp_oa] == 1 )
+                continue;
+            _rc->has[tmp_ia][tmp_oa] = 1;
+            _rc->a[tmp_ia][tmp_oa] = _RSMRlt[i].a;
+            _rc->b[tmp_ia][tmp_oa] = _RSMRlt[i].b;
+        } else if( _rc->has_all[tmp_oa] == 0 ) { // one output and the combined inputs
+            if( SymSetFromStrs(_RSMRlt[i].InputAlias, _rc->all_in[tmp_oa]) < 0 )
+                continue;
+            _rc->has_all[tmp_oa] = 1;
+            _rc->A[tmp_oa] = _RSMRlt[i].a;
+            _rc->B[tmp_oa] = _RSMRlt[i].b;
+        }
+    }
+}
+
 /************************************************************************************************************************************************* 
  * Function: linear regression analysis -- curve fitting
  * _x,_y: input parameter indicating a group of experimental data, _x for independent variable values, _y for dependent variable values
@@ -307,42 +701,202 @@ int CmpStrs( char *_str1, char *_str2, char *_sep )
     return 0;
 }
 /************************************************************************************************************************************************* 
- * Function: this function looks up the RSMRlt list to find a record matching _IA and _OA and return the parameters of a and b
+ * Function: this function looks up the RSM coefficients to find the parameters a and b between one input and one output
  * Input parameters:
- *     _IA: InputAlias; _OA: OutputAlias, 
- *     _RSMRlt: a list including the power fitting curve parameters between single output and single input, finally this list  will also include entries between single output and all the inputs
+ *     _ia: the ID of the InputAlias; _oa: the ID of the OutputAlias, 
+ *     _rc: the coefficients of a list including the power fitting curve parameters between single output and single input
  * Output parameters:
  *     _a: parameter A of the power fitting curve (y=Ax^B)
  *     _b: parameter B of the power fitting curve (y=Ax^B)
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int GetParFromRSMRlt(char *_IA, char *_OA, struct RSMResults *_RSMRlt, double *_a, double *_b )
+int GetParFromRSMRlt( int _ia, int _oa, const struct RSMCoef *_rc, double *_a, double *_b )
+{
+    if( _rc == NULL || _a == NULL || _b == NULL )
+    {
+        printf( "GetParFromRSMRlt() error: one of the parameter pointer is NULL, please check!\n" );
+        return -1;
+    }
+
+    if( _ia >= 0 && _ia < MAXINPUTSNUM && _oa >= 0 && _oa < MAXOUTPUTSNUM && _rc->has[_ia][_oa] == 1 )
+    {
+        *_a = _rc->a[_ia][_oa];
+        *_b = _rc->b[_ia][_oa];
+        return 0;
+    }
+
+    printf( "Cannot find a record matching _IA=%s and _OA=%s in _RSMRlt!\n", (_ia >= 0 && _ia < FPMSyms.in.num) ? FPMSyms.in.str[_ia] : "",
+            (_oa >= 0 && _oa < FPMSyms.out.num) ? FPMSyms.out.str[_oa] : "" );
+    return -1;
+}
+
+/************************************************************************************************************************************************* 
+ * Function: this function looks up the RSM coefficients to find the parameters A and B between one output and the combined inputs, the combined
+ *           inputs of the coefficients should be a part of _in
+ * _in: input parameter indicating the set of the input alias IDs (see SymSetFromStrs())
+ * _oa: input parameter indicating the ID of the OutputAlias
+ * _rc: input parameter indicating the RSM coefficients
+ * _A, _B: output parameters holding the parameters of the power fitting curve (Y=AX^B)
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int GetAllParFromRSMRlt( const unsigned char *_in, int _oa, const struct RSMCoef *_rc, double *_A, double *_B )
 {
     int i=0;
 
-    if( _IA == NULL || _OA == NULL || _RSMRlt == NULL || _a == NULL || _b == NULL )
+    if( _oa < 0 || _oa >= MAXOUTPUTSNUM || _rc->has_all[_oa] == 0 )
     {
-        printf( "GetParFromRSMRlt() error: one of the parameter pointer is NULL, please check!\n" );
+        printf( "Cannot find a combined record matching _OA=%s in _RSMRlt!\n", (_oa >= 0 && _oa < FPMSyms.out.num) ? FPMSyms.out.str[_oa] : "" );
         return -1;
     }
+    for( i=0; i<MAXINPUTSNUM; i++ )
+    {
+        if( _rc->all_in[_oa][i] == 1 && _in[i] == 0 )
+        {
+            printf( "the combined record of _OA=%s in _RSMRlt includes the input [%s] which is not given!\n", FPMSyms.out.str[_oa], FPMSyms.in.str[i] );
+            return -1;
+        }
+    }
+    *_A = _rc->A[_oa];
+    *_B = _rc->B[_oa];
+    return 0;
+}
 
-    for( i=0; i<MAXLINENUM; i++ )
+/*************************************************************************************************************************************************
+ * the compiled RSM evaluator: the RSM predicts an output as Y = A*(x0^b0 * x1^b1 * ...)^B, which is evaluated in log space as
+ * Y = exp( log(A) + B*b0*log(x0) + B*b1*log(x1) + ... ), so the coefficients of every output are folded into one vector w[.][j] = B*b[.][j] and
+ * a batch of records is evaluated with one matrix product (see SenMatrixGemm()). the inputs are fixed when the evaluator is compiled, so that no
+ * alias is looked up at the evaluation. a record with an input <= 0 or an output with A <= 0 has no logarithm, it is evaluated by pow() instead
+ *************************************************************************************************************************************************/
+struct RSMEval
+{
+    int nin;                                     // the number of inputs, namely the columns of a record
+    int nout;                                    // the number of outputs
+    double w[MAXINPUTSNUM*MAXOUTPUTSNUM];        // w[i*nout+j] = B[j]*b[i*nout+j]
+    double loga[MAXOUTPUTSNUM];                  // log(A[j]), 0 if A[j] <= 0
+    double A[MAXOUTPUTSNUM];                     // the parameters between every output and the inputs (Y=AX^B)
+    double B[MAXOUTPUTSNUM];
+    double b[MAXINPUTSNUM*MAXOUTPUTSNUM];        // the parameters between every input and every output (y=ax^b)
+};
+
+/*************************************************************************************************************************************************
+ * Function: compile the RSM coefficients of a set of inputs and outputs into an evaluator
+ * _rc: input parameter indicating the RSM coefficients
+ * _in: input parameter indicating the input alias IDs in the order of the columns of a record
+ * _nin: input parameter indicating the number of the inputs
+ * _out: input parameter indicating the output alias IDs
+ * _nout: input parameter indicating the number of the outputs
+ * _ev: output parameter holding the evaluator
+ * Return: 0: success
+ *         -1: failure, the coefficients of an input and an output are not found
+ *************************************************************************************************************************************************/
+int RSMEvalCompile( const struct RSMCoef *_rc, const int *_in, int _nin, const int *_out, int _nout, struct RSMEval *_ev )
+{
+    int i=0, j=0, rt=0;
+    unsigned char tmp_in[MAXINPUTSNUM];
+
+    memset( _ev, 0x0, sizeof(struct RSMEval) );
+    memset( tmp_in, 0x0, sizeof(tmp_in) );
+    _ev->nin = _nin;
+    _ev->nout = _nout;
+    for( i=0; i<_nin; i++ )
     {
-        if( strlen(_RSMRlt[i].OutputAlias) == 0 )
+        if( _in[i] >= 0 && _in[i] < MAXINPUTSNUM )
+            tmp_in[_in[i]] = 1;
+    }
+
+    for( j=0; j<_nout && rt == 0; j++ )
+    {
+        double tmp_a=0.0;
+
+        for( i=0; i<_nin && rt == 0; i++ ) //X=x[0]^b[0]*x[1]^b[1]...
+            rt = GetParFromRSMRlt( _in[i], _out[j], _rc, &tmp_a, &(_ev->b[i*_nout+j]) );
+        if( rt != 0 )
             break;
-        printf( "i=%d, OutputAlias=[%s], _OA = [%s], InputAlias=[%s], _IA=[%s]\n", i, _RSMRlt[i].OutputAlias, _OA, _RSMRlt[i].InputAlias, _IA );
-        if( strcmp(_RSMRlt[i].OutputAlias,_OA) == 0 && (strcmp(_RSMRlt[i].InputAlias,_IA)==0 || CmpStrs(_RSMRlt[i].InputAlias, _IA,"+")==0 ))
+        //the parameters of A and B for the combined input variables, one input has the parameters of its own
+        if( _nin == 1 )
+            rt = GetParFromRSMRlt( _in[0], _out[j], _rc, &(_ev->A[j]), &(_ev->B[j]) );
+        else
+            rt = GetAllParFromRSMRlt( tmp_in, _out[j], _rc, &(_ev->A[j]), &(_ev->B[j]) );
+        if( rt != 0 )
+            break;
+        for( i=0; i<_nin; i++ )
+            _ev->w[i*_nout+j] = _ev->B[j]*_ev->b[i*_nout+j];
+        _ev->loga[j] = _ev->A[j] > 0.0 ? log(_ev->A[j]) : 0.0;
+    }
+    return rt;
+}
+
+// evaluate output _j of one record by pow(), Y = A*(x0^b0 * x1^b1 * ...)^B
+double RSMEvalPow( const struct RSMEval *_ev, const double *_x, int _j )
+{
+    int i=0;
+    double tmp_X=1.0;
+
+    for( i=0; i<_ev->nin; i++ )
+        tmp_X *= pow( _x[i], _ev->b[i*_ev->nout+_j] );
+    return _ev->A[_j]*pow( tmp_X, _ev->B[_j] );
+}
+
+/*************************************************************************************************************************************************
+ * Function: evaluate the RSM predictions of a batch of records
+ * _ev: input parameter indicating the evaluator
+ * _x: input parameter indicating the input values of the records, _x[k*nin+i] is input i of record k
+ * _rows: input parameter indicating the number of records
+ * _y: output parameter holding the predictions, _y[k*nout+j] is output j of record k
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int RSMEvalBatch( const struct RSMEval *_ev, const double *_x, int _rows, double *_y )
+{
+    int k=0, i=0, j=0;
+    double *tmp_l = NULL;          // the logarithms of the inputs
+    unsigned char *tmp_pos = NULL; // 1: all the inputs of the record are > 0
+
+    if( _rows <= 0 )
+        return 0;
+    tmp_l = malloc( sizeof(double)*((size_t)_rows*_ev->nin+1) );
+    tmp_pos = malloc( _rows );
+    if( tmp_l == NULL || tmp_pos == NULL )
+    {
+        printf( "RSMEvalBatch() error: memory allocation for [%d] records failed!\n", _rows );
+        free( tmp_l );
+        free( tmp_pos );
+        return -1;
+    }
+
+    for( k=0; k<_rows; k++ )
+    {
+        tmp_pos[k] = 1;
+        for( i=0; i<_ev->nin; i++ )
         {
-            *_a = _RSMRlt[i].a;
-            *_b = _RSMRlt[i].b;
-            printf( "*_a=%lf, *_b=%lf\n", *_a, *_b );
-            return 0;
-        }   
-    } 
+            double tmp_x = _x[(size_t)k*_ev->nin+i];
+            if( tmp_x > 0.0 )
+                tmp_l[(size_t)k*_ev->nin+i] = log( tmp_x );
+            else {
+                tmp_l[(size_t)k*_ev->nin+i] = 0.0;
+                tmp_pos[k] = 0;
+            }
+        }
+    }
 
-    printf( "Cannot find a record matching _IA=%s and _OA=%s in _RSMRlt!\n", _IA, _OA );
-    return -1;
+    SenMatrixGemm( tmp_l, _rows, _ev->nin, _ev->w, _ev->nout, _ev->loga, _y ); //log(A) + sum(B*b[i]*log(x[i]))
+    for( k=0; k<_rows; k++ )
+    {
+        double *tmp_y = _y + (size_t)k*_ev->nout;
+        for( j=0; j<_ev->nout; j++ )
+        {
+            if( tmp_pos[k] == 1 && _ev->A[j] > 0.0 )
+                tmp_y[j] = exp( tmp_y[j] );
+            else
+                tmp_y[j] = RSMEvalPow( _ev, _x + (size_t)k*_ev->nin, j );
+        }
+    }
+
+    free( tmp_l );
+    free( tmp_pos );
+    return 0;
 }
 
 /************************************************************************************************************************************************* 
@@ -415,43 +969,35 @@ int GetVICFromStrs(char *_IAs, char *_IVs, struct VarInCol *_VIC )
 int GetOnePvFromRSMRlt(char *_IA, char *_IV, char *_OA, struct RSMResults *_RSMRlt, double *_one_pv )
 {
  
-    int tmp_j=0;
-    double tmp_one_pv=1.0; 
-    double tmp_a=0.0, tmp_b=0.0;
+    int tmp_j=0, tmp_oa=0;
+    int tmp_in[MAXINPUTSNUM];
+    double tmp_x[MAXINPUTSNUM];
     struct VarInCol tmp_VIC[2];
+    struct RSMEval tmp_ev;
                   
     memset( tmp_VIC, 0x0, sizeof(tmp_VIC) );
 
+    if( RSMCoefs.src != _RSMRlt ) // the coefficients are rebuilt by RSMCoefBuild() whenever _RSMRlt is changed
+        RSMCoefBuild( _RSMRlt, &RSMCoefs );
+    tmp_oa = SymID( &(FPMSyms.out), _OA, 0 );
+
     if( GetVICFromStrs(_IA, _IV, tmp_VIC ) != 0 )//form tmp_VIC with _IA(input Alias seperated by "+") and _IV(input values seperated by "+")
     {
         printf( "CmpRSMnSMT() error : GetVICFromStrs() error: InputAlias=%s, InputNewValue=%s\n", _IA, _IV);
         return -1;
     }
-    while( strlen(tmp_VIC[0].ColVal[tmp_j]) != 0 ) //X*=x[i]^b[i]
+    for( tmp_j=0; tmp_j<MAXINPUTSNUM && strlen(tmp_VIC[0].ColVal[tmp_j]) != 0; tmp_j++ )
     {
-        double tmp_input_value = atof(tmp_VIC[1].ColVal[tmp_j]);
-
-        //get the power curve fitting parameters of a and b for one input variable and one output variable 
-        if( GetParFromRSMRlt(tmp_VIC[0].ColVal[tmp_j], _OA, _RSMRlt, &tmp_a, &tmp_b ) == -1 ) 
-        {
-            printf( "GetParFromRSMRlt()error! tmp_j=%d, _IA=%s, _OA=%s\n", tmp_j, tmp_VIC[0].ColVal[tmp_j], _OA );
-            return -1;
-        }
-        printf( "tmp_one_pv=%lf, tmp_input_value=%lf\n", tmp_one_pv, tmp_input_value );
-        tmp_one_pv *=  pow(tmp_input_value,tmp_b);//X*=x[i]^b[i]
-        tmp_j++;
+        tmp_in[tmp_j] = SymID( &(FPMSyms.in), tmp_VIC[0].ColVal[tmp_j], 0 );
+        tmp_x[tmp_j] = atof( tmp_VIC[1].ColVal[tmp_j] );
     }
-                   
-    tmp_a = 0.0, tmp_b= 0.0; 
-    printf( "before second GetParFromRSMRlt(): _one_pv=%lf\n", *_one_pv );
-    //get the power curve fitting parameters of A and B for combined input variables and one output variable 
-    if( GetParFromRSMRlt(_IA, _OA, _RSMRlt, &tmp_a, &tmp_b ) == -1 )
+
+    // the strings are only parsed here, the prediction is made by the compiled evaluator
+    if( RSMEvalCompile(&RSMCoefs, tmp_in, tmp_j, &tmp_oa, 1, &tmp_ev) != 0 || RSMEvalBatch(&tmp_ev, tmp_x, 1, _one_pv) != 0 )
     {
         printf( "GetParFromRSMRlt()error! _IA=%s, _OA=%s\n", _IA, _OA );
         return -1;
     }
-    // put the output value predicted from RSM to the CMB structure 
-    *_one_pv = tmp_a*pow(tmp_one_pv,tmp_b);//Y=A*X^B
     printf( "_one_pv=%lf\n", *_one_pv );
     fflush(stdout);
     return 0;
@@ -534,11 +1080,12 @@ int get1Data( char *buff, const char *_sep, double *_OneCd)
 {
    char tmp_buff[MAXSTRINGSIZE];
    char *token = NULL;
+   char *tmp_save = NULL; // strtok_r() instead of strtok() since DoA may call this function from many threads
 
    memset( tmp_buff, 0x0, sizeof(tmp_buff));
    sprintf( tmp_buff, "%s", buff );
 
-   token = strtok(tmp_buff, _sep);
+   token = strtok_r(tmp_buff, _sep, &tmp_save);
    if( token != NULL )
    {
       char *tmp_pt = token;
@@ -567,12 +1114,13 @@ int get6Data(char *buff, const char * _sep, double *_SixCd)
 {
    char tmp_buff[MAXSTRINGSIZE];
    char *token = NULL;
+   char *tmp_save = NULL; // strtok_r() instead of strtok() since DoA may call this function from many threads
    int counter=0;
 
    memset( tmp_buff, 0x0, sizeof(tmp_buff));
    sprintf( tmp_buff, "%s", buff );
 
-   token = strtok(tmp_buff, _sep);
+   token = strtok_r(tmp_buff, _sep, &tmp_save);
    if( token == NULL )
    {
        printf( "get6Data() error: tmp_buff=[%s], _sep=[%s]\n", tmp_buff, _sep );
@@ -585,7 +1133,7 @@ int get6Data(char *buff, const char * _sep, double *_SixCd)
        counter++;
        if( counter == 6 )
            break;
-       token = strtok(NULL,_sep);
+       token = strtok_r(NULL, _sep, &tmp_save);
        _SixCd[counter] = atof(token);
    }
 
@@ -696,7 +1244,7 @@ int readin( char * _fn , struct SMInfo * _si )
       }
 
     fclose (fp);
-    return 0; 
+    return FPMSymsBuild( _si ); 
 }
 
 /************************************************************************************************************************************************* 
@@ -760,6 +1308,74 @@ double CalMidVal( double _NV_1, double _NV_2, double _VV_1, double _VV_2, double
     return tmp_d;
 }
 
+/*************************************************************************************************************************************************
+ * the state of the critical value search of one output record ('O' type record in the configuration file) in one csv file. many OutCross
+ * structures can be fed with the same data line so that all the output records are evaluated within one single pass of the csv file
+ *************************************************************************************************************************************************/
+struct OutCross
+{
+    int si_index;   // the position of the output record in the configuration file (_si)
+    int column;     // the column position of the output variable on which the critical value is set
+    int column_TN;  // the column position of the target variable (TargetName)
+    int direction;  // 1: the output variable increases with time, -1: the output variable decreases with time
+    double CV;      // the critical value
+    double VV_1;    // the value of the output variable in the last data line
+    double NV_1;    // the value of the target variable in the last data line
+    long rows;      // how many data lines have been fed
+    int met;        // 1: the critical value has been met, 0: not yet
+    double result;  // the value of the target variable when the critical value is met
+};
+
+/*************************************************************************************************************************************************
+ * Function: initialize one OutCross structure with one output record of the configuration file and the column positions found in the head line
+ * _oc: output parameter indicating the OutCross structure to be initialized
+ * _single_si: input parameter indicating one output record ('O' type) of the configuration file
+ * _si_index: input parameter indicating the position of _single_si in the configuration file
+ * _column: input parameter indicating the column position of the output variable (FileVarName)
+ * _column_TN: input parameter indicating the column position of the target variable (TargetName)
+ * Return: void
+ *************************************************************************************************************************************************/
+void InitOutCross( struct OutCross *_oc, const struct SMInfo *_single_si, int _si_index, int _column, int _column_TN )
+{
+    memset( _oc, 0x0, sizeof(struct OutCross) );
+    _oc->si_index = _si_index;
+    _oc->column = _column;
+    _oc->column_TN = _column_TN;
+    _oc->direction = atoi(_single_si->Divisions);
+    _oc->CV = atof(_single_si->CriticalValue);
+}
+
+/*************************************************************************************************************************************************
+ * Function: feed one data line (the value of the output variable and the value of the target variable) to an OutCross structure. if the
+ *           critical value is met in this line, the value of the target variable is calculated by interpolation (CalMidVal()) and saved to
+ *           _oc->result. if the critical value is already met by the first data line, the value of the target variable in the first line is used
+ * _oc: input/output parameter indicating the OutCross structure
+ * _VV: input parameter indicating the value of the output variable in the current data line
+ * _NV: input parameter indicating the value of the target variable in the current data line
+ * Return: 1: the critical value is met in this data line
+ *         0: the critical value is not met yet (or has been met before)
+ *************************************************************************************************************************************************/
+int FeedOutCross( struct OutCross *_oc, double _VV, double _NV )
+{
+    if( _oc->met == 1 )
+        return 0;
+
+    // _oc->direction = 1 means the output variable should increase with time, otherwise it should decrease with time
+    if( (_oc->direction == 1 && _VV > _oc->CV) || (_oc->direction == -1 && _VV < _oc->CV) )
+    {
+        if( _oc->rows == 0 ) // the first line may be what we need, although the possibility is very very low
+            _oc->result = _NV;
+        else
+            _oc->result = CalMidVal(_oc->NV_1, _NV, _oc->VV_1, _VV, _oc->CV);
+        _oc->met = 1;
+    }
+
+    _oc->VV_1 = _VV; //marching the data pair ahead
+    _oc->NV_1 = _NV;
+    _oc->rows++;
+    return _oc->met;
+}
+
 /************************************************************************************************************************************************* 
  * Function: find the the value of one column (_column) in a string (_buff) which is, for example, a data line in a CSV file
  * _buff: input parameter indicating the data line of a csv file
@@ -811,195 +1427,1773 @@ int getValueByCol(char *_buff, const int _column, const char *_sep, double *_ret
     return -1;
 }
 
-/************************************************************************************************************************************************* 
- * Function: calculate the output base value correspoding to the output information in _single_si
- *     Flowchat: 
- *	1. find the devc.csv or evac.csv corresponding to _base_fn in ./base
- *	2. make sure the output variable (on which the critical value is set ) in the _single_si also exists in the csv file
- *	3. _col is the position of the output variables in the csv file
- *	4. when the critical value of the output variable is met, put the corresponding value of the target variable into _return_d 
- *	5. this function only calculate one value of the target variable specified by TargetName in _single_si. repeated calls of this function can generate all the values of all the target variables  if each time the _single_si is a different 'O' type record.
- *
- * _base_fn: input parameter indicating the name of the baseline FDS file
- * _single_si: input parameter indicating the output variable information
- * _return_d: output parameter indicating an output base value found in the csv file of the baseline fds simulation
+/*************************************************************************************************************************************************
+ * the memory mapped csv reader: the whole csv file is mapped into memory (MapFileOpen()) and walked in place. lines and fields are returned as
+ * spans [head, tail) pointing into the mapped file so that nothing is copied into line buffers and nothing is modified by strtok().
+ *************************************************************************************************************************************************/
+struct MapFile
+{
+    int fd;       // file descriptor of the mapped file
+    char *data;   // the mapped content, NULL if the file is empty
+    size_t size;  // the size of the mapped content
+};
+
+struct Span
+{
+    const char *head; // the first char of the span
+    const char *tail; // one past the last char of the span
+};
+
+/*************************************************************************************************************************************************
+ * Function: map a file into memory for read only
+ * _fn: input parameter indicating the file name
+ * _mf: output parameter holding the mapped file
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int getOutputBaseValue( const char * _base_fn, const struct SMInfo _single_si, double * _return_d )
+int MapFileOpen( const char *_fn, struct MapFile *_mf )
 {
-    DIR *tmp_dir = NULL;
-    struct dirent *en = NULL;
-    char tmp_base_dir[MAXSTRINGSIZE];
-    char tmp_base_fn[MAXSTRINGSIZE];
-    char tmp_devc_fn[MAXSTRINGSIZE];
-    char tmp_evac_fn[MAXSTRINGSIZE];
-    char *tmp_head = NULL;
-    int flag=0; // check if the critical value is met in the file fp
-    
-    memset( tmp_base_dir, 0x0, sizeof(tmp_base_dir) );
-    memset( tmp_base_fn, 0x0, sizeof(tmp_base_fn) );
-    memset( tmp_devc_fn, 0x0, sizeof(tmp_devc_fn) );
-    memset( tmp_evac_fn, 0x0, sizeof(tmp_evac_fn) );
-
-    sprintf( tmp_base_fn, "%s", _base_fn );
-    tmp_head = strstr(tmp_base_fn, ".fds" );
-    *tmp_head = '\0'; // remove the ".fds" from the base file name
+    struct stat tmp_st;
 
-    if (getcwd(tmp_base_dir, sizeof(tmp_base_dir)) == NULL) {
-        perror("getcwd() error");
+    memset( _mf, 0x0, sizeof(struct MapFile) );
+    _mf->fd = open( _fn, O_RDONLY );
+    if( _mf->fd == -1 )
+    {
+        printf( "MapFileOpen() error: open [%s] failed!\n", _fn );
+        return -1;
+    }
+    if( fstat(_mf->fd, &tmp_st) != 0 )
+    {
+        printf( "MapFileOpen() error: fstat [%s] failed!\n", _fn );
+        close(_mf->fd);
         return -1;
     }
-    strcat( tmp_base_dir, "/base" );
 
-    tmp_dir = opendir(tmp_base_dir);
-    if( tmp_dir == NULL )
+    _mf->size = (size_t)tmp_st.st_size;
+    if( _mf->size == 0 ) // an empty file cannot be mapped, it just has no lines
+        return 0;
+
+    _mf->data = mmap( NULL, _mf->size, PROT_READ, MAP_PRIVATE, _mf->fd, 0 );
+    if( _mf->data == MAP_FAILED )
     {
-        printf( "opendir error: [%s]\n", tmp_base_dir );
+        printf( "MapFileOpen() error: mmap [%s] failed!\n", _fn );
+        close(_mf->fd);
+        _mf->data = NULL;
         return -1;
     }
+    madvise( _mf->data, _mf->size, MADV_SEQUENTIAL ); // the csv files are always read from the beginning to the end
+    return 0;
+}
 
-    printf("Current working dir in getOutputBaseValue(): %s\n", tmp_base_dir);
-
-     while ((en = readdir(tmp_dir)) != NULL)
-     {
-         FILE *fp = NULL;
-         FILE *tmp_fp = NULL;
-         char tmp_whole_fn[MAXSTRINGSIZE];
-         char buff_1[MAXSTRINGSIZE];
-         char buff_2[MAXSTRINGSIZE];
-         double tmp_first_value=0.00;
-         double tmp_first_NV=0.00;
-         double tmp_first_CV = atof(_single_si.CriticalValue);
-         int tmp_first_direction = atoi(_single_si.Divisions);
-         int column = 0, column_TN;
-
-         memset( tmp_whole_fn, 0x0, sizeof(tmp_whole_fn));
-         memset( buff_1, 0x0, sizeof(buff_1));
-         memset( buff_2, 0x0, sizeof(buff_2));
-         
+// unmap and close a file mapped by MapFileOpen()
+void MapFileClose( struct MapFile *_mf )
+{
+    if( _mf->data != NULL )
+        munmap( _mf->data, _mf->size );
+    if( _mf->fd > 0 )
+        close( _mf->fd );
+    memset( _mf, 0x0, sizeof(struct MapFile) );
+}
 
-         //if( strstr( en->d_name, ".csv" ) == NULL || (strstr(en->d_name,"devc") == NULL 
-          //                                        && strstr(en->d_name, "evac")== NULL ) || strstr(en->d_name, tmp_base_fn )==NULL )
-         if( strstr( en->d_name, ".csv" ) == NULL || (strstr(en->d_name,"devc") == NULL 
-                                                  && strstr(en->d_name, "evac")== NULL ) )
-         {
-             printf( "in while before continue, en->d_name = [%s], tmp_base_fn=[%s]!\n", en->d_name, tmp_base_fn );
-             continue;
-         }
+/*************************************************************************************************************************************************
+ * Function: get the next line of a mapped file starting at *_pos. the line span doesn't include the line end ("\n" or "\r\n")
+ * _mf: input parameter indicating a mapped file
+ * _pos: input/output parameter indicating the offset where the next line starts, it is moved to the beginning of the following line
+ * _line: output parameter holding the line span
+ * Return: 0: success
+ *         -1: no more lines
+ *************************************************************************************************************************************************/
+int MapNextLine( const struct MapFile *_mf, size_t *_pos, struct Span *_line )
+{
+    const char *tmp_end = NULL;
 
-         
-         sprintf(tmp_whole_fn, "%s/%s", tmp_base_dir, en->d_name ); 
-         fp=fopen(tmp_whole_fn,"r");
-         if( fp == NULL )
-         {
-             printf( "open file [%s]failed!\n",tmp_whole_fn);
-             return -1;
-         }
+    if( _mf->data == NULL || *_pos >= _mf->size )
+        return -1;
 
-         printf( "in while 2, en->d_name = [%s], tmp_base_fn=[%s], tmp_whole_fn=[%s]!\n", en->d_name, tmp_base_fn, tmp_whole_fn );
-         
-         if( fgets(buff_1,sizeof(buff_1),fp) == NULL ) // we don't need the first line of the csv file
-         {
-             printf( "read first line of [%s] error\n", tmp_whole_fn); 
-             fclose(fp);
-             return -1;
-         } 
-         printf( "in while 3,buff_1=[%s]!\n", buff_1); 
-         if( fgets(buff_1,sizeof(buff_1),fp) == NULL ) // we need the second line of the csv file which is the headline 
-         {
-             printf( "read second line of [%s] error\n", tmp_whole_fn); 
-             fclose(fp);
-             return -1;
-         } else {
-             if( strstr(buff_1, _single_si.FileVarName) == NULL ) // the file doesn't include the output variable, check next file
-             {
-                 printf( "the second line of csv file doesn't include [%s] \n", _single_si.FileVarName );
-                 continue;
-             }
-         }
+    _line->head = _mf->data + *_pos;
+    tmp_end = memchr( _line->head, '\n', _mf->size - *_pos );
+    if( tmp_end == NULL ) // the last line doesn't end with "\n"
+    {
+        _line->tail = _mf->data + _mf->size;
+        *_pos = _mf->size;
+    } else {
+        _line->tail = tmp_end;
+        *_pos = tmp_end - _mf->data + 1;
+    }
+    if( _line->tail > _line->head && _line->tail[-1] == '\r' )
+        _line->tail--;
+    return 0;
+}
+
+// return 1 if the span only has blank chars, otherwise return 0
+int SpanIsBlank( struct Span _sp )
+{
+    const char *tmp_p = _sp.head;
+    for( ; tmp_p < _sp.tail; tmp_p++ )
+    {
+        if( strchr("\t\n\v\f\r ", *tmp_p) == NULL )
+            return 0;
+    }
+    return 1;
+}
+
+// return 1 if the span includes the string _str, otherwise return 0 (the span version of strstr())
+int SpanHasStr( struct Span _sp, const char *_str )
+{
+    size_t tmp_len = strlen(_str);
+    const char *tmp_p = _sp.head;
+
+    if( tmp_len == 0 )
+        return 1;
+    while( (size_t)(_sp.tail - tmp_p) >= tmp_len )
+    {
+        tmp_p = memchr( tmp_p, _str[0], _sp.tail - tmp_p - tmp_len + 1 );
+        if( tmp_p == NULL )
+            return 0;
+        if( memcmp(tmp_p, _str, tmp_len) == 0 )
+            return 1;
+        tmp_p++;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: convert a field span to a double value without the need of a '\0' terminated string. FDS writes the values like " 2.0000000E+001",
+ *           namely at most 19 significant digits and a short exponent, so the digits are collected into one integer and scaled by one exact
+ *           power of ten, which gives the correctly rounded value (the same as strtod()) when the integer is below 2^53 and the exponent is
+ *           within [-22, 22]. any other field is copied to a small local string for strtod()
+ * _field: input parameter indicating a field span
+ * Return: the converted value, 0.0 if the field is not a number
+ *************************************************************************************************************************************************/
+double SpanToDouble( struct Span _field )
+{
+    static const double tmp_pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char *tmp_p = _field.head;
+    unsigned long tmp_m = 0; // the significant digits
+    int tmp_digits = 0, tmp_any = 0, tmp_exp = 0, tmp_neg = 0;
+    char tmp_str[64];
+    size_t tmp_len = 0;
+
+    while( tmp_p < _field.tail && (*tmp_p == ' ' || *tmp_p == '\t') )
+        tmp_p++;
+    if( tmp_p < _field.tail && (*tmp_p == '-' || *tmp_p == '+') )
+        tmp_neg = (*(tmp_p++) == '-');
+    for( ; tmp_p < _field.tail && *tmp_p >= '0' && *tmp_p <= '9'; tmp_p++, tmp_any=1 )
+    {
+        if( tmp_m == 0 && *tmp_p == '0' ) // the leading zeros are not significant
+            continue;
+        if( ++tmp_digits > 19 )
+            goto slow;
+        tmp_m = tmp_m*10 + (*tmp_p - '0');
+    }
+    if( tmp_p < _field.tail && *tmp_p == '.' )
+    {
+        for( tmp_p++; tmp_p < _field.tail && *tmp_p >= '0' && *tmp_p <= '9'; tmp_p++, tmp_any=1 )
+        {
+            tmp_exp--;
+            if( tmp_m == 0 && *tmp_p == '0' )
+                continue;
+            if( ++tmp_digits > 19 )
+                goto slow;
+            tmp_m = tmp_m*10 + (*tmp_p - '0');
+        }
+    }
+    if( tmp_any == 0 )
+        goto slow;
+    if( tmp_p < _field.tail && (*tmp_p == 'E' || *tmp_p == 'e') )
+    {
+        int tmp_e = 0, tmp_e_neg = 0, tmp_e_digits = 0;
+
+        tmp_p++;
+        if( tmp_p < _field.tail && (*tmp_p == '-' || *tmp_p == '+') )
+            tmp_e_neg = (*(tmp_p++) == '-');
+        for( ; tmp_p < _field.tail && *tmp_p >= '0' && *tmp_p <= '9'; tmp_p++ )
+        {
+            if( ++tmp_e_digits > 4 )
+                goto slow;
+            tmp_e = tmp_e*10 + (*tmp_p - '0');
+        }
+        if( tmp_e_digits == 0 )
+            goto slow;
+        tmp_exp += tmp_e_neg ? -tmp_e : tmp_e;
+    }
+    while( tmp_p < _field.tail && (*tmp_p == ' ' || *tmp_p == '\t') )
+        tmp_p++;
+    if( tmp_p != _field.tail ) // something strtod() should decide
+        goto slow;
+
+    if( tmp_m == 0 )
+        return tmp_neg ? -0.0 : 0.0;
+    if( tmp_m <= (1UL<<53) && tmp_exp >= -22 && tmp_exp <= 22 )
+    {
+        double tmp_d = (tmp_exp < 0) ? (double)tmp_m / tmp_pow10[-tmp_exp] : (double)tmp_m * tmp_pow10[tmp_exp];
+        return tmp_neg ? -tmp_d : tmp_d;
+    }
+
+slow:
+    tmp_len = _field.tail - _field.head;
+    if( tmp_len >= sizeof(tmp_str) )
+        tmp_len = sizeof(tmp_str)-1;
+    memcpy( tmp_str, _field.head, tmp_len );
+    tmp_str[tmp_len] = '\0';
+    return strtod( tmp_str, NULL );
+}
+
+#define MAXCOLUMNNUM 4096 // the max number of columns in a csv file
+
+// return _x with every bit being the xor of itself and all the lower bits, which turns the positions of the quotes into the "inside quotes" mask
+unsigned int PrefixXor( unsigned int _x )
+{
+    _x ^= _x << 1;
+    _x ^= _x << 2;
+    _x ^= _x << 4;
+    _x ^= _x << 8;
+    _x ^= _x << 16;
+    return _x;
+}
+
+#if FPMAVX2
+// the AVX2 part of SpanSepIndex(): scan the blocks of 32 chars from *_p on, *_p and *_carry are left at the rest of the line, return the new _n
+FPMAVX2TARGET int SpanSepIndexAVX2( const char **_p, const char *_tail, const char _sep, unsigned int *_carry, const char **_seps, int _n, const int _max )
+{
+    __m256i tmp_vsep = _mm256_set1_epi8( _sep );
+    __m256i tmp_vquote = _mm256_set1_epi8( '"' );
+    const char *tmp_p = *_p;
+    unsigned int tmp_carry = *_carry;
+
+    for( ; tmp_p+32 <= _tail; tmp_p+=32 )
+    {
+        __m256i tmp_v = _mm256_loadu_si256( (const __m256i *)tmp_p );
+        unsigned int tmp_sep = (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi8(tmp_v, tmp_vsep) );
+        unsigned int tmp_quote = (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi8(tmp_v, tmp_vquote) );
+        unsigned int tmp_inside = PrefixXor(tmp_quote) ^ (tmp_carry ? 0xFFFFFFFFu : 0u);
+
+        tmp_sep &= ~tmp_inside;
+        tmp_carry = (tmp_inside >> 31) & 1u;
+        while( tmp_sep != 0 )
+        {
+            _seps[_n++] = tmp_p + __builtin_ctz(tmp_sep);
+            if( _n == _max )
+                return _n;
+            tmp_sep &= tmp_sep - 1;
+        }
+    }
+    *_p = tmp_p;
+    *_carry = tmp_carry;
+    return _n;
+}
+#endif
+
+/*************************************************************************************************************************************************
+ * Function: build the structural index of a line span, namely the positions of the delimiters which are not inside quotes. the line is
+ *           scanned 32 (AVX2, see FPMAVX2) or 16 (SSE2) chars at a time: the delimiters and the quotes of a block are found by one
+ *           compare each, the delimiters inside quotes are masked out by the prefix xor of the quote positions
+ * _line: input parameter indicating a line of a csv file
+ * _sep: input parameter indicating a delimiter
+ * _seps: output parameter holding the positions of the delimiters, field k of the line is [_seps[k-1]+1, _seps[k]) (the line head for k=0, the
+ *        line tail for the last field)
+ * _max: input parameter indicating the length of _seps, the scanning stops once _max delimiters are found
+ * Return: the number of delimiters found
+ *************************************************************************************************************************************************/
+int SpanSepIndex( struct Span _line, const char _sep, const char **_seps, const int _max )
+{
+    const char *tmp_p = _line.head;
+    unsigned int tmp_carry = 0; // 1: the current position is inside quotes
+    int n=0;
+
+    if( _max <= 0 )
+        return 0;
+
+#if FPMAVX2
+    if( FPMHasAVX2() && (n = SpanSepIndexAVX2(&tmp_p, _line.tail, _sep, &tmp_carry, _seps, n, _max)) == _max )
+        return n;
+#endif
+#if defined(__SSE2__)
+    {
+        __m128i tmp_vsep = _mm_set1_epi8( _sep );
+        __m128i tmp_vquote = _mm_set1_epi8( '"' );
+        for( ; tmp_p+16 <= _line.tail; tmp_p+=16 )
+        {
+            __m128i tmp_v = _mm_loadu_si128( (const __m128i *)tmp_p );
+            unsigned int tmp_sep = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8(tmp_v, tmp_vsep) );
+            unsigned int tmp_quote = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8(tmp_v, tmp_vquote) );
+            unsigned int tmp_inside = (PrefixXor(tmp_quote) ^ (tmp_carry ? 0xFFFFu : 0u)) & 0xFFFFu;
+
+            tmp_sep &= ~tmp_inside;
+            tmp_carry = (tmp_inside >> 15) & 1u;
+            while( tmp_sep != 0 )
+            {
+                _seps[n++] = tmp_p + __builtin_ctz(tmp_sep);
+                if( n == _max )
+                    return n;
+                tmp_sep &= tmp_sep - 1;
+            }
+        }
+    }
+#endif
+
+    for( ; tmp_p < _line.tail; tmp_p++ ) // the rest of the line, or the whole line when there is no SIMD support
+    {
+        if( *tmp_p == '"' )
+            tmp_carry ^= 1u;
+        else if( *tmp_p == _sep && tmp_carry == 0 )
+        {
+            _seps[n++] = tmp_p;
+            if( n == _max )
+                return n;
+        }
+    }
+    return n;
+}
+
+// get field _k of a line span whose structural index is _seps (_nseps delimiters), see SpanSepIndex()
+struct Span SpanField( struct Span _line, const char **_seps, const int _nseps, const int _k )
+{
+    struct Span tmp_field;
+
+    tmp_field.head = (_k == 0) ? _line.head : _seps[_k-1]+1;
+    tmp_field.tail = (_k < _nseps) ? _seps[_k] : _line.tail;
+    return tmp_field;
+}
+
+/*************************************************************************************************************************************************
+ * Function: find the column position of a variable in a line span, which is, for example, the head line of a CSV file. this is the span version
+ *           of getColumnPos(), the blanks and the quotes around each field are ignored
+ * _line: input parameter indicating the head line of a csv file
+ * _FileVarName: input parameter indicating a variable in FDS file
+ * _sep: input parameter indicating a delimiter
+ * Return: a count >= 0 meaning the column position of _FileVarName in _line
+ *         -1: cannot find _FileVarName in _line
+ *************************************************************************************************************************************************/
+int SpanColumnPos( struct Span _line, const char *_FileVarName, const char _sep )
+{
+    const char *tmp_seps[MAXCOLUMNNUM];
+    size_t tmp_len = strlen(_FileVarName);
+    int k=0, tmp_nseps = SpanSepIndex( _line, _sep, tmp_seps, MAXCOLUMNNUM );
+
+    if( tmp_nseps == MAXCOLUMNNUM )
+        printf( "SpanColumnPos() warning: only the first [%d] columns are searched for [%s]\n", MAXCOLUMNNUM, _FileVarName );
+    for( k=0; k<=tmp_nseps && k<MAXCOLUMNNUM; k++ )
+    {
+        struct Span tmp_field = SpanField( _line, tmp_seps, tmp_nseps, k );
+
+        while( tmp_field.head < tmp_field.tail && strchr(" \t\"", *tmp_field.head) != NULL )
+            tmp_field.head++;
+        while( tmp_field.tail > tmp_field.head && strchr(" \t\"", tmp_field.tail[-1]) != NULL )
+            tmp_field.tail--;
+        if( (size_t)(tmp_field.tail - tmp_field.head) == tmp_len && memcmp(tmp_field.head, _FileVarName, tmp_len) == 0 )
+            return k;
+    }
+    return -1; // not found
+}
+
+#if FPMAVX2
+// the AVX2 part of SpanSkipFields(): count the delimiters in the blocks of 32 chars from *_p on, return the beginning of the field wanted, or
+// NULL with *_p, *_carry and *_k left at the rest of the line
+FPMAVX2TARGET const char *SpanSkipFieldsAVX2( const char **_p, const char *_tail, const char _sep, unsigned int *_carry, int *_k )
+{
+    __m256i tmp_vsep = _mm256_set1_epi8( _sep );
+    __m256i tmp_vquote = _mm256_set1_epi8( '"' );
+    const char *tmp_p = *_p;
+    unsigned int tmp_carry = *_carry;
+    int tmp_k = *_k;
+
+    for( ; tmp_p+32 <= _tail; tmp_p+=32 )
+    {
+        __m256i tmp_v = _mm256_loadu_si256( (const __m256i *)tmp_p );
+        unsigned int tmp_sep = (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi8(tmp_v, tmp_vsep) );
+        unsigned int tmp_quote = (unsigned int)_mm256_movemask_epi8( _mm256_cmpeq_epi8(tmp_v, tmp_vquote) );
+        unsigned int tmp_inside = PrefixXor(tmp_quote) ^ (tmp_carry ? 0xFFFFFFFFu : 0u);
+        int tmp_count = 0;
+
+        tmp_sep &= ~tmp_inside;
+        tmp_carry = (tmp_inside >> 31) & 1u;
+        tmp_count = __builtin_popcount(tmp_sep);
+        if( tmp_count < tmp_k )
+        {
+            tmp_k -= tmp_count;
+            continue;
+        }
+        while( --tmp_k > 0 )
+            tmp_sep &= tmp_sep - 1;
+        return tmp_p + __builtin_ctz(tmp_sep) + 1;
+    }
+    *_p = tmp_p;
+    *_carry = tmp_carry;
+    *_k = tmp_k;
+    return NULL;
+}
+#endif
+
+/*************************************************************************************************************************************************
+ * Function: skip _k fields of a line starting at _p, namely jump over _k delimiters which are not inside quotes without converting anything.
+ *           the delimiters are counted 32 (AVX2, see FPMAVX2) or 16 (SSE2) chars at a time
+ * _p: input parameter indicating the beginning of a field
+ * _tail: input parameter indicating the end of the line
+ * _sep: input parameter indicating a delimiter
+ * _k: input parameter indicating the number of fields to skip
+ * Return: the beginning of the field _k fields after _p
+ *         NULL: the line has less than _k delimiters after _p
+ *************************************************************************************************************************************************/
+const char *SpanSkipFields( const char *_p, const char *_tail, const char _sep, int _k )
+{
+    unsigned int tmp_carry = 0; // 1: the current position is inside quotes
+
+    if( _k <= 0 )
+        return _p;
+
+#if FPMAVX2
+    if( FPMHasAVX2() )
+    {
+        const char *tmp_field = SpanSkipFieldsAVX2( &_p, _tail, _sep, &tmp_carry, &_k );
+        if( tmp_field != NULL )
+            return tmp_field;
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        __m128i tmp_vsep = _mm_set1_epi8( _sep );
+        __m128i tmp_vquote = _mm_set1_epi8( '"' );
+        for( ; _p+16 <= _tail; _p+=16 )
+        {
+            __m128i tmp_v = _mm_loadu_si128( (const __m128i *)_p );
+            unsigned int tmp_sep = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8(tmp_v, tmp_vsep) );
+            unsigned int tmp_quote = (unsigned int)_mm_movemask_epi8( _mm_cmpeq_epi8(tmp_v, tmp_vquote) );
+            unsigned int tmp_inside = (PrefixXor(tmp_quote) ^ (tmp_carry ? 0xFFFFu : 0u)) & 0xFFFFu;
+            int tmp_count = 0;
+
+            tmp_sep &= ~tmp_inside;
+            tmp_carry = (tmp_inside >> 15) & 1u;
+            tmp_count = __builtin_popcount(tmp_sep);
+            if( tmp_count < _k )
+            {
+                _k -= tmp_count;
+                continue;
+            }
+            while( --_k > 0 )
+                tmp_sep &= tmp_sep - 1;
+            return _p + __builtin_ctz(tmp_sep) + 1;
+        }
+    }
+#endif
+
+    for( ; _p < _tail; _p++ ) // the rest of the line, or the whole line when there is no SIMD support
+    {
+        if( *_p == '"' )
+            tmp_carry ^= 1u;
+        else if( *_p == _sep && tmp_carry == 0 && --_k == 0 )
+            return _p + 1;
+    }
+    return NULL;
+}
+
+/*************************************************************************************************************************************************
+ * the projection of a csv file: the columns needed by the output records are compiled once per file into the distinct column positions in
+ * ascending order, so that each data line is walked from left to right only up to the last needed column, the other fields are skipped by
+ * SpanSkipFields() and each needed field is converted only once even if it is used by many output records (e.g. the Time column)
+ *************************************************************************************************************************************************/
+#define MAXPROJECTNUM (2*MAXOUTPUTSNUM)
+
+struct DevcProjection
+{
+    int n;                        // the number of the requested columns
+    int columns[MAXPROJECTNUM];   // the requested columns in the requested order
+    int nuniq;                    // the number of the distinct columns
+    int uniq[MAXPROJECTNUM];      // the distinct columns in ascending order
+    int slot[MAXPROJECTNUM];      // the requested column i is uniq[slot[i]]
+};
+
+/*************************************************************************************************************************************************
+ * Function: compile the requested columns into a projection
+ * _columns: input parameter indicating the positions of the variables in the headline of a CSV file, in any order and may be repeated
+ * _n: input parameter indicating the length of _columns
+ * _pj: output parameter holding the projection
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int SpanProject( const int *_columns, const int _n, struct DevcProjection *_pj )
+{
+    int i=0,j=0;
+
+    memset( _pj, 0x0, sizeof(struct DevcProjection) );
+    if( _n > MAXPROJECTNUM )
+    {
+        printf( "SpanProject() error: [%d] columns requested, MAXPROJECTNUM=[%d]\n", _n, MAXPROJECTNUM );
+        return -1;
+    }
+
+    for( i=0; i<_n; i++ )
+    {
+        int k=0;
+
+        if( _columns[i] < 0 )
+        {
+            printf( "SpanProject() error: column [%d] is negative\n", _columns[i] );
+            return -1;
+        }
+        _pj->columns[i] = _columns[i];
+        for( k=0; k<_pj->nuniq && _pj->uniq[k] < _columns[i]; k++ )
+            ;
+        if( k < _pj->nuniq && _pj->uniq[k] == _columns[i] ) // already in the list
+            continue;
+        memmove( &(_pj->uniq[k+1]), &(_pj->uniq[k]), sizeof(int)*(_pj->nuniq-k) ); // insertion sort, the list is short
+        _pj->uniq[k] = _columns[i];
+        _pj->nuniq++;
+    }
+    _pj->n = _n;
+
+    for( i=0; i<_n; i++ )
+    {
+        for( j=0; j<_pj->nuniq; j++ )
+        {
+            if( _pj->uniq[j] == _columns[i] )
+            {
+                _pj->slot[i] = j;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: get the values of the projected columns of a line span. the unneeded fields are skipped without being converted
+ * _line: input parameter indicating the data line of a csv file
+ * _pj: input parameter indicating the projection compiled by SpanProject()
+ * _sep: input parameter indicating a delimiter
+ * _return_d: output parameter indicating the values of the requested columns in the requested order
+ * Return: 0: success
+ *         -1: Failure, at least one column is not found in _line
+ *************************************************************************************************************************************************/
+int SpanProjectValues( struct Span _line, const struct DevcProjection *_pj, const char _sep, double *_return_d )
+{
+    double tmp_values[MAXPROJECTNUM];
+    const char *tmp_p = _line.head;
+    int i=0, tmp_column=0; // tmp_column is the column starting at tmp_p
+
+    for( i=0; i<_pj->nuniq; i++ )
+    {
+        struct Span tmp_field;
+        const char *tmp_next = NULL;
+
+        tmp_p = (tmp_p == NULL) ? NULL : SpanSkipFields( tmp_p, _line.tail, _sep, _pj->uniq[i] - tmp_column );
+        if( tmp_p == NULL )
+        {
+            printf( "SpanProjectValues() error: column [%d] not found in line=[%.*s]\n", _pj->uniq[i], (int)(_line.tail-_line.head), _line.head );
+            return -1;
+        }
+        tmp_next = SpanSkipFields( tmp_p, _line.tail, _sep, 1 );
+        tmp_field.head = tmp_p;
+        tmp_field.tail = (tmp_next == NULL) ? _line.tail : tmp_next-1;
+        tmp_values[i] = SpanToDouble( tmp_field );
+        tmp_p = tmp_next;
+        tmp_column = _pj->uniq[i] + 1;
+    }
+
+    for( i=0; i<_pj->n; i++ )
+        _return_d[i] = tmp_values[_pj->slot[i]];
+    return 0;
+}
+
+
+/*************************************************************************************************************************************************
+ * the binary columnar cache of the csv files: the first time a devc.csv/evac.csv is parsed, all its columns are saved to a sidecar file named
+ * <csv name>.fpmc next to it. the sidecar holds a DevcCacheHead, the head line of the csv (the dictionary of the column names) and all the values
+ * column by column. the size, the last modified time and the FNV-1a hash of the csv are saved in the DevcCacheHead so that a stale sidecar is
+ * rebuilt. the values are kept as double so that the cached runs give exactly the same results as the runs parsing the csv text.
+ * DevcCacheMode: 0: don't use the sidecar files, the csv files are read directly (the default)
+ *                1: use the sidecar files, create them if they don't exist or are stale
+ *                2: as 1, and the csv file is removed once its sidecar is created, namely the sidecar replaces the csv
+ *                   (except the baseline csv files, see GenBaseOutputs())
+ *************************************************************************************************************************************************/
+#define DEVCCACHESUFFIX ".fpmc"
+#define DEVCCACHEMAGIC "FPMDEVC"
+#define DEVCCACHEVERSION 1
+
+int DevcCacheMode = 0;
+
+struct DevcCacheHead
+{
+    char magic[8];          // DEVCCACHEMAGIC
+    int version;            // DEVCCACHEVERSION
+    int ncols;              // the number of columns
+    long nrows;             // the number of data lines
+    long src_size;          // the size of the csv file
+    long src_mtime;         // the last modified time of the csv file
+    unsigned long src_hash; // the FNV-1a hash of the csv file
+    long head_len;          // the length of the head line following this structure
+};
+
+struct DevcTable
+{
+    int ncols;     // the number of columns
+    long nrows;    // the number of data lines
+    char *head;    // the head line of the csv file, '\0' terminated
+    long head_len; // the length of head
+    double *data;  // the values saved column by column, the value at row r of column c is data[c*nrows + r]
+};
+
+// the reader of a csv file which walks the mapped csv or the decompressor pipe of a compressed csv (DevcCacheMode == 0), or the columns of a
+// DevcTable (DevcCacheMode != 0)
+struct DevcReader
+{
+    int cached;          // 1: the rows come from dt, 0: the rows come from mf or pipe
+    struct MapFile mf;   // the mapped csv file
+    size_t pos;          // the offset of the next line in mf
+    struct DevcTable dt; // the columns of the csv file
+    long row;            // the next row in dt
+    struct Span head;    // the head line of the csv file
+    FILE *pipe;          // the decompressor pipe of a compressed csv file, NULL for a plain csv file
+    char *buf;           // the chunk buffer of pipe
+    size_t buf_size;     // the size of buf
+    size_t buf_len;      // the length of the data in buf
+    size_t buf_pos;      // the offset of the next line in buf
+    int buf_eof;         // 1: all the data of pipe are in buf
+    struct DevcProjection pj; // the columns returned by DevcNextRow(), set by DevcProject()
+};
+
+// free the memory held by a DevcTable
+void DevcTableFree( struct DevcTable *_dt )
+{
+    free( _dt->head );
+    free( _dt->data );
+    memset( _dt, 0x0, sizeof(struct DevcTable) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: parse all the data lines of a mapped csv file into a DevcTable. the first line of the csv file (the units) is not used, the second
+ *           line is the head line which decides the number of columns
+ * _mf: input parameter indicating a mapped csv file
+ * _dt: output parameter holding the columns of the csv file, it should be freed by DevcTableFree()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcTableFromMap( const struct MapFile *_mf, struct DevcTable *_dt )
+{
+    struct Span tmp_line;
+    const char *tmp_seps[MAXCOLUMNNUM];
+    size_t tmp_pos = 0, tmp_data_pos = 0;
+    long r=0;
+
+    memset( _dt, 0x0, sizeof(struct DevcTable) );
+    if( MapNextLine(_mf, &tmp_pos, &tmp_line) != 0 || MapNextLine(_mf, &tmp_pos, &tmp_line) != 0 )
+    {
+        printf( "DevcTableFromMap() error: no head line!\n" );
+        return -1;
+    }
+
+    _dt->head_len = tmp_line.tail - tmp_line.head;
+    _dt->head = calloc( _dt->head_len+1, 1 );
+    if( _dt->head == NULL )
+    {
+        printf( "DevcTableFromMap() error: calloc() head failed!\n" );
+        return -1;
+    }
+    memcpy( _dt->head, tmp_line.head, _dt->head_len );
+    _dt->ncols = SpanSepIndex( tmp_line, s[0], tmp_seps, MAXCOLUMNNUM ) + 1;
+    if( _dt->ncols > MAXCOLUMNNUM )
+    {
+        printf( "DevcTableFromMap() error: more than MAXCOLUMNNUM=[%d] columns!\n", MAXCOLUMNNUM );
+        DevcTableFree( _dt );
+        return -1;
+    }
+
+    // the first pass counts the data lines so that the columns can be allocated at one time
+    tmp_data_pos = tmp_pos;
+    while( MapNextLine(_mf, &tmp_pos, &tmp_line) == 0 )
+    {
+        if( SpanIsBlank(tmp_line) == 0 )
+            _dt->nrows++;
+    }
+    _dt->data = malloc( sizeof(double) * _dt->ncols * (_dt->nrows > 0 ? _dt->nrows : 1) );
+    if( _dt->data == NULL )
+    {
+        printf( "DevcTableFromMap() error: malloc() [%d] columns * [%ld] rows failed!\n", _dt->ncols, _dt->nrows );
+        DevcTableFree( _dt );
+        return -1;
+    }
+
+    // the second pass fills the columns
+    tmp_pos = tmp_data_pos;
+    r = 0;
+    while( MapNextLine(_mf, &tmp_pos, &tmp_line) == 0 )
+    {
+        int c=0, tmp_nseps=0;
+
+        if( SpanIsBlank(tmp_line) )
+            continue;
+        tmp_nseps = SpanSepIndex( tmp_line, s[0], tmp_seps, _dt->ncols );
+        if( tmp_nseps < _dt->ncols-1 )
+        {
+            printf( "DevcTableFromMap() error: only [%d] of [%d] columns in data line [%ld]!\n", tmp_nseps+1, _dt->ncols, r );
+            DevcTableFree( _dt );
+            return -1;
+        }
+        for( c=0; c<_dt->ncols; c++ )
+            _dt->data[c*_dt->nrows + r] = SpanToDouble( SpanField(tmp_line, tmp_seps, tmp_nseps, c) );
+        r++;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: read a sidecar file into a DevcTable if the sidecar is still valid for the csv file
+ * _cache: input parameter indicating the sidecar file name
+ * _csv: input parameter indicating the csv file name
+ * _csv_st: input parameter indicating the stat of the csv file, NULL if the csv file doesn't exist (it is replaced by the sidecar)
+ * _dt: output parameter holding the columns of the csv file, it should be freed by DevcTableFree()
+ * Return: 0: success
+ *         1: the sidecar doesn't exist or is stale
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcTableRead( const char *_cache, const char *_csv, const struct stat *_csv_st, struct DevcTable *_dt )
+{
+    FILE *fp = NULL;
+    struct DevcCacheHead tmp_ch;
+    size_t tmp_n = 0;
+
+    memset( _dt, 0x0, sizeof(struct DevcTable) );
+    memset( &tmp_ch, 0x0, sizeof(tmp_ch) );
+
+    fp = fopen( _cache, "rb" );
+    if( fp == NULL )
+        return 1;
+    if( fread(&tmp_ch, sizeof(tmp_ch), 1, fp) != 1 || memcmp(tmp_ch.magic, DEVCCACHEMAGIC, sizeof(tmp_ch.magic)) != 0
+                                                   || tmp_ch.version != DEVCCACHEVERSION )
+    {
+        printf( "sidecar [%s] is not a valid cache file, rebuild it\n", _cache );
+        fclose( fp );
+        return 1;
+    }
+
+    if( _csv_st != NULL ) // the csv file is still there, make sure the sidecar is made from the same csv
+    {
+        if( tmp_ch.src_size != (long)_csv_st->st_size )
+        {
+            printf( "sidecar [%s] is stale: size [%ld] -> [%ld]\n", _cache, tmp_ch.src_size, (long)_csv_st->st_size );
+            fclose( fp );
+            return 1;
+        }
+        if( tmp_ch.src_mtime != (long)_csv_st->st_mtime ) // the csv is touched or copied, only a changed content makes the sidecar stale
+        {
+            struct MapFile tmp_mf;
+            unsigned long tmp_hash = 0;
+
+            if( MapFileOpen(_csv, &tmp_mf) != 0 )
+            {
+                fclose( fp );
+                return -1;
+            }
+            tmp_hash = HashFNV1a( tmp_mf.data, tmp_mf.size );
+            MapFileClose( &tmp_mf );
+            if( tmp_hash != tmp_ch.src_hash )
+            {
+                printf( "sidecar [%s] is stale: the content of [%s] is changed\n", _cache, _csv );
+                fclose( fp );
+                return 1;
+            }
+        }
+    }
+
+    _dt->ncols = tmp_ch.ncols;
+    _dt->nrows = tmp_ch.nrows;
+    _dt->head_len = tmp_ch.head_len;
+    tmp_n = (size_t)_dt->ncols * (size_t)_dt->nrows;
+    _dt->head = calloc( _dt->head_len+1, 1 );
+    _dt->data = malloc( sizeof(double) * (tmp_n > 0 ? tmp_n : 1) );
+    if( _dt->head == NULL || _dt->data == NULL )
+    {
+        printf( "DevcTableRead() error: memory allocation for [%s] failed!\n", _cache );
+        DevcTableFree( _dt );
+        fclose( fp );
+        return -1;
+    }
+    if( fread(_dt->head, 1, _dt->head_len, fp) != (size_t)_dt->head_len || fread(_dt->data, sizeof(double), tmp_n, fp) != tmp_n )
+    {
+        printf( "sidecar [%s] is truncated, rebuild it\n", _cache );
+        DevcTableFree( _dt );
+        fclose( fp );
+        return 1;
+    }
+    fclose( fp );
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: write a DevcTable to a sidecar file. the content is written to a temporary file first and then renamed to _cache so that a reader
+ *           never sees a half written sidecar
+ * _cache: input parameter indicating the sidecar file name
+ * _dt: input parameter indicating the columns of the csv file
+ * _csv_st: input parameter indicating the stat of the csv file
+ * _csv_hash: input parameter indicating the FNV-1a hash of the csv file
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcTableWrite( const char *_cache, const struct DevcTable *_dt, const struct stat *_csv_st, unsigned long _csv_hash )
+{
+    FILE *fp = NULL;
+    struct DevcCacheHead tmp_ch;
+    char tmp_fn[MAXSTRINGSIZE];
+    size_t tmp_n = (size_t)_dt->ncols * (size_t)_dt->nrows;
+
+    memset( &tmp_ch, 0x0, sizeof(tmp_ch) );
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+
+    memcpy( tmp_ch.magic, DEVCCACHEMAGIC, sizeof(tmp_ch.magic) );
+    tmp_ch.version = DEVCCACHEVERSION;
+    tmp_ch.ncols = _dt->ncols;
+    tmp_ch.nrows = _dt->nrows;
+    tmp_ch.src_size = (long)_csv_st->st_size;
+    tmp_ch.src_mtime = (long)_csv_st->st_mtime;
+    tmp_ch.src_hash = _csv_hash;
+    tmp_ch.head_len = _dt->head_len;
+
+    sprintf( tmp_fn, "%s.tmp", _cache );
+    fp = fopen( tmp_fn, "wb" );
+    if( fp == NULL )
+    {
+        printf( "DevcTableWrite() error: fopen [%s] failed!\n", tmp_fn );
+        return -1;
+    }
+    if( fwrite(&tmp_ch, sizeof(tmp_ch), 1, fp) != 1 || fwrite(_dt->head, 1, _dt->head_len, fp) != (size_t)_dt->head_len
+                                                    || fwrite(_dt->data, sizeof(double), tmp_n, fp) != tmp_n )
+    {
+        printf( "DevcTableWrite() error: fwrite [%s] failed!\n", tmp_fn );
+        fclose( fp );
+        remove( tmp_fn );
+        return -1;
+    }
+    if( fclose(fp) != 0 || rename(tmp_fn, _cache) != 0 )
+    {
+        printf( "DevcTableWrite() error: rename [%s] to [%s] failed!\n", tmp_fn, _cache );
+        remove( tmp_fn );
+        return -1;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * the compressed csv files (*.csv.gz, *.csv.zst) are streamed through the decompressor ("gzip -dc" or "zstd -dc") in chunks of DEVCCHUNKSIZE
+ * bytes, they are never inflated to the disk
+ *************************************************************************************************************************************************/
+#define DEVCCHUNKSIZE 65536
+
+// return the command which decompresses the file _fn to stdout, NULL if _fn is not a compressed file
+const char *DevcDecompressor( const char *_fn )
+{
+    size_t tmp_len = strlen(_fn);
+
+    if( tmp_len > 3 && strcmp(_fn+tmp_len-3, ".gz") == 0 )
+        return "gzip -dc";
+    if( tmp_len > 4 && strcmp(_fn+tmp_len-4, ".zst") == 0 )
+        return "zstd -dc";
+    return NULL;
+}
+
+/*************************************************************************************************************************************************
+ * Function: start the decompressor _cmd on the file _fn and get a pipe reading its output
+ * _fn: input parameter indicating a compressed file name
+ * _cmd: input parameter indicating the decompressor returned by DevcDecompressor()
+ * Return: the pipe, it should be closed by pclose()
+ *         NULL: failure
+ *************************************************************************************************************************************************/
+FILE *DevcPipeOpen( const char *_fn, const char *_cmd )
+{
+    char tmp_cmd[MAXSTRINGSIZE];
+    FILE *fp = NULL;
+
+    memset( tmp_cmd, 0x0, sizeof(tmp_cmd) );
+    if( strchr(_fn, '\'') != NULL || strlen(_fn)+strlen(_cmd)+4 >= sizeof(tmp_cmd) )
+    {
+        printf( "DevcPipeOpen() error: the file name [%s] cannot be passed to [%s]!\n", _fn, _cmd );
+        return NULL;
+    }
+    if( access(_fn, R_OK) != 0 ) // popen() succeeds even if the file doesn't exist
+    {
+        printf( "DevcPipeOpen() error: cannot read [%s]!\n", _fn );
+        return NULL;
+    }
+
+    sprintf( tmp_cmd, "%s '%s'", _cmd, _fn );
+    fp = popen( tmp_cmd, "r" );
+    if( fp == NULL )
+        printf( "DevcPipeOpen() error: popen [%s] failed!\n", tmp_cmd );
+    return fp;
+}
+
+/*************************************************************************************************************************************************
+ * Function: get the next line from the decompressor pipe of a reader. the pipe is read in chunks into _dr->buf, the buffer grows only when a
+ *           single line is longer than it. the line span is valid until the next call
+ * _dr: input/output parameter indicating a reader opened on a compressed file
+ * _line: output parameter holding the line span without the line end
+ * Return: 0: success
+ *         -1: no more lines
+ *************************************************************************************************************************************************/
+int DevcPipeNextLine( struct DevcReader *_dr, struct Span *_line )
+{
+    while( 1 )
+    {
+        char *tmp_start = _dr->buf + _dr->buf_pos;
+        char *tmp_end = memchr( tmp_start, '\n', _dr->buf_len - _dr->buf_pos );
+        size_t tmp_n = 0;
+
+        if( tmp_end != NULL || (_dr->buf_eof == 1 && _dr->buf_pos < _dr->buf_len) )
+        {
+            if( tmp_end == NULL ) // the last line doesn't end with "\n"
+                tmp_end = _dr->buf + _dr->buf_len;
+            _line->head = tmp_start;
+            _line->tail = tmp_end;
+            _dr->buf_pos = (tmp_end < _dr->buf + _dr->buf_len) ? (size_t)(tmp_end - _dr->buf) + 1 : _dr->buf_len;
+            if( _line->tail > _line->head && _line->tail[-1] == '\r' )
+                _line->tail--;
+            return 0;
+        }
+        if( _dr->buf_eof == 1 )
+            return -1;
+
+        // keep the incomplete line at the beginning of the buffer and read the next chunk after it
+        memmove( _dr->buf, tmp_start, _dr->buf_len - _dr->buf_pos );
+        _dr->buf_len -= _dr->buf_pos;
+        _dr->buf_pos = 0;
+        if( _dr->buf_len == _dr->buf_size )
+        {
+            char *tmp_buf = realloc( _dr->buf, _dr->buf_size*2 );
+            if( tmp_buf == NULL )
+            {
+                printf( "DevcPipeNextLine() error: realloc [%lu] bytes failed!\n", (unsigned long)_dr->buf_size*2 );
+                return -1;
+            }
+            _dr->buf = tmp_buf;
+            _dr->buf_size *= 2;
+        }
+        tmp_n = fread( _dr->buf + _dr->buf_len, 1, _dr->buf_size - _dr->buf_len, _dr->pipe );
+        if( tmp_n == 0 )
+            _dr->buf_eof = 1;
+        _dr->buf_len += tmp_n;
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: decompress a whole file into memory, which is used when the columns of a compressed file are cached in its sidecar
+ * _fn: input parameter indicating a compressed file name
+ * _cmd: input parameter indicating the decompressor returned by DevcDecompressor()
+ * _mf: output parameter holding the decompressed content in _mf->data (allocated by malloc(), _mf->fd is -1), it should be freed by free()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcPipeReadAll( const char *_fn, const char *_cmd, struct MapFile *_mf )
+{
+    FILE *fp = NULL;
+    size_t tmp_size = DEVCCHUNKSIZE, tmp_n = 0;
+
+    memset( _mf, 0x0, sizeof(struct MapFile) );
+    _mf->fd = -1;
+    fp = DevcPipeOpen( _fn, _cmd );
+    if( fp == NULL )
+        return -1;
+
+    _mf->data = malloc( tmp_size );
+    while( _mf->data != NULL && (tmp_n = fread(_mf->data + _mf->size, 1, tmp_size - _mf->size, fp)) > 0 )
+    {
+        _mf->size += tmp_n;
+        if( _mf->size == tmp_size )
+        {
+            char *tmp_data = realloc( _mf->data, tmp_size*2 );
+            if( tmp_data == NULL )
+                free( _mf->data );
+            _mf->data = tmp_data;
+            tmp_size *= 2;
+        }
+    }
+    if( pclose(fp) != 0 || _mf->data == NULL )
+    {
+        printf( "DevcPipeReadAll() error: [%s '%s'] failed!\n", _cmd, _fn );
+        free( _mf->data );
+        memset( _mf, 0x0, sizeof(struct MapFile) );
+        return -1;
+    }
+    return 0;
+}
+
+// close a reader opened by DevcOpen()
+void DevcClose( struct DevcReader *_dr )
+{
+    if( _dr->pipe != NULL )
+    {
+        // the decompressor may be stopped by SIGPIPE if not all of its output is read, only a failure after the whole output is a problem
+        if( pclose(_dr->pipe) != 0 && _dr->buf_eof == 1 )
+            printf( "DevcClose() warning: the decompressor exits with error, the compressed csv file may be broken!\n" );
+        free( _dr->buf );
+    }
+    else if( _dr->cached == 0 )
+        MapFileClose( &(_dr->mf) );
+    DevcTableFree( &(_dr->dt) );
+    memset( _dr, 0x0, sizeof(struct DevcReader) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: open a csv file for reading. if DevcCacheMode is 0, the csv file is mapped and its lines are walked in place, or a compressed csv
+ *           file (*.csv.gz, *.csv.zst) is streamed through its decompressor; otherwise the columns come from the sidecar of the csv, which is
+ *           created (and, if DevcCacheMode is 2, replaces the csv) when it doesn't exist or is stale
+ * _csv: input parameter indicating the csv file name
+ * _dr: output parameter holding the reader, _dr->head is the head line of the csv file. it should be closed by DevcClose()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcOpen( const char *_csv, struct DevcReader *_dr )
+{
+    struct Span tmp_line;
+    struct stat tmp_st;
+    char tmp_cache[MAXSTRINGSIZE];
+    unsigned long tmp_hash = 0;
+    int tmp_csv_exists = 0, rt = 0;
+    const char *tmp_cmd = DevcDecompressor( _csv );
+
+    memset( _dr, 0x0, sizeof(struct DevcReader) );
+    memset( tmp_cache, 0x0, sizeof(tmp_cache) );
+
+    if( DevcCacheMode == 0 && tmp_cmd != NULL ) // stream the compressed csv file through the decompressor
+    {
+        _dr->pipe = DevcPipeOpen( _csv, tmp_cmd );
+        _dr->buf_size = DEVCCHUNKSIZE;
+        _dr->buf = malloc( _dr->buf_size );
+        if( _dr->pipe == NULL || _dr->buf == NULL )
+        {
+            DevcClose( _dr );
+            return -1;
+        }
+        // first line of csv file is not used, the second line is the head line which is kept in dt.head since buf is reused
+        if( DevcPipeNextLine(_dr, &tmp_line) != 0 || DevcPipeNextLine(_dr, &tmp_line) != 0 )
+        {
+            printf( "no head line in csv [%s] !\n", _csv );
+            DevcClose( _dr );
+            return -1;
+        }
+        _dr->dt.head_len = tmp_line.tail - tmp_line.head;
+        _dr->dt.head = calloc( _dr->dt.head_len+1, 1 );
+        if( _dr->dt.head == NULL )
+        {
+            printf( "DevcOpen() error: calloc() head failed!\n" );
+            DevcClose( _dr );
+            return -1;
+        }
+        memcpy( _dr->dt.head, tmp_line.head, _dr->dt.head_len );
+        _dr->head.head = _dr->dt.head;
+        _dr->head.tail = _dr->dt.head + _dr->dt.head_len;
+        return 0;
+    }
+
+    if( DevcCacheMode == 0 )
+    {
+        if( MapFileOpen(_csv, &(_dr->mf)) != 0 )
+            return -1;
+        // first line of csv file is not used, the second line is the head line
+        if( MapNextLine(&(_dr->mf), &(_dr->pos), &tmp_line) != 0 || MapNextLine(&(_dr->mf), &(_dr->pos), &tmp_line) != 0 )
+        {
+            printf( "no head line in csv [%s] !\n", _csv );
+            MapFileClose( &(_dr->mf) );
+            return -1;
+        }
+        _dr->head = tmp_line;
+        return 0;
+    }
+
+    sprintf( tmp_cache, "%s%s", _csv, DEVCCACHESUFFIX );
+    tmp_csv_exists = (stat(_csv, &tmp_st) == 0);
+    rt = DevcTableRead( tmp_cache, _csv, tmp_csv_exists ? &tmp_st : NULL, &(_dr->dt) );
+    if( rt == -1 )
+        return -1;
+    if( rt == 1 ) // build the sidecar from the csv file
+    {
+        if( tmp_csv_exists == 0 )
+        {
+            printf( "DevcOpen() error: neither [%s] nor a valid [%s] exists!\n", _csv, tmp_cache );
+            return -1;
+        }
+        if( tmp_cmd != NULL ) // the compressed csv file is decompressed into memory to build the columns
+        {
+            if( DevcPipeReadAll(_csv, tmp_cmd, &(_dr->mf)) != 0 )
+                return -1;
+            rt = DevcTableFromMap( &(_dr->mf), &(_dr->dt) );
+            free( _dr->mf.data );
+            memset( &(_dr->mf), 0x0, sizeof(struct MapFile) );
+            if( rt != 0 )
+            {
+                printf( "DevcTableFromMap() error: csv=[%s]\n", _csv );
+                return -1;
+            }
+        }
+        if( MapFileOpen(_csv, &(_dr->mf)) != 0 ) // the hash is always made from the file on the disk, compressed or not
+        {
+            DevcTableFree( &(_dr->dt) );
+            return -1;
+        }
+        if( tmp_cmd == NULL && DevcTableFromMap(&(_dr->mf), &(_dr->dt)) != 0 )
+        {
+            printf( "DevcTableFromMap() error: csv=[%s]\n", _csv );
+            MapFileClose( &(_dr->mf) );
+            return -1;
+        }
+        tmp_hash = HashFNV1a( _dr->mf.data, _dr->mf.size );
+        MapFileClose( &(_dr->mf) );
+
+        if( DevcTableWrite(tmp_cache, &(_dr->dt), &tmp_st, tmp_hash) != 0 )
+        {
+            printf( "the sidecar [%s] cannot be written, [%s] will be parsed again next time\n", tmp_cache, _csv ); // not fatal
+            tmp_csv_exists = 0; // never remove a csv file without a sidecar
+        }
+    }
+
+    if( DevcCacheMode == 2 && tmp_csv_exists == 1 ) // the sidecar is valid, it replaces the csv file
+    {
+        if( remove(_csv) != 0 )
+            printf( "remove [%s] failed, it is kept along with [%s]\n", _csv, tmp_cache );
+        else
+            printf( "[%s] is replaced by [%s]\n", _csv, tmp_cache );
+    }
+
+    _dr->cached = 1;
+    _dr->head.head = _dr->dt.head;
+    _dr->head.tail = _dr->dt.head + _dr->dt.head_len;
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: set the columns returned by DevcNextRow() for a reader opened by DevcOpen(). the columns are compiled into a projection once, so
+ *           that the data lines of a csv file are converted only for the needed columns
+ * _dr: input/output parameter indicating the reader
+ * _columns: input parameter indicating the positions of the variables in the headline of a CSV file, in any order and may be repeated
+ * _n: input parameter indicating the length of _columns
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcProject( struct DevcReader *_dr, const int *_columns, const int _n )
+{
+    int i=0;
+
+    if( _dr->cached == 1 )
+    {
+        for( i=0; i<_n; i++ )
+        {
+            if( _columns[i] < 0 || _columns[i] >= _dr->dt.ncols )
+            {
+                printf( "DevcProject() error: column [%d] is out of [0, %d)\n", _columns[i], _dr->dt.ncols );
+                return -1;
+            }
+        }
+    }
+    return SpanProject( _columns, _n, &(_dr->pj) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: get the values of the columns set by DevcProject() of the next data line from a reader opened by DevcOpen(). the empty lines are
+ *           skipped
+ * _dr: input/output parameter indicating the reader
+ * _return_d: output parameter indicating the values of the columns in the data line, in the order given to DevcProject()
+ * Return: 0: success
+ *         1: no more data lines
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcNextRow( struct DevcReader *_dr, double *_return_d )
+{
+    int i=0;
+
+    if( _dr->cached == 0 )
+    {
+        struct Span tmp_line;
+
+        do
+        {
+            if( (_dr->pipe != NULL ? DevcPipeNextLine(_dr, &tmp_line) : MapNextLine(&(_dr->mf), &(_dr->pos), &tmp_line)) != 0 )
+                return 1;
+        }while( SpanIsBlank(tmp_line) ); // skip the empty line at the end of the file
+        return SpanProjectValues( tmp_line, &(_dr->pj), s[0], _return_d );
+    }
+
+    if( _dr->row >= _dr->dt.nrows )
+        return 1;
+    for( i=0; i<_dr->pj.n; i++ )
+        _return_d[i] = _dr->dt.data[_dr->pj.columns[i]*_dr->dt.nrows + _dr->row];
+    _dr->row++;
+    return 0;
+}
+
+#if FPMAVX2
+// the AVX2 part of FirstCrossing(): scan 4 values at a time from row *_r on, return the first row meeting _CV, or -1 with *_r left at the rest
+FPMAVX2TARGET long FirstCrossingAVX2( const double *_col, long _n, double _CV, int _direction, long *_r )
+{
+    __m256d tmp_cv = _mm256_set1_pd( _CV );
+    long r = *_r;
+
+    for( ; r+4 <= _n; r+=4 )
+    {
+        __m256d tmp_v = _mm256_loadu_pd( _col+r );
+        int tmp_mask = _mm256_movemask_pd( _direction == 1 ? _mm256_cmp_pd(tmp_v, tmp_cv, _CMP_GT_OQ) : _mm256_cmp_pd(tmp_v, tmp_cv, _CMP_LT_OQ) );
+        if( tmp_mask != 0 )
+            return r + __builtin_ctz(tmp_mask);
+    }
+    *_r = r;
+    return -1;
+}
+
+// the AVX2 part of CalMidVals(): interpolate 4 values at a time, return the number of values done
+FPMAVX2TARGET int CalMidValsAVX2( const double *_NV_1, const double *_NV_2, const double *_VV_1, const double *_VV_2, const double *_CV, int _n, double *_return_d )
+{
+    int i=0;
+
+    for( ; i+4 <= _n; i+=4 )
+    {
+        __m256d tmp_nv_1 = _mm256_loadu_pd( _NV_1+i );
+        __m256d tmp_vv_1 = _mm256_loadu_pd( _VV_1+i );
+        __m256d tmp_d = _mm256_div_pd( _mm256_mul_pd(_mm256_sub_pd(tmp_nv_1, _mm256_loadu_pd(_NV_2+i)), _mm256_sub_pd(tmp_vv_1, _mm256_loadu_pd(_CV+i))),
+                                       _mm256_sub_pd(tmp_vv_1, _mm256_loadu_pd(_VV_2+i)) );
+        _mm256_storeu_pd( _return_d+i, _mm256_sub_pd(tmp_nv_1, tmp_d) );
+    }
+    return i;
+}
+#endif
+
+/*************************************************************************************************************************************************
+ * Function: find the first row of a column where the critical value is met, namely the first _col[r] > _CV (_direction == 1) or the first
+ *           _col[r] < _CV (_direction == -1). the column is scanned 4 (AVX2, see FPMAVX2) or 2 (SSE2) values at a time, the rest of
+ *           the column is scanned one by one
+ * _col: input parameter indicating the values of a column saved continuously
+ * _n: input parameter indicating the length of _col
+ * _CV: input parameter indicating the critical value
+ * _direction: input parameter indicating the direction, 1: the variable increases with time, -1: the variable decreases with time
+ * Return: the first row meeting the critical value
+ *         -1: the critical value is not met
+ *************************************************************************************************************************************************/
+long FirstCrossing( const double *_col, long _n, double _CV, int _direction )
+{
+    long r=0;
+
+    if( _direction != 1 && _direction != -1 ) // same as FeedOutCross(), no other direction can meet the critical value
+        return -1;
+
+#if FPMAVX2
+    if( FPMHasAVX2() )
+    {
+        long tmp_row = FirstCrossingAVX2( _col, _n, _CV, _direction, &r );
+        if( tmp_row != -1 )
+            return tmp_row;
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        __m128d tmp_cv = _mm_set1_pd( _CV );
+        for( ; r+2 <= _n; r+=2 )
+        {
+            __m128d tmp_v = _mm_loadu_pd( _col+r );
+            int tmp_mask = _mm_movemask_pd( _direction == 1 ? _mm_cmpgt_pd(tmp_v, tmp_cv) : _mm_cmplt_pd(tmp_v, tmp_cv) );
+            if( tmp_mask != 0 )
+                return r + __builtin_ctz(tmp_mask);
+        }
+    }
+#endif
+
+    for( ; r<_n; r++ ) // the rest of the column, or the whole column when there is no SIMD support
+    {
+        if( (_direction == 1 && _col[r] > _CV) || (_direction == -1 && _col[r] < _CV) )
+            return r;
+    }
+    return -1;
+}
+
+/*************************************************************************************************************************************************
+ * Function: the batched version of CalMidVal(), _return_d[i] = CalMidVal(_NV_1[i], _NV_2[i], _VV_1[i], _VV_2[i], _CV[i]) for i in [0, _n)
+ * _NV_1, _NV_2, _VV_1, _VV_2, _CV: input parameters, see CalMidVal()
+ * _n: input parameter indicating the length of the arrays
+ * _return_d: output parameter holding the interpolation values
+ * Return: void
+ *************************************************************************************************************************************************/
+void CalMidVals( const double *_NV_1, const double *_NV_2, const double *_VV_1, const double *_VV_2, const double *_CV, int _n, double *_return_d )
+{
+    int i=0;
+
+#if FPMAVX2
+    if( FPMHasAVX2() )
+        i = CalMidValsAVX2( _NV_1, _NV_2, _VV_1, _VV_2, _CV, _n, _return_d );
+#endif
+#if defined(__SSE2__)
+    for( ; i+2 <= _n; i+=2 )
+    {
+        __m128d tmp_nv_1 = _mm_loadu_pd( _NV_1+i );
+        __m128d tmp_vv_1 = _mm_loadu_pd( _VV_1+i );
+        __m128d tmp_d = _mm_div_pd( _mm_mul_pd(_mm_sub_pd(tmp_nv_1, _mm_loadu_pd(_NV_2+i)), _mm_sub_pd(tmp_vv_1, _mm_loadu_pd(_CV+i))),
+                                    _mm_sub_pd(tmp_vv_1, _mm_loadu_pd(_VV_2+i)) );
+        _mm_storeu_pd( _return_d+i, _mm_sub_pd(tmp_nv_1, tmp_d) );
+    }
+#endif
+
+    for( ; i<_n; i++ )
+        _return_d[i] = CalMidVal( _NV_1[i], _NV_2[i], _VV_1[i], _VV_2[i], _CV[i] );
+}
+
+/*************************************************************************************************************************************************
+ * Function: search the critical values of many OutCross structures at one time over the columns of a reader opened by DevcOpen(). this is
+ *           the column version of feeding every data line to FeedOutCross(): each output column is scanned by FirstCrossing() and all the
+ *           interpolations are done by one call of CalMidVals()
+ * _dr: input parameter indicating the reader
+ * _oc: input/output parameter indicating the OutCross structures initialized by InitOutCross()
+ * _n: input parameter indicating the length of _oc
+ * Return: 0: success, the results are in _oc
+ *         1: the reader has no columns (the csv file is walked line by line), the caller should feed the data lines to FeedOutCross()
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcCrossAll( struct DevcReader *_dr, struct OutCross *_oc, int _n )
+{
+    double tmp_NV_1[MAXOUTPUTSNUM], tmp_NV_2[MAXOUTPUTSNUM], tmp_VV_1[MAXOUTPUTSNUM], tmp_VV_2[MAXOUTPUTSNUM], tmp_CV[MAXOUTPUTSNUM];
+    double tmp_result[MAXOUTPUTSNUM];
+    int tmp_pos[MAXOUTPUTSNUM]; // the positions in _oc needing interpolation
+    int i=0,m=0;
+    long tmp_nrows = _dr->dt.nrows;
+
+    if( _dr->cached == 0 )
+        return 1;
+    if( _n > MAXOUTPUTSNUM )
+    {
+        printf( "DevcCrossAll() error: too many outputs [%d], MAXOUTPUTSNUM=[%d]\n", _n, MAXOUTPUTSNUM );
+        return -1;
+    }
+
+    for( i=0; i<_n; i++ )
+    {
+        const double *tmp_col = NULL, *tmp_col_TN = NULL;
+        long r=0;
+
+        if( _oc[i].column < 0 || _oc[i].column >= _dr->dt.ncols || _oc[i].column_TN < 0 || _oc[i].column_TN >= _dr->dt.ncols )
+        {
+            printf( "DevcCrossAll() error: column [%d] or [%d] is out of [0, %d)\n", _oc[i].column, _oc[i].column_TN, _dr->dt.ncols );
+            return -1;
+        }
+        tmp_col = _dr->dt.data + (long)_oc[i].column * tmp_nrows;
+        tmp_col_TN = _dr->dt.data + (long)_oc[i].column_TN * tmp_nrows;
+
+        r = FirstCrossing( tmp_col, tmp_nrows, _oc[i].CV, _oc[i].direction );
+        if( r == -1 )
+        {
+            _oc[i].met = 0;
+            _oc[i].rows = tmp_nrows;
+            continue;
+        }
+        _oc[i].met = 1;
+        _oc[i].rows = r+1;
+        if( r == 0 ) // the first line may be what we need, although the possibility is very very low
+        {
+            _oc[i].VV_1 = tmp_col[0]; // as FeedOutCross() leaves it
+            _oc[i].NV_1 = tmp_col_TN[0];
+            _oc[i].result = tmp_col_TN[0];
+            continue;
+        }
+        tmp_NV_1[m] = tmp_col_TN[r-1];
+        tmp_NV_2[m] = tmp_col_TN[r];
+        tmp_VV_1[m] = tmp_col[r-1];
+        tmp_VV_2[m] = tmp_col[r];
+        tmp_CV[m] = _oc[i].CV;
+        tmp_pos[m] = i;
+        m++;
+    }
+
+    if( m == 0 ) // no crossing to interpolate
+        return 0;
+    CalMidVals( tmp_NV_1, tmp_NV_2, tmp_VV_1, tmp_VV_2, tmp_CV, m, tmp_result );
+    for( i=0; i<m; i++ )
+        _oc[tmp_pos[i]].result = tmp_result[i];
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: decide how a file found in a directory should be processed with regard to the sidecar files. a sidecar (*.csv.fpmc) is processed
+ *           as its csv file only if the csv file has been replaced by it (DevcCacheMode == 2 in a former run) and the sidecars are in use
+ * _fn: input/output parameter indicating a file name, DEVCCACHESUFFIX is removed from it if it is a sidecar standing for its csv file
+ * Return: 0: process _fn
+ *         1: skip _fn, it is a sidecar whose csv file is still there, or the sidecars are not in use
+ *************************************************************************************************************************************************/
+int DevcResolveName( char *_fn )
+{
+    size_t tmp_len = strlen(_fn);
+    size_t tmp_suffix_len = strlen(DEVCCACHESUFFIX);
+
+    if( strstr(_fn, DEVCCACHESUFFIX) == NULL )
+        return 0;
+    if( tmp_len <= tmp_suffix_len || strcmp(_fn+tmp_len-tmp_suffix_len, DEVCCACHESUFFIX) != 0 ) // a temporary file left by DevcTableWrite()
+        return 1;
 
-         printf( "in while 4,buff_1=[%s]!\n", buff_1); 
+    _fn[tmp_len-tmp_suffix_len] = '\0';
+    if( access(_fn, F_OK) == 0 )
+        return 1;
+    if( DevcCacheMode == 0 )
+    {
+        printf( "[%s] only exists as a sidecar, use the option -c to read it\n", _fn );
+        return 1;
+    }
+    return 0;
+}
 
-         flag = 1;
+/*************************************************************************************************************************************************
+ * the tail reader of a growing csv file (an FDS run still writing its *_devc.csv): the bytes after the last read offset are read on demand and
+ * only the complete lines are returned, a partially written last line stays in the buffer until its "\n" arrives. if the file is truncated or
+ * replaced (the run is restarted), the reader starts again from the beginning of the new file
+ *************************************************************************************************************************************************/
+struct DevcTail
+{
+    char csv[MAXSTRINGSIZE]; // the csv file name
+    int fd;                  // the opened csv file, -1 if it is not opened
+    ino_t ino;               // the inode of the opened csv file
+    off_t offset;            // the offset of the next byte to be read from the csv file
+    char *buf;               // the bytes read but not returned yet
+    size_t buf_size;         // the size of buf
+    size_t buf_len;          // the length of the data in buf
+    size_t buf_pos;          // the offset of the next line in buf
+    long lines;              // the number of the complete lines returned since the beginning of the file
+};
+
+/*************************************************************************************************************************************************
+ * Function: set up the tail reader of a csv file, the file is opened by the first DevcTailNextLine() so that it may not exist yet
+ * _csv: input parameter indicating the csv file name
+ * _t: output parameter holding the reader, it should be closed by DevcTailClose()
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcTailOpen( const char *_csv, struct DevcTail *_t )
+{
+    memset( _t, 0x0, sizeof(struct DevcTail) );
+    _t->fd = -1;
+    snprintf( _t->csv, sizeof(_t->csv), "%s", _csv );
+    _t->buf_size = DEVCCHUNKSIZE;
+    _t->buf = malloc( _t->buf_size );
+    if( _t->buf == NULL )
+    {
+        printf( "DevcTailOpen() error: malloc [%lu] bytes failed!\n", (unsigned long)_t->buf_size );
+        return -1;
+    }
+    return 0;
+}
 
-         column = getColumnPos(buff_1, _single_si.FileVarName,s); // seek the column position of critical output variable in buff_1
-         if( column == -1 )
-         {
-             printf("output variable [%s] not found in [%s]!\n", _single_si.FileVarName, buff_1 );
-             fclose(fp);
-             return -1;
-         }
-         column_TN = getColumnPos(buff_1, _single_si.TargetName,s);// seek the column position of target variable in buff_1 
-         if( column_TN == -1 )
-         {
-             printf("output variable [%s] not found in [%s]!\n", _single_si.TargetName, buff_1 );
-             fclose(fp);
-             return -1;
-         }
+// close the tail reader of a csv file
+void DevcTailClose( struct DevcTail *_t )
+{
+    if( _t->fd >= 0 )
+        close( _t->fd );
+    free( _t->buf );
+    _t->fd = -1;
+    _t->buf = NULL;
+}
 
-           fgets(buff_1,sizeof(buff_1),fp);
-           if( getValueByCol(buff_1, column,s,&tmp_first_value) != 0 ) // the the first value of the critical output variable
-           {
-               printf("getValueByCol() error, buff_1 = [%s], column = [%d], sep=[%s]!\n", buff_1, column, s );
-               fclose(fp);
-               return -1;
-           }
-           if( getValueByCol(buff_1, column_TN, s, &tmp_first_NV) != 0 ) // the the first value of the target variable
-           {
-               printf("getValueByCol() error, buff_1 = [%s], column = [1], sep=[%s]!\n", buff_1, s );
-               fclose(fp);
-               return -1;
-           }
-           // tmp_first_direction =1 means the critical variable should increase with time, otherwise it should decrease with time
-           if( (tmp_first_direction == 1 && tmp_first_value > tmp_first_CV )|| ( tmp_first_direction == -1 && tmp_first_value < tmp_first_CV ))
-           {
-               *_return_d = tmp_first_value;
-               fclose(fp);
-               return 0;
-           }
-           do
-           { // find the basevalue in the following line
-              int tmp_direction = tmp_first_direction;
-              double tmp_value_1 = tmp_first_value;
-              double tmp_value_2 = 0.0;
-              double tmp_CV= tmp_first_CV;
-              double tmp_NV_1=tmp_first_NV;
-              double tmp_NV_2=0.0;
-
-              fgets(buff_2,sizeof(buff_2),fp);
-              if( getValueByCol(buff_2, column, s, &tmp_value_2) != 0 )// the the second value of the critical output variable 
-              {
-                  printf("getValueByCol() error, buff_1 = [%s], column = [%d], sep=[%s]!\n", buff_2, column, s );
-                  fclose(fp);
-                  return -1;
-              }
+/*************************************************************************************************************************************************
+ * Function: get the next complete line of a growing csv file
+ * _t: input/output parameter indicating the reader
+ * _line: output parameter indicating the line without "\n" (and "\r"), it is valid until the next call
+ * Return: 0: success
+ *         1: no complete line for now, call again when the file grows
+ *         2: the file is truncated or replaced, the reader starts again from the beginning of the file and the former lines are void
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int DevcTailNextLine( struct DevcTail *_t, struct Span *_line )
+{
+    struct stat tmp_st;
+    ssize_t tmp_n = 0;
 
-              if( getValueByCol(buff_2, column_TN, s, &tmp_NV_2) != 0 )// the the second value of the target output variable 
-              {
-                  printf("getValueByCol() error, buff_1 = [%s], column = [%d], sep=[%s]!\n", buff_2, column_TN, s );
-                  fclose(fp);
-                  return -1;
-              }
+    if( _t->fd >= 0 && (stat(_t->csv, &tmp_st) != 0 || tmp_st.st_ino != _t->ino || tmp_st.st_size < _t->offset) ) // restarted run
+    {
+        close( _t->fd );
+        _t->fd = -1;
+        _t->offset = 0;
+        _t->buf_len = 0;
+        _t->buf_pos = 0;
+        if( _t->lines > 0 )
+        {
+            _t->lines = 0;
+            return 2;
+        }
+    }
+    if( _t->fd < 0 )
+    {
+        _t->fd = open( _t->csv, O_RDONLY );
+        if( _t->fd < 0 || fstat(_t->fd, &tmp_st) != 0 )
+        {
+            if( _t->fd >= 0 )
+                close( _t->fd );
+            _t->fd = -1;
+            return 1; // not created yet, or removed for a moment
+        }
+        _t->ino = tmp_st.st_ino;
+    }
 
-              //printf( "1. in do-while before return, direction =[%d], tmp_value_1=[%lf], tmp_value_2=[%lf],tmp_NV_1=[%lf],tmp_NV_2=[%lf],tmp_CV=[%lf],*_return_d=[%lf]\n", tmp_direction, tmp_value_1, tmp_value_2, tmp_NV_1, tmp_NV_2, tmp_CV,*_return_d);
-              if((tmp_direction == 1 && tmp_value_2 > tmp_CV )||
-                     ( tmp_direction == -1 && tmp_value_2 < tmp_CV ))
-              {
-                     *_return_d  = CalMidVal(tmp_NV_1, tmp_NV_2, tmp_value_1, tmp_value_2, tmp_CV);
-              printf( "2. in do-while before return, direction =[%d], tmp_value_1=[%lf], tmp_value_2=[%lf],tmp_NV_1=[%lf],tmp_NV_2=[%lf],tmp_CV=[%lf],*_return_d=[%lf]\n", tmp_direction, tmp_value_1, tmp_value_2, tmp_NV_1, tmp_NV_2, tmp_CV,*_return_d);
-                     fclose(fp);
-                     return 0;
-              }
+    while( 1 )
+    {
+        char *tmp_start = _t->buf + _t->buf_pos;
+        char *tmp_end = memchr( tmp_start, '\n', _t->buf_len - _t->buf_pos );
+
+        if( tmp_end != NULL )
+        {
+            _line->head = tmp_start;
+            _line->tail = tmp_end;
+            _t->buf_pos = (size_t)(tmp_end - _t->buf) + 1;
+            if( _line->tail > _line->head && _line->tail[-1] == '\r' )
+                _line->tail--;
+            _t->lines++;
+            return 0;
+        }
+
+        // keep the incomplete line at the beginning of the buffer and read the new bytes after it
+        memmove( _t->buf, tmp_start, _t->buf_len - _t->buf_pos );
+        _t->buf_len -= _t->buf_pos;
+        _t->buf_pos = 0;
+        if( _t->buf_len == _t->buf_size )
+        {
+            char *tmp_buf = realloc( _t->buf, _t->buf_size*2 );
+            if( tmp_buf == NULL )
+            {
+                printf( "DevcTailNextLine() error: realloc [%lu] bytes failed!\n", (unsigned long)_t->buf_size*2 );
+                return -1;
+            }
+            _t->buf = tmp_buf;
+            _t->buf_size *= 2;
+        }
+        tmp_n = pread( _t->fd, _t->buf + _t->buf_len, _t->buf_size - _t->buf_len, _t->offset );
+        if( tmp_n < 0 )
+        {
+            printf( "DevcTailNextLine() error: read [%s] failed!\n", _t->csv );
+            return -1;
+        }
+        if( tmp_n == 0 )
+            return 1;
+        _t->buf_len += tmp_n;
+        _t->offset += tmp_n;
+    }
+}
+
+/*************************************************************************************************************************************************
+ * the output base values: the baseline results never change within a run, so the critical values of all the output records are searched in the
+ * csv files of the baseline case only once at startup (GenBaseOutputs()), and getOutputBaseValue() just looks the value up in FDS_BaseOutputs
+ *************************************************************************************************************************************************/
+struct BaseOutput
+{
+    int si_index;     // the position of the output record in the configuration file
+    int claimed;      // 1: a baseline csv file including the output variable is found
+    int status;       // 0: the critical value is met, -1: not met or the csv file is not valid for this output record
+    double value;     // the output base value
+};
+
+struct BaseOutput FDS_BaseOutputs[MAXOUTPUTSNUM];
+int BaseOutputsNum = -1; // -1 means GenBaseOutputs() has not been called yet
+const struct SMInfo *BaseOutputsSi = NULL; // the configuration the FDS_BaseOutputs are generated with
+
+// return 1 if the two output records _a and _b have the same output base value, namely they are the same output, otherwise return 0
+int IsSameOutput( const struct SMInfo *_a, const struct SMInfo *_b )
+{
+    return strcmp(_a->Alias, _b->Alias) == 0 && strcmp(_a->FileVarName, _b->FileVarName) == 0 && strcmp(_a->TargetName, _b->TargetName) == 0
+           && strcmp(_a->CriticalValue, _b->CriticalValue) == 0 && strcmp(_a->Divisions, _b->Divisions) == 0;
+}
+
+/************************************************************************************************************************************************* 
+ * Function: calculate the output base values of all the output records in _si and save them to FDS_BaseOutputs
+ *     Flowchat: 
+ *	1. collect the distinct output records ('O' type) in _si, the repeated records of one output share one FDS_BaseOutputs element
+ *	2. for each devc.csv or evac.csv in ./base, the output records whose output variable (on which the critical value is set) exists in the
+ *	   head line of the csv file and which are not claimed by a former csv file are claimed by this csv file
+ *	3. the csv file is read only once for all the output records it claims: each data line is fed to one OutCross structure per output record
+ *	   (FeedOutCross()) and the reading stops when all the critical values are met
+ *	4. an output record whose critical value cannot be met keeps status -1 and getOutputBaseValue() fails on it, as it did when the base
+ *	   value was searched on every call
+ *
+ * _base_fn: input parameter indicating the name of the baseline FDS file
+ * _si: input parameter indicating the content of the configuration file
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int GenBaseOutputs( const char * _base_fn, const struct SMInfo *_si )
+{
+    DIR *tmp_dir = NULL;
+    struct dirent *en = NULL;
+    char tmp_base_dir[MAXSTRINGSIZE];
+    int i=0,j=0,n=0;
+    int tmp_mode = DevcCacheMode; // restored before returning
+
+    memset( tmp_base_dir, 0x0, sizeof(tmp_base_dir) );
+    memset( FDS_BaseOutputs, 0x0, sizeof(FDS_BaseOutputs) );
+    BaseOutputsNum = -1;
+    BaseOutputsSi = _si;
+
+    for( i=0; i<MAXLINENUM; i++ )
+    {
+        int flag = 0;
+
+        if( strlen(_si[i].VarType) == 0 )
+            break;
+        if( _si[i].VarType[0] != 'O' ) //only the Output part of the configuration file is addressed
+            continue;
+        for( j=0; j<n; j++ )
+        {
+            if( IsSameOutput(&(_si[FDS_BaseOutputs[j].si_index]), &(_si[i])) )
+            {
+                flag = 1; // the output is already in the list
+                break;
+            }
+        }
+        if( flag == 1 )
+            continue;
+        if( n == MAXOUTPUTSNUM )
+        {
+            printf( "too many output records: MAXOUTPUTSNUM=[%d], _si[%d].Alias=[%s]\n", MAXOUTPUTSNUM, i, _si[i].Alias );
+            return -1;
+        }
+        FDS_BaseOutputs[n].si_index = i;
+        FDS_BaseOutputs[n].status = -1;
+        n++;
+    }
+
+    if (getcwd(tmp_base_dir, sizeof(tmp_base_dir)) == NULL) {
+        perror("getcwd() error");
+        return -1;
+    }
+    strcat( tmp_base_dir, "/base" );
+
+    tmp_dir = opendir(tmp_base_dir);
+    if( tmp_dir == NULL )
+    {
+        printf( "opendir error: [%s]\n", tmp_base_dir );
+        return -1;
+    }
+
+    printf("Current working dir in GenBaseOutputs(): %s, base file = [%s]\n", tmp_base_dir, _base_fn);
+
+    while ((en = readdir(tmp_dir)) != NULL)
+    {
+        struct DevcReader tmp_dr;
+        struct OutCross tmp_oc[MAXOUTPUTSNUM];
+        int tmp_columns[2*MAXOUTPUTSNUM]; // tmp_columns[2*k] is the column of the output variable, tmp_columns[2*k+1] is the column of the target variable
+        double tmp_values[2*MAXOUTPUTSNUM];
+        int tmp_claims[MAXOUTPUTSNUM]; // the positions in FDS_BaseOutputs claimed by this csv file
+        char tmp_whole_fn[MAXSTRINGSIZE];
+        int k=0,m=0,left=0,rt=0;
+
+        memset( tmp_whole_fn, 0x0, sizeof(tmp_whole_fn));
+
+        if( strstr( en->d_name, ".csv" ) == NULL || (strstr(en->d_name,"devc") == NULL 
+                                                 && strstr(en->d_name, "evac")== NULL ) )
+            continue;
+
+        sprintf(tmp_whole_fn, "%s/%s", tmp_base_dir, en->d_name ); 
+        // the baseline csv files are also read by FirePM, which doesn't use the sidecars, so they are never replaced by their sidecars
+        // (DevcCacheMode 2 is taken as 1 here), and a sidecar left alone by a former DoA -a is read even if the sidecars are not in use
+        DevcCacheMode = 1;
+        rt = DevcResolveName(tmp_whole_fn);
+        DevcCacheMode = (tmp_mode == 0 && access(tmp_whole_fn, F_OK) == 0) ? 0 : 1;
+        if( rt != 0 ) // a sidecar whose csv file is processed instead
+            continue;
+        if( DevcOpen(tmp_whole_fn, &tmp_dr) != 0 )
+        {
+            printf( "open file [%s]failed!\n",tmp_whole_fn);
+            closedir( tmp_dir );
+            DevcCacheMode = tmp_mode;
+            return -1;
+        }
+
+        for( j=0; j<n; j++ ) // claim the output records whose output variable is in this csv file
+        {
+            const struct SMInfo *tmp_si = &(_si[FDS_BaseOutputs[j].si_index]);
+            int column=0, column_TN=0;
+
+            if( FDS_BaseOutputs[j].claimed == 1 || SpanHasStr(tmp_dr.head, tmp_si->FileVarName) == 0 )
+                continue;
+            FDS_BaseOutputs[j].claimed = 1;
+
+            column = SpanColumnPos(tmp_dr.head, tmp_si->FileVarName, s[0]); // seek the column position of critical output variable in the headline
+            column_TN = SpanColumnPos(tmp_dr.head, tmp_si->TargetName, s[0]);// seek the column position of target variable in the headline
+            if( column == -1 || column_TN == -1 )
+            {
+                printf("output variable [%s] or target variable [%s] not found in [%s]!\n", tmp_si->FileVarName, tmp_si->TargetName, tmp_whole_fn );
+                continue;
+            }
+            InitOutCross( &(tmp_oc[m]), tmp_si, FDS_BaseOutputs[j].si_index, column, column_TN );
+            tmp_columns[2*m] = column;
+            tmp_columns[2*m+1] = column_TN;
+            tmp_claims[m] = j;
+            m++;
+        }
+
+        if( (rt=DevcCrossAll(&tmp_dr, tmp_oc, m)) == 1 && (rt=DevcProject(&tmp_dr, tmp_columns, 2*m)) == 0 ) // no columns from a sidecar, walk the data lines
+        {
+            left = m;
+            while( left > 0 && (rt=DevcNextRow(&tmp_dr, tmp_values)) == 0 )
+            {
+                for( k=0; k<m; k++ )
+                    left -= FeedOutCross( &(tmp_oc[k]), tmp_values[2*k], tmp_values[2*k+1] );
+            }
+        }
+        DevcClose( &tmp_dr );
+        if( rt == -1 )
+        {
+            printf("DevcNextRow() error, file = [%s]!\n", tmp_whole_fn );
+            closedir( tmp_dir );
+            DevcCacheMode = tmp_mode;
+            return -1;
+        }
+
+        for( k=0; k<m; k++ )
+        {
+            struct BaseOutput *tmp_bo = &(FDS_BaseOutputs[tmp_claims[k]]);
+
+            if( tmp_oc[k].met == 0 )
+            {
+                printf( "critical value [%s] cannot be met in csv [%s] !\n", _si[tmp_bo->si_index].CriticalValue, tmp_whole_fn );
+                continue;
+            }
+            // when the first line already meets the critical value, the base value is the value of the output variable in that line, not
+            // the value of the target variable, as getOutputBaseValue() did before FDS_BaseOutputs
+            if( tmp_oc[k].rows == 1 )
+                tmp_bo->value = tmp_oc[k].VV_1;
+            else
+                tmp_bo->value = tmp_oc[k].result;
+            tmp_bo->status = 0;
+            printf( "base value of [%s] in [%s]: CV=[%lf], rows=[%ld], value=[%lf]\n", _si[tmp_bo->si_index].Alias, tmp_whole_fn, tmp_oc[k].CV, tmp_oc[k].rows, tmp_bo->value );
+        }
+    }
+    closedir( tmp_dir );
+    DevcCacheMode = tmp_mode;
+
+    BaseOutputsNum = n;
+    return 0;
+}
 
-              tmp_first_value = tmp_value_2; // marching forward the two values
-              tmp_first_NV= tmp_NV_2; // marching forward the two values
-           }while((getc(fp))!=EOF);
+/************************************************************************************************************************************************* 
+ * Function: get the output base value correspoding to the output information in _single_si from FDS_BaseOutputs, which is generated by
+ *           GenBaseOutputs() at startup. the baseline csv files are not read again here
+ * _base_fn: input parameter indicating the name of the baseline FDS file
+ * _single_si: input parameter indicating the output variable information
+ * _return_d: output parameter indicating an output base value found in the csv file of the baseline fds simulation
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int getOutputBaseValue( const char * _base_fn, const struct SMInfo _single_si, double * _return_d )
+{
+    int i=0;
+
+    if( BaseOutputsNum == -1 )
+    {
+        printf( "getOutputBaseValue() error: the output base values of [%s] are not generated, call GenBaseOutputs() first!\n", _base_fn );
+        return -1;
+    }
+
+    for( i=0; i<BaseOutputsNum; i++ )
+    {
+        if( IsSameOutput(&(BaseOutputsSi[FDS_BaseOutputs[i].si_index]), &_single_si) == 0 )
+            continue;
+        if( FDS_BaseOutputs[i].status != 0 )
+        {
+            printf( "critical value [%s] of [%s] cannot be met in the csv files of [%s] !\n", _single_si.CriticalValue, _single_si.Alias, _base_fn );
+            return -1;
+        }
+        *_return_d = FDS_BaseOutputs[i].value;
+        return 0;
+    }
 
-           printf( "critical value [%s] cannot be met in csv [%s] !\n", _single_si.CriticalValue, _base_fn);
-           fclose(fp);
-           return -1;
-     }
+    printf( "getOutputBaseValue() error: output [%s] is not an output record of the configuration file!\n", _single_si.Alias );
+    return -1;
 }
 
 
@@ -1641,3 +3835,334 @@ int AlignFDS(FILE *_fp, char _InfoArray[MAXLINENUM][MAXSTRINGSIZE], char _medium
 }
 
 
+
+/*************************************************************************************************************************************************
+ * the shared memory ring: a lock-free single-producer/single-consumer ring of fixed-size binary input records in a file mapped by both sides
+ * (e.g. /dev/shm/FirePM.ring). FirePM creates the ring with the input aliases of its configuration file, a producer (GSD -s) maps it and puts
+ * its values into the columns of these aliases. head is only written by the producer and tail only by the consumer, each on a cache line of
+ * its own, a record is published by the release store of head and given back by the release store of tail, so no system call is needed to
+ * pass a record
+ *************************************************************************************************************************************************/
+#define FPMRINGMAGIC 0x464d5052   // "FPMR"
+#define FPMRINGCAP 1024           // the number of records, a power of 2
+#define FPMRINGCOORD 6            // a geometric value has 6 coordinates (x1|x2|y1|y2|z1|z2)
+
+struct FPMRingRec
+{
+    unsigned long long seq;                 // the sequence number given by the producer
+    long long stamp;                        // the time the record is put, in nanoseconds of CLOCK_MONOTONIC (see FPMNowNs())
+    double time;                            // the first column of Dyn.txt (Time)
+    char timestr[32];                       // the first column as the producer wrote it, written to FirePM.csv as it is
+    int ncoord[MAXINPUTSNUM];               // the number of coordinates of every value, 1: a physical value, FPMRINGCOORD: a geometric value
+    double v[MAXINPUTSNUM][FPMRINGCOORD];   // the values in the columns of the aliases of the ring
+};
+
+struct FPMRing
+{
+    unsigned int magic;                     // FPMRINGMAGIC once the ring is ready
+    int cap;                                // FPMRINGCAP
+    int recsize;                            // sizeof(struct FPMRingRec)
+    int nin;                                // the number of the aliases
+    char alias[MAXINPUTSNUM][128];          // the input alias of every column
+    unsigned long long head __attribute__ ((aligned(64)));  // the records put, written by the producer
+    unsigned long long tail __attribute__ ((aligned(64)));  // the records taken, written by the consumer
+    struct FPMRingRec rec[FPMRINGCAP] __attribute__ ((aligned(64)));
+};
+
+// return the time of CLOCK_MONOTONIC in nanoseconds, it is read through the vDSO without a system call
+long long FPMNowNs( void )
+{
+    struct timespec tmp_ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &tmp_ts );
+    return (long long)tmp_ts.tv_sec*1000000000LL + tmp_ts.tv_nsec;
+}
+
+/*************************************************************************************************************************************************
+ * Function: map a shared memory ring
+ * _fn: input parameter indicating the file of the ring, e.g. /dev/shm/FirePM.ring
+ * _vic: input parameter indicating the input aliases (_vic[0].ColVal), the ring is created (emptied if it exists) with them, NULL: the ring
+ *       created by another process is mapped
+ * Return: the ring, NULL: failure
+ *************************************************************************************************************************************************/
+struct FPMRing *FPMRingOpen( const char *_fn, const struct VarInCol *_vic )
+{
+    int i=0, tmp_fd=-1;
+    struct FPMRing *tmp_r = NULL;
+
+    tmp_fd = open( _fn, _vic != NULL ? (O_RDWR | O_CREAT) : O_RDWR, 0666 );
+    if( tmp_fd < 0 || (_vic != NULL && ftruncate(tmp_fd, sizeof(struct FPMRing)) != 0) )
+    {
+        printf( "cannot open the ring [%s]: %s\n", _fn, strerror(errno) );
+        if( tmp_fd >= 0 )
+            close( tmp_fd );
+        return NULL;
+    }
+    tmp_r = mmap( NULL, sizeof(struct FPMRing), PROT_READ | PROT_WRITE, MAP_SHARED, tmp_fd, 0 );
+    close( tmp_fd );
+    if( tmp_r == MAP_FAILED )
+    {
+        printf( "mmap() error, the ring [%s]: %s\n", _fn, strerror(errno) );
+        return NULL;
+    }
+
+    if( _vic != NULL )
+    {
+        __atomic_store_n( &(tmp_r->magic), 0, __ATOMIC_RELEASE );
+        tmp_r->cap = FPMRINGCAP;
+        tmp_r->recsize = sizeof(struct FPMRingRec);
+        memset( tmp_r->alias, 0x0, sizeof(tmp_r->alias) );
+        for( i=0; i<MAXINPUTSNUM; i++ )
+        {
+            if( strlen(_vic[0].ColVal[i]) == 0 )
+                break;
+            snprintf( tmp_r->alias[i], sizeof(tmp_r->alias[i]), "%s", _vic[0].ColVal[i] );
+        }
+        tmp_r->nin = i;
+        tmp_r->tail = 0;
+        __atomic_store_n( &(tmp_r->head), 0, __ATOMIC_RELEASE );
+        __atomic_store_n( &(tmp_r->magic), FPMRINGMAGIC, __ATOMIC_RELEASE );
+    } else if( __atomic_load_n(&(tmp_r->magic), __ATOMIC_ACQUIRE) != FPMRINGMAGIC || tmp_r->cap != FPMRINGCAP || tmp_r->recsize != (int)sizeof(struct FPMRingRec) )
+    {
+        printf( "[%s] is not a ring of this version, it should be created by FirePM first\n", _fn );
+        munmap( tmp_r, sizeof(struct FPMRing) );
+        return NULL;
+    }
+    return tmp_r;
+}
+
+// unmap a shared memory ring
+void FPMRingClose( struct FPMRing *_r )
+{
+    if( _r != NULL )
+        munmap( _r, sizeof(struct FPMRing) );
+}
+
+// put one record into the ring, only by the producer. return 0: success, -1: the ring is full
+int FPMRingPut( struct FPMRing *_r, const struct FPMRingRec *_rec )
+{
+    unsigned long long tmp_h = __atomic_load_n( &(_r->head), __ATOMIC_RELAXED );
+
+    if( tmp_h - __atomic_load_n(&(_r->tail), __ATOMIC_ACQUIRE) >= FPMRINGCAP )
+        return -1;
+    memcpy( &(_r->rec[tmp_h & (FPMRINGCAP-1)]), _rec, sizeof(struct FPMRingRec) );
+    __atomic_store_n( &(_r->head), tmp_h+1, __ATOMIC_RELEASE );
+    return 0;
+}
+
+// take one record from the ring, only by the consumer. return 0: success, -1: the ring is empty
+int FPMRingGet( struct FPMRing *_r, struct FPMRingRec *_rec )
+{
+    unsigned long long tmp_t = __atomic_load_n( &(_r->tail), __ATOMIC_RELAXED );
+
+    if( tmp_t == __atomic_load_n(&(_r->head), __ATOMIC_ACQUIRE) )
+        return -1;
+    memcpy( _rec, &(_r->rec[tmp_t & (FPMRINGCAP-1)]), sizeof(struct FPMRingRec) );
+    __atomic_store_n( &(_r->tail), tmp_t+1, __ATOMIC_RELEASE );
+    return 0;
+}
+
+// return 1 if the ring has records to take
+int FPMRingReady( struct FPMRing *_r )
+{
+    return __atomic_load_n(&(_r->tail), __ATOMIC_RELAXED) != __atomic_load_n(&(_r->head), __ATOMIC_ACQUIRE);
+}
+
+// spin a little while a consumer waits for the ring
+void FPMRingPause( void )
+{
+#if defined(__SSE2__)
+    _mm_pause();
+#endif
+}
+
+/*************************************************************************************************************************************************
+ * the snapshot files: Dyn.txt, SMT.csv and RSMRlt.csv are published as snapshots so that a reader never sees a file being written. a writer
+ * writes "<file>.tmp" (FPMSnapCreate()) and renames it to the file (FPMSnapPublish()). the head of a snapshot is the fixed-width line
+ * "#FPMSNAP,<sequence>,<bytes>,<checksum>\n" where the bytes and the FNV-1a checksum are those of the content. it is the first line of Dyn.txt,
+ * while SMT.csv and RSMRlt.csv are reports read by other tools as well, so their head is kept in the sidecar "<file>.snap" together with the
+ * inode and the modified time of the file published ("#FPMSNAP,<sequence>,<bytes>,<checksum>,<inode>,<seconds>.<nanoseconds>\n"), the sidecar
+ * is renamed before the file. a reader opens the file by FPMSnapOpen(), which only returns a snapshot whose bytes and checksum match. a file
+ * without the head, or whose sidecar does not match its inode, size and modified time (e.g. the file is copied over, redirected to or edited by
+ * hand, which may keep the inode), is read as it is. the lines appended to Dyn.txt after the bytes of its snapshot are read as well
+ *************************************************************************************************************************************************/
+#define FPMSNAPTAG "#FPMSNAP,"
+#define FPMSNAPHEADLEN 68   // strlen("#FPMSNAP,") + 20 + 1 + 20 + 1 + 16 + 1
+#define FPMSNAPSIDE ".snap"
+
+// read the sidecar of _fn, return 0 if it exists and is valid, otherwise -1
+int FPMSnapSideRead( const char *_fn, unsigned long *_seq, unsigned long *_size, unsigned long *_sum, unsigned long *_ino, struct timespec *_mtime )
+{
+    char tmp_fn[MAXSTRINGSIZE], tmp_head[FPMSNAPHEADLEN+64]; // the head, the inode and the modified time
+    FILE *fp = NULL;
+    int rt = -1;
+
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    memset( tmp_head, 0x0, sizeof(tmp_head) );
+    snprintf( tmp_fn, sizeof(tmp_fn), "%s%s", _fn, FPMSNAPSIDE );
+    fp = fopen( tmp_fn, "r" );
+    if( fp == NULL )
+        return -1;
+    if( fgets(tmp_head, sizeof(tmp_head), fp) != NULL && sscanf(tmp_head, FPMSNAPTAG "%lu,%lu,%lx,%lu,%ld.%ld", _seq, _size, _sum, _ino,
+                                                                &(_mtime->tv_sec), &(_mtime->tv_nsec)) == 6 )
+        rt = 0;
+    fclose( fp );
+    return rt;
+}
+
+// return the sequence of the snapshot _fn, 0 if _fn does not exist or is not a snapshot
+unsigned long FPMSnapSeq( const char *_fn )
+{
+    char tmp_head[FPMSNAPHEADLEN+1];
+    unsigned long tmp_seq = 0, tmp_size=0, tmp_sum=0, tmp_ino=0;
+    struct timespec tmp_mtime;
+    FILE *fp = fopen( _fn, "r" );
+
+    if( fp == NULL )
+        return 0;
+    memset( tmp_head, 0x0, sizeof(tmp_head) );
+    if( fread(tmp_head, 1, FPMSNAPHEADLEN, fp) != FPMSNAPHEADLEN || strncmp(tmp_head, FPMSNAPTAG, strlen(FPMSNAPTAG)) != 0
+        || sscanf(tmp_head+strlen(FPMSNAPTAG), "%lu", &tmp_seq) != 1 )
+        tmp_seq = 0;
+    fclose( fp );
+    if( tmp_seq == 0 && FPMSnapSideRead(_fn, &tmp_seq, &tmp_size, &tmp_sum, &tmp_ino, &tmp_mtime) != 0 )
+        tmp_seq = 0;
+    return tmp_seq;
+}
+
+/*************************************************************************************************************************************************
+ * Function: start writing a snapshot of _fn, the content is written to the returned file and published by FPMSnapPublish()
+ * _fn: input parameter indicating the file name of the snapshot
+ * _side: input parameter, 1: the head is kept in the sidecar "<_fn>.snap" and _fn only holds the content, 0: the head is the first line of _fn
+ * Return: the file "<_fn>.tmp" positioned after the room of the head, NULL: failure
+ *************************************************************************************************************************************************/
+FILE *FPMSnapCreate( const char *_fn, int _side )
+{
+    char tmp_fn[MAXSTRINGSIZE];
+    FILE *fp = NULL;
+
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    snprintf( tmp_fn, sizeof(tmp_fn), "%s.tmp", _fn );
+    fp = fopen( tmp_fn, "w+" );
+    if( fp == NULL )
+    {
+        printf( "FPMSnapCreate() error: fopen [%s] failed!\n", tmp_fn );
+        return NULL;
+    }
+    if( _side == 0 )
+        fprintf( fp, "%-*s\n", FPMSNAPHEADLEN-1, "" ); // the head is filled in by FPMSnapPublish()
+    return fp;
+}
+
+/*************************************************************************************************************************************************
+ * Function: publish a snapshot written to the file returned by FPMSnapCreate(), the head is filled in with the next sequence of _fn, the bytes
+ *           and the checksum, and "<_fn>.tmp" is renamed to _fn
+ * _fn: input parameter indicating the file name of the snapshot
+ * _fp: input parameter indicating the file returned by FPMSnapCreate(), it is closed
+ * _side: input parameter, the same as that given to FPMSnapCreate()
+ * Return: 0: success
+ *         -1: failure, _fn is not changed
+ *************************************************************************************************************************************************/
+int FPMSnapPublish( const char *_fn, FILE *_fp, int _side )
+{
+    char tmp_fn[MAXSTRINGSIZE], tmp_side_fn[MAXSTRINGSIZE], tmp_side_tmp[MAXSTRINGSIZE], tmp_head[FPMSNAPHEADLEN+1];
+    long tmp_hl = (_side == 0) ? FPMSNAPHEADLEN : 0; // the length of the head in _fn
+    struct MapFile tmp_mf;
+    struct stat tmp_st;
+    FILE *tmp_side_fp = NULL;
+    int rt = 0;
+
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    memset( tmp_side_fn, 0x0, sizeof(tmp_side_fn) );
+    memset( tmp_side_tmp, 0x0, sizeof(tmp_side_tmp) );
+    memset( tmp_head, 0x0, sizeof(tmp_head) );
+    snprintf( tmp_fn, sizeof(tmp_fn), "%s.tmp", _fn );
+    snprintf( tmp_side_fn, sizeof(tmp_side_fn), "%s%s", _fn, FPMSNAPSIDE );
+    snprintf( tmp_side_tmp, sizeof(tmp_side_tmp), "%s%s.tmp", _fn, FPMSNAPSIDE );
+    if( fflush(_fp) != 0 || fstat(fileno(_fp), &tmp_st) != 0 || MapFileOpen(tmp_fn, &tmp_mf) != 0 )
+        rt = -1;
+    else
+    {
+        sprintf( tmp_head, FPMSNAPTAG "%020lu,%020lu,%016lx", FPMSnapSeq(_fn)+1, (unsigned long)(tmp_mf.size-tmp_hl),
+                 HashFNV1a(tmp_mf.data+tmp_hl, tmp_mf.size-tmp_hl) );
+        MapFileClose( &tmp_mf );
+        if( _side == 0 && (fseek(_fp, 0L, SEEK_SET) != 0 || fprintf(_fp, "%s\n", tmp_head) != FPMSNAPHEADLEN) )
+            rt = -1;
+    }
+    if( rt == 0 && _side == 1 ) // the sidecar is renamed first, a reader seeing the new sidecar with the old file reads the old file as it is
+    {
+        tmp_side_fp = fopen( tmp_side_tmp, "w" );
+        if( tmp_side_fp == NULL || fprintf(tmp_side_fp, "%s,%020lu,%020ld.%09ld\n", tmp_head, (unsigned long)tmp_st.st_ino,
+                                           (long)tmp_st.st_mtim.tv_sec, (long)tmp_st.st_mtim.tv_nsec) < 0 )
+            rt = -1;
+        if( tmp_side_fp != NULL && fclose(tmp_side_fp) != 0 )
+            rt = -1;
+        if( rt != 0 || rename(tmp_side_tmp, tmp_side_fn) != 0 )
+        {
+            remove( tmp_side_tmp );
+            rt = -1;
+        }
+    }
+    if( fclose(_fp) != 0 || rt != 0 || rename(tmp_fn, _fn) != 0 )
+    {
+        printf( "FPMSnapPublish() error: publish [%s] as [%s] failed!\n", tmp_fn, _fn );
+        remove( tmp_fn );
+        return -1;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: open a snapshot for reading, the bytes and the checksum in its head (the first line or the sidecar) are verified first, the lines
+ *           appended behind the bytes of a snapshot with the head in its first line are not
+ * _fn: input parameter indicating the file name of the snapshot
+ * _seq: output parameter indicating the sequence of the snapshot, 0: _fn is not a snapshot and is read as it is
+ * Return: the file positioned after the head, NULL: failure, _fn cannot be opened or is not a complete snapshot
+ *************************************************************************************************************************************************/
+FILE *FPMSnapOpen( const char *_fn, unsigned long *_seq )
+{
+    char tmp_head[FPMSNAPHEADLEN+1];
+    unsigned long tmp_size=0, tmp_sum=0, tmp_ino=0;
+    long tmp_hl = 0; // the length of the head in _fn
+    struct timespec tmp_mtime;
+    struct MapFile tmp_mf;
+    struct stat tmp_st;
+    FILE *fp = NULL;
+
+    *_seq = 0;
+    memset( &tmp_mtime, 0x0, sizeof(tmp_mtime) );
+    if( MapFileOpen(_fn, &tmp_mf) != 0 )
+        return NULL;
+    if( tmp_mf.size >= FPMSNAPHEADLEN && strncmp(tmp_mf.data, FPMSNAPTAG, strlen(FPMSNAPTAG)) == 0 )
+    {
+        memset( tmp_head, 0x0, sizeof(tmp_head) );
+        memcpy( tmp_head, tmp_mf.data, FPMSNAPHEADLEN ); // the mapped file is not null terminated
+        tmp_hl = FPMSNAPHEADLEN;
+        if( sscanf(tmp_head, FPMSNAPTAG "%lu,%lu,%lx", _seq, &tmp_size, &tmp_sum) != 3 )
+            tmp_size = (unsigned long)-1;
+    }
+    else if( FPMSnapSideRead(_fn, _seq, &tmp_size, &tmp_sum, &tmp_ino, &tmp_mtime) != 0 || fstat(tmp_mf.fd, &tmp_st) != 0
+             || tmp_ino != (unsigned long)tmp_st.st_ino || tmp_size != (unsigned long)tmp_st.st_size
+             || tmp_mtime.tv_sec != tmp_st.st_mtim.tv_sec || tmp_mtime.tv_nsec != tmp_st.st_mtim.tv_nsec )
+        *_seq = 0; // no sidecar, or the sidecar of another file or of the file before it was written again
+    // the bytes in a sidecar are the size of the file (checked above), while the records appended to Dyn.txt after it is published follow the
+    // bytes of its snapshot, only these bytes are verified
+    if( (*_seq > 0 || tmp_hl > 0) && (tmp_size > (unsigned long)(tmp_mf.size-tmp_hl) || HashFNV1a(tmp_mf.data+tmp_hl, tmp_size) != tmp_sum) )
+    {
+        printf( "[%s] is not a complete snapshot, it is not read\n", _fn );
+        MapFileClose( &tmp_mf );
+        return NULL;
+    }
+
+    // the file verified is the one read, a newer snapshot is renamed to _fn without touching it
+    fp = fdopen( dup(tmp_mf.fd), "r" );
+    MapFileClose( &tmp_mf );
+    if( fp == NULL || fseek(fp, tmp_hl, SEEK_SET) != 0 )
+    {
+        printf( "FPMSnapOpen() error: fdopen [%s] failed!\n", _fn );
+        if( fp != NULL )
+            fclose( fp );
+        return NULL;
+    }
+    return fp;
+}
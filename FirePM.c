@@ -5,15 +5,23 @@
  *
  * Discription: this file includes the source code of the tool, FirepM, which can be used to dynamically monitor the change of building fire performance defined by the user (ASET,RSET, etc) based on the change of input data (Dyn.txt)
  *
- * How to Run this tool: ./FirePM SM_Info.txt.  this tool can be assisted by another tool, ./GSD, which can generate simulation data and save the data to input data file (Dyn.txt), and then FirePM will check the change of the Dyn.txt and output the change of building fire performance 
+ * How to Run this tool: ./FirePM [-u socket] [-p pipe] [-s ring] SM_Info.txt, or ./FirePM -b buildings.txt [-j workers] for many buildings.  this tool can be assisted by another tool, ./GSD, which can generate simulation data and save the data to input data file (Dyn.txt), and then FirePM will check the change of the Dyn.txt and output the change of building fire performance 
  *
  * Flowchat: 
  *     step 1 -> read information from user's input file (SM_Info.txt) into  a SMInfo struct array (FDS_SmInfo)
  *     step 2 -> read in the input base data and the output base data
- *     step 3 -> in a while, repeatedly check if the sensitivity file (SMT.txt) and the input data file (Dyn.txt)  are updated, if Yes then recalculate the change of the building fire performance
+ *     step 3 -> in a while, wait until the sensitivity file (SMT.txt), the RSM file (RSMRlt.csv) or the input data file (Dyn.txt) is written, then calculate the change of the building fire performance for the records appended to Dyn.txt
  ***************************************************************************************************************************************************/
 
 #include "FirePM.h"
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
 
 struct ThreeDCoordinate tmp_3DC[3];
 struct GenInfo FDS_GenInfo[MAXFILENUM];
@@ -76,86 +84,206 @@ int FindOneINV(char *_IA, char * _IBV, struct VarInCol *_DynIn, int _k, double *
 }
 
 /************************************************************************************************************************************************* 
- * Function: This function will find one sensitivity from the sensitivity matrix based on the maching information given by _OA and _IA 
- * _OA: input parameter indicating OutputAlias, 
- * _IA: input parameter indicating InputAlias, 
- * _sen_matx: input parameter indicating the sensitivity matrix, 
+ * Function: This function will find one sensitivity from the sensitivity matrix based on the maching information given by _oa and _ia 
+ * _oa: input parameter indicating the ID of the OutputAlias, 
+ * _ia: input parameter indicating the ID of the InputAlias, 
+ * _sm: input parameter indicating the sensitivity matrix, 
  * _one_sen: output parameter holding a sensitivity value
  * Return: 0: success
  *         -1: failure
  *************************************************************************************************************************************************/
-int FindOneSen( char *_OA, char *_IA, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128], double * _one_sen)
+int FindOneSen( int _oa, int _ia, const struct SenMatrix *_sm, double * _one_sen)
 {
-    int i=0,j=0,flag=0;
-    
-    for( i=1; i<=MAXINPUTSNUM; i++ )
-    {
-        if( strlen(_sen_matx[i][0]) == 0 )
-            break;
-        if( strcmp(_sen_matx[i][0], _IA) == 0 )
-        {
-            flag++;
-            break;   
-        }
-    }
-
-    for( j=1; j<=MAXOUTPUTSNUM; j++ )
-    {
-        if( strlen(_sen_matx[0][j]) == 0 )
-            break;
-        if( strcmp(_sen_matx[0][j], _OA ) == 0 )
-        {
-            flag++;
-            break;
-        }
-    }
-
-    if( flag == 2 )
-    {
-        *_one_sen = atof( _sen_matx[i][j]);
-        return 0;
-    }
-
-    return -1;
+    return SenMatrixGet( _sm, _ia, _oa, _one_sen );
 }
 
 /************************************************************************************************************************************************* 
  * Function: calculate the measures of single factor that can close the building fire performance gap 
- * _SenMatx: input parameter indicating the sensitivity matrix
- * _OA: input parameter indicating a output alias which should be registed in the sensitivity matrix 
+ * _sm: input parameter indicating the sensitivity matrix
+ * _oa: input parameter indicating the ID of a output alias which should be registed in the sensitivity matrix 
  * _gap: input parameter indicating a building fire performance gap
  * _measures: output parameter indicating a series of optional measures of single factor that could  close the gap
  * Return: void
  *************************************************************************************************************************************************/
-void CalMeasures(char _SenMatx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128], char *_OA, double _gap, char *_measures )
+void CalMeasures(const struct SenMatrix *_sm, int _oa, double _gap, char *_measures )
 {
-     int tmp_i=0, tmp_j=0;
+     int tmp_i=0;
+     int tmp_j = (_oa >= 0 && _oa < MAXOUTPUTSNUM) ? _sm->col[_oa] : -1; // the column of _oa
 
-     for( tmp_i=1; tmp_i<MAXINPUTSNUM; tmp_i++ )
+     for( tmp_i=0; tmp_i<_sm->nin && tmp_i<MAXINPUTSNUM-1; tmp_i++ )
      {
-         if( strlen(_SenMatx[tmp_i][0]) == 0 )
-         break;
          if( strlen(_measures) > 0 )
          strcat(_measures,"||");
-         for( tmp_j=1; tmp_j<MAXOUTPUTSNUM; tmp_j++ )
+         if( tmp_j >= 0 && tmp_j < MAXOUTPUTSNUM-1 )
          {
+             char tmp_str[128];
+             double tmp_adjust = -_gap/_sm->sen[tmp_i][tmp_j];
 
-             if( strlen(_SenMatx[0][tmp_j]) == 0 )
-                 break;
-             if( strcmp( _SenMatx[0][tmp_j], _OA ) == 0 )
-             {
-                 char tmp_str[128];
-                 double tmp_adjust = -_gap/atof(_SenMatx[tmp_i][tmp_j]);
-
-	         memset( tmp_str, 0x0, sizeof(tmp_str) );
-                 sprintf( tmp_str, "%s[%.4f]", _SenMatx[tmp_i][0], tmp_adjust);
-                 strcat(_measures,tmp_str);
-             }
+             memset( tmp_str, 0x0, sizeof(tmp_str) );
+             sprintf( tmp_str, "%s[%.4f]", _sm->in_alias[tmp_i], tmp_adjust);
+             strcat(_measures,tmp_str);
          }
-                        
      }
 }
 
+/*************************************************************************************************************************************************
+ * the latency statistics: every stage of the monitoring loop is timed by CLOCK_MONOTONIC (FPMNowNs()) and its latencies are counted in a
+ * log-linear histogram like HdrHistogram, the values below 64 ns have a bucket each and every power of 2 above is cut into 32 buckets, so a
+ * percentile is within 1/32 of the latency. the histograms are counted since the start of FirePM, written to FPMStatFn every FPMSTATPERIOD
+ * seconds and printed to stdout on SIGUSR1
+ *************************************************************************************************************************************************/
+#define FPMSTATBUCKETS (64+57*32)  // the buckets of the latencies up to 2^63 ns
+#define FPMSTATFILE "FirePM.stats"
+#define FPMSTATPERIOD 10           // seconds
+
+#define FPMSTAGEDETECT 0   // from the time Dyn.txt is modified to the time FirePM reads it
+#define FPMSTAGEPARSE 1    // readinDyn()
+#define FPMSTAGESMT 2      // the input gaps and the SMT predictions of an update
+#define FPMSTAGERSM 3      // the RSM predictions of an update
+#define FPMSTAGEMEA 4      // CalMeasures() of the alarmed SMT predictions of an update
+#define FPMSTAGEEMIT 5     // writing FirePM.csv and stdout, CalMeasures() excluded
+#define FPMSTAGETOTAL 6    // from the time a record is written (Dyn.txt) or put (the ring) to the time its line is in FirePM.csv
+#define FPMSTAGENUM 7
+
+struct FPMHist
+{
+    long count;                      // the latencies counted
+    long long max;                   // the largest latency, in ns
+    long bucket[FPMSTATBUCKETS];     // the latencies counted in every bucket
+};
+
+struct FPMStats
+{
+    struct FPMHist hist[FPMSTAGENUM];
+    long long dumped;                // the time FPMStatFn was written last time
+};
+
+struct FPMStats FPMStat;
+char FPMStatFn[256] = FPMSTATFILE;      // the statistics file, one for every worker of the multi-building mode
+volatile sig_atomic_t FPMStatSignal = 0; // 1: SIGUSR1 is received, the statistics are printed by the loop
+const char *FPMStageName[FPMSTAGENUM] = { "detect", "parse", "smt", "rsm", "measures", "emit", "total" };
+
+// return the bucket of the latency _ns
+int FPMHistBucket( long long _ns )
+{
+    int tmp_shift = 0;
+
+    if( _ns < 64 )
+        return _ns < 0 ? 0 : (int)_ns;
+    tmp_shift = 63 - __builtin_clzll( (unsigned long long)_ns ) - 5;
+    return 64 + (tmp_shift-1)*32 + (int)(_ns >> tmp_shift) - 32;
+}
+
+// return the largest latency of the bucket _b
+long long FPMHistBucketMax( int _b )
+{
+    int tmp_shift = 0;
+
+    if( _b < 64 )
+        return _b;
+    tmp_shift = (_b-64)/32 + 1;
+    return ((long long)((_b-64)%32 + 33) << tmp_shift) - 1;
+}
+
+// count one latency of the stage _stage, in ns
+void FPMStatAdd( int _stage, long long _ns )
+{
+    struct FPMHist *tmp_h = &(FPMStat.hist[_stage]);
+
+    tmp_h->count++;
+    tmp_h->bucket[FPMHistBucket(_ns)]++;
+    if( _ns > tmp_h->max )
+        tmp_h->max = _ns;
+}
+
+// return the latency in ns which _q (e.g. 0.99) of the latencies counted in _h do not exceed
+long long FPMHistPercentile( const struct FPMHist *_h, double _q )
+{
+    long tmp_rank = (long)ceil( _q * _h->count ), tmp_sum = 0;
+    int i=0;
+
+    for( i=0; i<FPMSTATBUCKETS; i++ )
+    {
+        tmp_sum += _h->bucket[i];
+        if( tmp_sum >= tmp_rank && tmp_sum > 0 )
+            return FPMHistBucketMax(i) < _h->max ? FPMHistBucketMax(i) : _h->max;
+    }
+    return _h->max;
+}
+
+// return the ns passed since the file time _t (CLOCK_REALTIME), a file time is only as fine as the clock tick of the file system
+long long FPMSinceNs( const struct timespec *_t )
+{
+    struct timespec tmp_ts;
+
+    clock_gettime( CLOCK_REALTIME, &tmp_ts );
+    return (long long)(tmp_ts.tv_sec - _t->tv_sec)*1000000000LL + (tmp_ts.tv_nsec - _t->tv_nsec);
+}
+
+// print the statistics of all the stages to _fp, in us
+void FPMStatPrint( FILE *_fp )
+{
+    int i=0;
+
+    fprintf( _fp, "Stage,Count,p50(us),p99(us),p99.9(us),Max(us)\n" );
+    for( i=0; i<FPMSTAGENUM; i++ )
+    {
+        const struct FPMHist *tmp_h = &(FPMStat.hist[i]);
+        fprintf( _fp, "%s,%ld,%.1lf,%.1lf,%.1lf,%.1lf\n", FPMStageName[i], tmp_h->count, FPMHistPercentile(tmp_h, 0.5)/1000.0,
+                 FPMHistPercentile(tmp_h, 0.99)/1000.0, FPMHistPercentile(tmp_h, 0.999)/1000.0, tmp_h->max/1000.0 );
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: write the statistics to FPMStatFn every FPMSTATPERIOD seconds, and print them to stdout if SIGUSR1 is received
+ * _force: input parameter, 1: write FPMStatFn now
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMStatDump( int _force )
+{
+    char tmp_fn[MAXSTRINGSIZE];
+    long long tmp_now = FPMNowNs();
+    FILE *fp = NULL;
+
+    if( FPMStatSignal == 1 )
+    {
+        FPMStatSignal = 0;
+        _force = 1;
+        printf( "the latency statistics:\n" );
+        FPMStatPrint( stdout );
+        fflush( stdout );
+    }
+    if( _force == 0 && tmp_now - FPMStat.dumped < FPMSTATPERIOD*1000000000LL )
+        return 0;
+    FPMStat.dumped = tmp_now;
+
+    // written to a temporary file and renamed, a reader never sees a half written file
+    memset( tmp_fn, 0x0, sizeof(tmp_fn) );
+    sprintf( tmp_fn, "%s.tmp", FPMStatFn );
+    fp = fopen( tmp_fn, "w" );
+    if( fp == NULL )
+    {
+        printf( "FPMStatDump() error: fopen [%s] failed!\n", tmp_fn );
+        return -1;
+    }
+    FPMStatPrint( fp );
+    if( fclose(fp) != 0 || rename(tmp_fn, FPMStatFn) != 0 )
+    {
+        printf( "FPMStatDump() error: rename [%s] to [%s] failed!\n", tmp_fn, FPMStatFn );
+        remove( tmp_fn );
+        return -1;
+    }
+    return 0;
+}
+
+// the handler of SIGUSR1, the statistics are printed by the loop
+void FPMStatOnSignal( int _sig )
+{
+    (void)_sig;
+    FPMStatSignal = 1;
+}
+
 /************************************************************************************************************************************************* 
  * Function: this function is the core function of FirePM software. it uses dynamically changed input data from Dyn.txt to calculate the predictions by SMM and RSM.
  *    FlowChart:
@@ -172,19 +300,29 @@ void CalMeasures(char _SenMatx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128], char *_OA,
  *************************************************************************************************************************************************/
 int UpdateFPM(char *_FPM_fn )
 {
-    int i=0,j=0,k=0, start=0;
+    int i=0,j=0,k=0, start=0, rt=0;
+    int tmp_rows=0, tmp_nin=0, tmp_nout=0;
     char tmp_base_name[MAXOUTPUTSNUM][128];
+    double tmp_s[MAXINPUTSNUM*MAXOUTPUTSNUM]; // the sensitivities, [i*tmp_nout+j]
+    double *tmp_d = NULL;                     // the input gaps of the records, [(k-1)*tmp_nin+i]
+    double *tmp_p = NULL;                     // the SMT predictions of the records, [(k-1)*tmp_nout+j]
+    double *tmp_x = NULL;                     // the input new values of the records, [(k-1)*tmp_nin+i]
+    double *tmp_r = NULL;                     // the RSM predictions of the records, [(k-1)*tmp_nout+j]
+    int tmp_in[MAXINPUTSNUM], tmp_out[MAXOUTPUTSNUM];
+    struct RSMEval tmp_ev;
+    long long tmp_t0=0, tmp_t1=0, tmp_mea=0; // the stage timers, tmp_mea: the time of CalMeasures()
     FILE *fp=NULL; 
 
-    if( findsize(_FPM_fn) > 0 )
-        start = 1;
-    
     fp = fopen(_FPM_fn,"a+");
     if( fp==NULL)
     {
         printf( "cannot open %s!\n", _FPM_fn );
         return -1;
     }
+    fseek( fp, 0L, SEEK_END ); // the size is taken from the opened file, it is not opened a second time by findsize()
+    if( ftell(fp) > 0 )
+        start = 1;
+    tmp_t0 = FPMNowNs();
 
     memset( tmp_base_name, 0x0, sizeof( tmp_base_name ) );
     printf( "file size = %ld\n", ftell(fp) );
@@ -192,121 +330,130 @@ int UpdateFPM(char *_FPM_fn )
 
     sprintf( FDS_OutputsRltSMT[0].ColName,"%s", FDS_DynIn[0].ColName );//initiallize the output data sequence with the input dynamic data;
 
-    for( j=0; j<MAXOUTPUTSNUM;j++) //for each output variable
+    // the SMT predictions of all the records are calculated at one time: the input gaps of the records (tmp_d) times the sensitivities (tmp_s)
+    for( tmp_rows=0; tmp_rows<MAXLINENUM-2; tmp_rows++ )
     {
-        double tmp_colval_SMT[MAXLINENUM];
-        double tmp_colval_RSM[MAXLINENUM];
-        char InputAlias[MAXLINENUM][512];
-        char InputNewValue[MAXLINENUM][512];
-
-        memset( tmp_colval_SMT, 0x0, sizeof(tmp_colval_SMT));
-        memset( tmp_colval_RSM, 0x0, sizeof(tmp_colval_RSM));
-        memset( InputAlias, 0x0, sizeof(InputAlias));
-        memset( InputNewValue, 0x0, sizeof(InputNewValue));
-
-
-        if( strlen(FDS_OutputsVar[0].ColVal[j])==0 )
+        if( strlen(FDS_DynIn[tmp_rows+1].ColName) == 0 )
             break;
-        
-        sprintf( FDS_OutputsRltSMT[0].ColVal[j],"%s_SMT", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
-        sprintf( FDS_OutputsRltRSM[0].ColVal[j],"%s_RSM", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
-        sprintf( tmp_base_name[j],"%s_BAS", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
+    }
+    for( tmp_nin=0; tmp_nin<MAXINPUTSNUM; tmp_nin++ )
+    {
+        if( strlen(FDS_InputsVar[0].ColVal[tmp_nin]) == 0 )
+            break;
+    }
+    for( tmp_nout=0; tmp_nout<MAXOUTPUTSNUM; tmp_nout++ )
+    {
+        if( strlen(FDS_OutputsVar[0].ColVal[tmp_nout]) == 0 )
+            break;
+    }
+    tmp_d = malloc( sizeof(double)*(tmp_rows*tmp_nin+1) );
+    tmp_p = malloc( sizeof(double)*(tmp_rows*tmp_nout+1) );
+    tmp_x = malloc( sizeof(double)*(tmp_rows*tmp_nin+1) );
+    tmp_r = malloc( sizeof(double)*(tmp_rows*tmp_nout+1) );
+    if( tmp_d == NULL || tmp_p == NULL || tmp_x == NULL || tmp_r == NULL )
+    {
+        printf( "UpdateFPM() error: memory allocation for [%d] records failed!\n", tmp_rows );
+        rt = -1;
+    }
+
+    for( i=0; i<tmp_nin && rt == 0; i++ )//for each input variable
+    {
+        int tmp_ia = tmp_in[i] = SymID(&(FPMSyms.in), FDS_InputsVar[0].ColVal[i], 0);
+        int tmp_geo = (strstr(FDS_InputsVar[1].ColVal[i], "|") != NULL);
+        double tmp_ibv = atof(FDS_InputsVar[1].ColVal[i]);
 
-        for( k=1; k<MAXLINENUM; k++ ) //k starts with 1 because the first line (k=0) in Dyn.txt  is head information
+        for( j=0; j<tmp_nout; j++ )
         {
-           if( strlen(FDS_DynIn[k].ColName) == 0 )
-               break;
-           sprintf( FDS_OutputsRltSMT[k].ColName,"%s", FDS_DynIn[k].ColName );//initiallize the output data sequence with the input dynamic data;
-           tmp_colval_SMT[k]=atof(FDS_OutputsVar[1].ColVal[j]); //initiallize the output data with the outputbase value
-           tmp_colval_RSM[k]=atof(FDS_OutputsVar[1].ColVal[j]); //initiallize the output data with the outputbase value
-           printf( "tmp_colval_SMT[%d]=%.2lf\n", k, tmp_colval_SMT[k] );
+            double tmp_one_sen=0.00;
+            tmp_out[j] = SymID( &(FPMSyms.out), FDS_OutputsVar[0].ColVal[j], 0 );
+            // get one sensitivity from the sensitivity  matrix (SenMatxNum)
+            FindOneSen(tmp_out[j], tmp_ia, &SenMatxNum, &tmp_one_sen);
+            tmp_s[i*tmp_nout+j] = tmp_one_sen;
         }
 
-        for( i=0; i<MAXINPUTSNUM; i++ )//for each input variable
+        for( k=1; k<=tmp_rows; k++ ) //k starts with 1 because the first line (k=0) in Dyn.txt  is head information
         {
-            double tmp_one_sen=0.00;
-            if(strlen(FDS_InputsVar[0].ColVal[i])==0)
-               break;
-            // get one sensitivity from the sensitivity  matrix (SenMatx)
-            FindOneSen(FDS_OutputsVar[0].ColVal[j], FDS_InputsVar[0].ColVal[i], SenMatx, &tmp_one_sen);
-            for( k=1;k<MAXLINENUM;k++)
+            double tmp_input=0.00;
+            
+            //get one input new value
+            if( FindOneINV(FDS_InputsVar[0].ColVal[i],FDS_InputsVar[1].ColVal[i],FDS_DynIn,k, &tmp_input) != 0 )
             {
-                double tmp_input=0.00;
-                double tmp_add=0.00;
-                char tmp_str[128];
-               
-                memset( tmp_str, 0x0, sizeof(tmp_str));
-                
-                if( strlen(FDS_DynIn[k].ColName) == 0 )
-                    break;
-           
-                //get one input new value
-                if( FindOneINV(FDS_InputsVar[0].ColVal[i],FDS_InputsVar[1].ColVal[i],FDS_DynIn,k, &tmp_input) != 0 )
-                {
-                    printf( "FindOneINV() error !, InputAlias = [%s], input base value=[%s], k=[%d]\n", 
-                            FDS_InputsVar[0].ColVal[i], FDS_InputsVar[1].ColVal[i], k );
-                    return -1;
-                }
-                // deal with RSM
-                if( i != 0 )
+                printf( "FindOneINV() error !, InputAlias = [%s], input base value=[%s], k=[%d]\n", 
+                        FDS_InputsVar[0].ColVal[i], FDS_InputsVar[1].ColVal[i], k );
+                rt = -1;
+                break;
+            }
+            tmp_x[(k-1)*tmp_nin+i] = tmp_input; // deal with RSM
+
+            // deal with SMT
+            if( tmp_geo == 0 )
+                tmp_d[(k-1)*tmp_nin+i] = tmp_input-tmp_ibv; //physcical variables
+            else { //geometric variables
+                double tmp_gd = 0.00;
+                struct ThreeDCoordinate tmp_3d_base, tmp_3d_new;
+                memset( &tmp_3d_base, 0x0, sizeof(tmp_3d_base));
+                memset( &tmp_3d_new, 0x0, sizeof(tmp_3d_new));
+                sscanf(FDS_DynIn[k].ColVal[i],"%lf|%lf|%lf|%lf|%lf|%lf",
+                   &(tmp_3d_base.x1), &(tmp_3d_base.x2), &(tmp_3d_base.y1), &(tmp_3d_base.y2), &(tmp_3d_base.z1), &(tmp_3d_base.z2));
+                sscanf(FDS_InputsVar[1].ColVal[i],"%lf|%lf|%lf|%lf|%lf|%lf",
+                   &(tmp_3d_new.x1), &(tmp_3d_new.x2), &(tmp_3d_new.y1), &(tmp_3d_new.y2), &(tmp_3d_new.z1), &(tmp_3d_new.z2));
+                // find the input base value from the 3d coordinates by comparing with the input new value
+                // note that the base and new parameters are inverted to get the input base value
+                if( FindDiffDC(tmp_3d_base, tmp_3d_new, &tmp_gd) != 0 ) 
                 {
-                    strcat(InputAlias[k], "+" );
-                    strcat(InputNewValue[k], "+" );
-                }
-                strcat(InputAlias[k],FDS_InputsVar[0].ColVal[i] );
-                sprintf( tmp_str, "%lf", tmp_input );
-                strcat(InputNewValue[k],tmp_str ); // prepare _IA and _INV for GetOnePvFromRSMRlt()
-
-                // deal with SMT
-                if( strstr(FDS_InputsVar[1].ColVal[i], "|") == NULL )
-                    tmp_add = tmp_one_sen*(tmp_input-atof(FDS_InputsVar[1].ColVal[i])); //physcical variables
-                else { //geometric variables
-                    double tmp_d = 0.00;
-                    struct ThreeDCoordinate tmp_3d_base, tmp_3d_new;
-                    memset( &tmp_3d_base, 0x0, sizeof(tmp_3d_base));
-                    memset( &tmp_3d_new, 0x0, sizeof(tmp_3d_new));
-                    sscanf(FDS_DynIn[k].ColVal[i],"%lf|%lf|%lf|%lf|%lf|%lf",
-                       &(tmp_3d_base.x1), &(tmp_3d_base.x2), &(tmp_3d_base.y1), &(tmp_3d_base.y2), &(tmp_3d_base.z1), &(tmp_3d_base.z2));
-                    sscanf(FDS_InputsVar[1].ColVal[i],"%lf|%lf|%lf|%lf|%lf|%lf",
-                       &(tmp_3d_new.x1), &(tmp_3d_new.x2), &(tmp_3d_new.y1), &(tmp_3d_new.y2), &(tmp_3d_new.z1), &(tmp_3d_new.z2));
-                    // find the input base value from the 3d coordinates by comparing with the input new value
-                    // note that the base and new parameters are inverted to get the input base value
-                    if( FindDiffDC(tmp_3d_base, tmp_3d_new, &tmp_d) != 0 ) 
-                    {
-                        printf( "FindDiffDC() error! base_value=[%s], new_value=[%s]\n", FDS_DynIn[k].ColVal[i], FDS_InputsVar[1].ColVal[i] );
-                        return -1;
-                    }
-                    tmp_add = tmp_one_sen*(tmp_input-tmp_d);
+                    printf( "FindDiffDC() error! base_value=[%s], new_value=[%s]\n", FDS_DynIn[k].ColVal[i], FDS_InputsVar[1].ColVal[i] );
+                    rt = -1;
+                    break;
                 }
-                tmp_colval_SMT[k] += tmp_add; //sum the additions from sensitivity matrix 
-
+                tmp_d[(k-1)*tmp_nin+i] = tmp_input-tmp_gd;
             }
         }
+    }
+
+    if( rt == 0 )
+    {
+        double tmp_base[MAXOUTPUTSNUM];
+
+        for( j=0; j<tmp_nout; j++ )
+            tmp_base[j] = atof(FDS_OutputsVar[1].ColVal[j]); //initiallize the output data with the outputbase value
+        SenMatrixGemm( tmp_d, tmp_rows, tmp_nin, tmp_s, tmp_nout, tmp_base, tmp_p ); //sum the additions from sensitivity matrix 
+        tmp_t1 = FPMNowNs();
+        FPMStatAdd( FPMSTAGESMT, tmp_t1 - tmp_t0 );
 
-        for( k=1; k<MAXLINENUM-1;k++) //dealing with RSM fields
+        // the RSM coefficients of the inputs and outputs are compiled once for the records
+        if( RSMCoefs.src != FDS_RSMResults )
+            RSMCoefBuild( FDS_RSMResults, &RSMCoefs );
+        if( RSMEvalCompile(&RSMCoefs, tmp_in, tmp_nin, tmp_out, tmp_nout, &tmp_ev) != 0 || RSMEvalBatch(&tmp_ev, tmp_x, tmp_rows, tmp_r) != 0 )
         {
-            if( strlen(trim(FDS_OutputsRltSMT[k].ColName,NULL)) == 0 )
-                break;
-/*
-            if( strcmp(FDS_OutputsRltSMT[k].ColName,"BaseValue") == 0 )
-                break;
-*/
-            sprintf( FDS_OutputsRltSMT[k].ColVal[j], "%.2lf", tmp_colval_SMT[k] ); //fill into SMT field  
-            if( GetOnePvFromRSMRlt( InputAlias[k], InputNewValue[k],FDS_OutputsVar[0].ColVal[j],  FDS_RSMResults, &(tmp_colval_RSM[k]) ) != 0  )
-            {
-                printf( "GetOnePvFromRSMRlt() error! k=%d, j=%d, InputAlias=%s, InputNewValue=%s,OutputAlias=%s\n", k, j, InputAlias[k], InputNewValue[k], FDS_OutputsVar[0].ColVal[j] );
-                return -1;
-            }
-            sprintf( FDS_OutputsRltRSM[k].ColVal[j], "%.2lf", tmp_colval_RSM[k] ); //fill into RSM field
+            printf( "RSMEvalCompile() error! the RSM coefficients of the inputs and outputs are not complete in RSMRlt.csv\n" );
+            rt = -1;
+        }
+        tmp_t0 = FPMNowNs();
+        FPMStatAdd( FPMSTAGERSM, tmp_t0 - tmp_t1 );
+    }
+
+    for( j=0; j<tmp_nout && rt == 0; j++) //for each output variable
+    {
+        sprintf( FDS_OutputsRltSMT[0].ColVal[j],"%s_SMT", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
+        sprintf( FDS_OutputsRltRSM[0].ColVal[j],"%s_RSM", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
+        sprintf( tmp_base_name[j],"%s_BAS", FDS_OutputsVar[0].ColVal[j]);//initiallize table head, namely the first line
+
+        for( k=1; k<=tmp_rows; k++ ) //dealing with SMT and RSM fields
+        {
+            sprintf( FDS_OutputsRltSMT[k].ColName,"%s", FDS_DynIn[k].ColName );//initiallize the output data sequence with the input dynamic data;
+            sprintf( FDS_OutputsRltSMT[k].ColVal[j], "%.2lf", tmp_p[(k-1)*tmp_nout+j] ); //fill into SMT field  
+            sprintf( FDS_OutputsRltRSM[k].ColVal[j], "%.2lf", tmp_r[(k-1)*tmp_nout+j] ); //fill into RSM field
         }
+    }
 
-        //the last line shows the base value since here k points to the last line
-        /*if( j== 0)  // only set the "BaseValue" one time
-            sprintf( FDS_OutputsRltSMT[k].ColName, "%s", "BaseValue");
-        sprintf( FDS_OutputsRltSMT[k].ColVal[j], "%s", FDS_OutputsVar[1].ColVal[j]);
-        sprintf( FDS_OutputsRltRSM[k].ColVal[j], "%s", FDS_OutputsVar[1].ColVal[j]);
-        */
-        //printf( "k=%d,j=%d, basevalue=%s\n", k, j, FDS_OutputsRltSMT[k].ColVal[j] );
+    free( tmp_d );
+    free( tmp_p );
+    free( tmp_x );
+    free( tmp_r );
+    if( rt != 0 )
+    {
+        fclose(fp);
+        return -1;
     }
 
     //printf( "start = %d\n", start );
@@ -338,7 +485,9 @@ int UpdateFPM(char *_FPM_fn )
                     double tmp_gap = atof(FDS_OutputsRltSMT[k].ColVal[j])-atof(FDS_OutputsVar[1].ColVal[j]);
 
                     memset( tmp_measures, 0x0, sizeof(tmp_measures) );
-                    CalMeasures(SenMatx, FDS_OutputsVar[0].ColVal[j], tmp_gap, tmp_measures );
+                    tmp_t1 = FPMNowNs();
+                    CalMeasures(&SenMatxNum, SymID(&(FPMSyms.out), FDS_OutputsVar[0].ColVal[j], 0), tmp_gap, tmp_measures );
+                    tmp_mea += FPMNowNs() - tmp_t1;
 
                     printf( "\t%12s*", FDS_OutputsRltSMT[k].ColVal[j] );
                     printf( "\t%s", tmp_measures );
@@ -400,6 +549,8 @@ int UpdateFPM(char *_FPM_fn )
     }
 
     fclose(fp);
+    FPMStatAdd( FPMSTAGEMEA, tmp_mea );
+    FPMStatAdd( FPMSTAGEEMIT, FPMNowNs() - tmp_t0 - tmp_mea );
     return 0;
 }
 
@@ -408,13 +559,17 @@ int readinRSMRlt( char *_RSMRlt_fn, struct RSMResults *_RSMRlt )
 {
     int i=0;
     char Info[MAXSTRINGSIZE];
-    FILE *fp = fopen( _RSMRlt_fn, "r" );
+    unsigned long tmp_snap=0;
+    FILE *fp = FPMSnapOpen( _RSMRlt_fn, &tmp_snap ); // a snapshot being written is never read
     if ( fp == NULL )
     {
        printf( "fopen() error, _smt_fn=[%s]\n",  _RSMRlt_fn);
        return -1;
     }
+    if( tmp_snap > 0 )
+       printf( "processing snapshot [%lu] of _RSMRlt_fn=[%s]...\n", tmp_snap, _RSMRlt_fn );
     
+    memset( _RSMRlt, '\0', sizeof(struct RSMResults)*(MAXINPUTSNUM+1)*(MAXOUTPUTSNUM+1) ); // the former results are kept if the file cannot be read
     memset(Info, '\0', sizeof (Info));
 
     while ( fgets( Info, sizeof(Info), fp) != NULL )
@@ -439,22 +594,25 @@ int readinRSMRlt( char *_RSMRlt_fn, struct RSMResults *_RSMRlt )
     return 0;
 }
 
-//read in sensitivity matrix from _smt_fn and save to _sen_matx 
-int readinSMT( char *_smt_fn, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][128] )
+//read in sensitivity matrix from _smt_fn and save to _sm, the values are parsed once here and the alias index is built for the predictions
+int readinSMT( char *_smt_fn, struct SenMatrix *_sm )
 {
     int i=0,j=0;
     char Info[MAXSTRINGSIZE];
-    FILE *fp = fopen( _smt_fn, "r" );
+    unsigned long tmp_snap=0;
+    FILE *fp = FPMSnapOpen( _smt_fn, &tmp_snap ); // a snapshot being written is never read
     if ( fp == NULL )
     {
        printf( "fopen() error, _smt_fn=[%s]\n",  _smt_fn );
        return -1;
     }
 
-    printf( "precessing _smt_fn=[%s]...\n",  _smt_fn );
+    printf( "precessing _smt_fn=[%s], snapshot [%lu]...\n",  _smt_fn, tmp_snap );
 
+    SenMatrixClear( _sm );
     memset(Info, '\0', sizeof (Info));
 
+    // the first line holds "dy/dx" and the output aliases, every other line holds an input alias and its sensitivities
     while ( fgets( Info, sizeof(Info), fp) != NULL )
     {
         char *token=NULL;
@@ -463,15 +621,34 @@ int readinSMT( char *_smt_fn, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][12
         j=0;
         while ( token != NULL )
         {
+           char tmp_cell[128];
+
            if( strlen(token) == 0 )
                break;
-           sprintf( _sen_matx[i][j], "%s", token );   
+           memset( tmp_cell, 0x0, sizeof(tmp_cell) );
+           snprintf( tmp_cell, sizeof(tmp_cell), "%s", token );
+           trim( tmp_cell, NULL );
+           if( i == 0 && j > 0 )
+           {
+               sprintf( _sm->out_alias[j-1], "%s", tmp_cell );
+               if( strlen(tmp_cell) > 0 && j > _sm->nout )
+                   _sm->nout = j;
+           } else if( i > 0 && j == 0 )
+           {
+               if( strlen(tmp_cell) == 0 )
+                   break;
+               sprintf( _sm->in_alias[i-1], "%s", tmp_cell );
+               _sm->nin = i;
+           } else if( i > 0 && j > 0 )
+               _sm->sen[i-1][j-1] = atof( tmp_cell );
            token = strtok(NULL, "," );
            j++;
            if( j>MAXOUTPUTSNUM )
                break;
            printf( "inner while: token = [%s], i=%d, j=%d \n", token, i, j );       
         }
+        if( i > 0 && _sm->nin < i ) // an empty line ends the matrix
+            break;
         i++;
         if( i>MAXINPUTSNUM )
             break;
@@ -479,90 +656,183 @@ int readinSMT( char *_smt_fn, char _sen_matx[MAXINPUTSNUM+1][MAXOUTPUTSNUM+1][12
 
     fclose(fp);
 
-    for( i=0; i<=MAXINPUTSNUM; i++ )
+    SenMatrixIndex( _sm );
+    for( i=0; i<_sm->nin; i++ )
     {// output the sensitivity matrix to stdout
-        if( strlen(trim(_sen_matx[i][0],NULL)) == 0 )   
-            break;
-        for(j=0; j<=MAXOUTPUTSNUM; j++ )
-        {
-            if( strlen(trim(_sen_matx[i][j],NULL)) != 0 )   
-                printf( " sen[%d][%d]= %s,", i,j,_sen_matx[i][j] );
-        }
+        printf( " sen[%d]= %s,", i, _sm->in_alias[i] );
+        for(j=0; j<_sm->nout; j++ )
+            printf( " %lf,", _sm->sen[i][j] );
         printf( "\n" );
     }
       
     return 0;
 }
 
-// read in the dynamically changed input data (Dyn.txt ) and save to _DI
-int readinDyn(char *_Dyn_fn, struct VarInCol *_DI ) 
+/*************************************************************************************************************************************************
+ * the position FirePM has reached in the dynamically changed input data (Dyn.txt). Dyn.txt is an input log which only grows, so only the records
+ * appended behind offset are read in. a line is consumed only when it ends with '\n', a line being written is read in at the next time. if the
+ * file is replaced (another inode), truncated or rewritten in place (e.g. by GSD, the bytes before offset are not the consumed ones any more),
+ * it is read from the beginning again. a snapshot of Dyn.txt (see FPMSnapOpen()) is always another inode, it is read from the beginning after
+ * its head
+ *************************************************************************************************************************************************/
+struct DynTail
+{
+    dev_t dev;        // the device of the file being followed
+    ino_t ino;        // the inode of the file being followed
+    off_t offset;     // the bytes consumed
+    long seq;         // the records consumed
+    int head;         // 1: the explanatory line and the head line have been consumed
+    char mark[64];    // the last bytes consumed, namely the bytes before offset
+    int nmark;        // the length of mark
+    unsigned long snap; // the sequence of the snapshot being followed, 0: not a snapshot
+};
+
+// return 1 if the bytes before the offset of _tail in fp are the ones consumed, 0 if not
+int DynTailMarked( FILE *fp, const struct DynTail *_tail )
+{
+    char tmp_mark[sizeof(_tail->mark)];
+
+    if( _tail->nmark == 0 )
+        return 1;
+    if( fseeko(fp, _tail->offset - _tail->nmark, SEEK_SET) != 0 || fread(tmp_mark, 1, _tail->nmark, fp) != (size_t)_tail->nmark )
+        return 0;
+    return memcmp( tmp_mark, _tail->mark, _tail->nmark ) == 0;
+}
+
+// remember the bytes before the offset of _tail in fp
+void DynTailMark( FILE *fp, struct DynTail *_tail )
+{
+    _tail->nmark = _tail->offset < (off_t)sizeof(_tail->mark) ? (int)_tail->offset : (int)sizeof(_tail->mark);
+    if( fseeko(fp, _tail->offset - _tail->nmark, SEEK_SET) != 0 || fread(_tail->mark, 1, _tail->nmark, fp) != (size_t)_tail->nmark )
+        _tail->nmark = 0;
+}
+
+// split one line of Dyn.txt into the sequence (ColName) and the input values (ColVal) of _DI
+void DynLineParse( char *_line, struct VarInCol *_DI )
+{
+    int j=0;
+    char *token=NULL;
+
+    token = strtok(_line, "," );
+    while ( token != NULL )
+    {
+       if( j ==0 )
+           sprintf( _DI->ColName, "%s", token );
+       else {
+           sprintf( _DI->ColVal[j-1], "%s", token);
+       }
+       token = strtok(NULL, "," );
+       j++;
+       if( j>MAXINPUTSNUM )
+           break;
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: read in the records appended to the dynamically changed input data (Dyn.txt) since the last call. _DI[0] keeps the head line, the new
+ *           records are put into _DI[1], _DI[2], ... and at most MAXLINENUM-2 records are read in at one time so that the memory is bounded, the
+ *           caller should call it again when *_num is MAXLINENUM-2
+ * _Dyn_fn: input parameter indicating the file name of the dynamically changed input data
+ * _tail: input/output parameter indicating the position reached in _Dyn_fn
+ * _DI: output parameter holding the head line and the new records
+ * _num: output parameter indicating the number of the new records
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int readinDyn(char *_Dyn_fn, struct DynTail *_tail, struct VarInCol *_DI, int *_num ) 
 {
     int i=0,j=0;
     char Info[MAXSTRINGSIZE];
-    FILE *fp = fopen( _Dyn_fn, "r" );
+    struct stat tmp_st;
+    unsigned long tmp_snap=0;
+    off_t tmp_base=0;   // the offset of the first line, after the head of a snapshot
+    FILE *fp = NULL;
+
+    *_num = 0;
+    memset( &(_DI[1]), 0x0, sizeof(struct VarInCol)*(MAXLINENUM-1) );
+    if( stat(_Dyn_fn, &tmp_st) != 0 && errno == ENOENT ) // not yet created, it is read in when it is created
+    {
+        printf( "%s does not exist yet\n", _Dyn_fn );
+        return 0;
+    }
+
+    // an incomplete snapshot is not read, the complete one published next is
+    fp = FPMSnapOpen( _Dyn_fn, &tmp_snap );
     if ( fp == NULL )
+       return 0;
+    if( fstat(fileno(fp), &tmp_st) != 0 )
     {
-       printf( "fopen() error, _smt_fn=[%s]\n",  _Dyn_fn);
+       printf( "fstat() error, _Dyn_fn=[%s]\n",  _Dyn_fn);
+       fclose(fp);
        return -1;
     }
+    tmp_base = ftello(fp);
+    if( tmp_snap > 0 && tmp_snap <= _tail->snap && (tmp_st.st_dev != _tail->dev || tmp_st.st_ino != _tail->ino) )
+        printf( "the snapshot sequence of %s goes back from [%lu] to [%lu], its writer is restarted\n", _Dyn_fn, _tail->snap, tmp_snap );
+    if( tmp_st.st_dev != _tail->dev || tmp_st.st_ino != _tail->ino || tmp_st.st_size < _tail->offset )
+    {
+        if( _tail->head == 1 && tmp_snap == 0 )
+            printf( "%s is replaced or truncated, it is read from the beginning\n", _Dyn_fn );
+        memset( _tail, 0x0, sizeof(struct DynTail) );
+        _tail->dev = tmp_st.st_dev;
+        _tail->ino = tmp_st.st_ino;
+        _tail->offset = tmp_base;
+        _tail->snap = tmp_snap;
+    }
+
+    if( DynTailMarked(fp, _tail) == 0 )
+    {
+        printf( "%s is rewritten, it is read from the beginning\n", _Dyn_fn );
+        memset( _tail, 0x0, sizeof(struct DynTail) );
+        _tail->dev = tmp_st.st_dev;
+        _tail->ino = tmp_st.st_ino;
+        _tail->offset = tmp_base;
+        _tail->snap = tmp_snap;
+    }
+    if( tmp_st.st_size == _tail->offset || fseeko(fp, _tail->offset, SEEK_SET) != 0 )
+    {
+        fclose(fp);
+        return 0;
+    }
 
     memset(Info, '\0', sizeof (Info));
 
-    printf( "precess dynamically changed input data: _Dyn_fn=[%s]...\n", _Dyn_fn );
-    if ( fgets( Info, sizeof(Info), fp) == NULL ) // we don't use the first line which is only explanatory informaiton 
+    printf( "precess dynamically changed input data: _Dyn_fn=[%s], offset=[%ld], seq=[%ld]...\n", _Dyn_fn, (long)_tail->offset, _tail->seq );
+    while ( _tail->head == 0 && fgets( Info, sizeof(Info), fp) != NULL )
     {
-        // try close the file and reopen and reread, because another process is updating the file of _Dyn_fn
-        fclose(fp);
-        sleep(0.5); //if the first time fails, then sleep half second and reopen  the file since this file maybe being written by another process 
-        fp=fopen(_Dyn_fn,"r");
-        if ( fp == NULL )
-        {
-            printf( "fopen() error, _smt_fn=[%s]\n",  _Dyn_fn);
-            return -1;
-        }
-        if( fgets(Info, sizeof(Info), fp) == NULL )
+        if( Info[strlen(Info)-1] != '\n' ) // the line is being written
+            break;
+        // we don't use the first line which is only explanatory informaiton, the second line is the head line
+        if( _tail->offset > tmp_base )
         {
-            printf( "fgets() error! empty file: _Dyn_fn=%s\n", _Dyn_fn );
-            fclose(fp);
-            return -1;
+            memset( &(_DI[0]), 0x0, sizeof(struct VarInCol) );
+            DynLineParse( Info, &(_DI[0]) );
+            _tail->head = 1;
         }
+        _tail->offset = ftello(fp);
     }
 
-    while ( fgets( Info, sizeof(Info), fp) != NULL )
+    while ( _tail->head == 1 && i < MAXLINENUM-2 && fgets( Info, sizeof(Info), fp) != NULL )
     {
-        char *token=NULL;
-        token = strtok(Info, "," );
-        j=0;
-        while ( token != NULL )
-        {
-           if( j ==0 )
-               sprintf( _DI[i].ColName, "%s", token );
-           else {
-               sprintf( _DI[i].ColVal[j-1], "%s", token);
-           }
-           printf( "token = %s, i=%d, j=%d\n", token, i, j );
-           token = strtok(NULL, "," );
-           j++;
-           if( j>MAXINPUTSNUM )
-               break;
-        }
-        i++;
-        if( i>MAXLINENUM)
+        if( Info[strlen(Info)-1] != '\n' ) // the line is being written
             break;
+        _tail->offset = ftello(fp);
+        if( strlen(trim(Info, NULL)) == 0 )
+            continue;
+        DynLineParse( Info, &(_DI[i+1]) );
+        _tail->seq++;
+        i++;
     }
+    DynTailMark( fp, _tail );
     fclose(fp);
+    *_num = i;
 
-    for( i=0;i<MAXLINENUM; i++ )
-    {//output the Dyn.txt to stdout
-        if( i>0 )
-        {
-            if(strlen(trim(_DI[i].ColName, NULL))==0)
-                break;
-        }
+    for( i=0;i<=*_num; i++ )
+    {//output the head line and the new records to stdout
         for( j=0; j<=MAXINPUTSNUM; j++ )
         {
             if( j==0 )
-                printf( "%s,", _DI[i].ColName );
+                printf( "%s,", trim(_DI[i].ColName, NULL) );
             else
             {
                 if( strlen(trim(_DI[i].ColVal[j-1], NULL) )== 0 )
@@ -573,99 +843,1166 @@ int readinDyn(char *_Dyn_fn, struct VarInCol *_DI )
         printf( "\n" );
     }
 
-    printf( "after precessing dynamically changed input data: _Dyn_fn=[%s]\n", _Dyn_fn );
+    printf( "after precessing dynamically changed input data: _Dyn_fn=[%s], [%d] new records, offset=[%ld], seq=[%ld]\n", _Dyn_fn, *_num, (long)_tail->offset, _tail->seq );
     return 0;
 }
 
-int main( int argc, char ** argv )
+/*************************************************************************************************************************************************
+ * the files FirePM reacts to. inotify reports a file as soon as it is closed after writing or renamed into the working directory, the files are
+ * also checked by their modified time and size once a second so that a file system without inotify support (e.g. NFS) still works
+ *************************************************************************************************************************************************/
+#define FPMWATCHNUM 3
+#define FPMWATCHSMT 0
+#define FPMWATCHRSM 1
+#define FPMWATCHDYN 2
+
+struct FPMWatch
 {
-    char *tmp_ret=NULL;
-    time_t tmp_t1_SMT=0, tmp_t2_SMT=0;
-    time_t tmp_t1_Dyn=0, tmp_t2_Dyn=0;
-    time_t tmp_t1_RSMRlt=0, tmp_t2_RSMRlt=0;
-    
-    if ( argc != 2 )
-    {
-        int i=0;
-        for ( i=0; i<argc; i++ )
-           printf( "%s\n", argv[i] );
-        printf( "only one argument is needed, you have [%d] arguments\n" , argc);
-        return -1;
-    }
-    memset( FDS_SmInfo, '\0', sizeof(FDS_SmInfo));
-    memset( SenMatx, '\0', sizeof(SenMatx));
-    memset( FDS_InputsVar, '\0', sizeof(FDS_InputsVar));
-    memset( FDS_OutputsVar, '\0', sizeof(FDS_OutputsVar));
-    memset( FDS_OutputsRltSMT, '\0', sizeof(FDS_OutputsRltSMT));
-    memset( FDS_DynIn, '\0', sizeof(FDS_DynIn));
+    char fn[128];            // the file name in the working directory
+    struct timespec mtime;   // the modified time when the file was checked last time
+    off_t size;              // the size when the file was checked last time
+    int changed;             // 1: the file should be read in again
+};
 
-    if ( readin(argv[1], FDS_SmInfo) != 0 ){ 
-        printf( "read SMInfo to structure error!\n" );
-        return -1;
-    }
-    if( GetVIC(FDS_SmInfo, FDS_InputsVar) != 0 )
-    {
-        printf( "GetVIC() error!\n" );
-        return -1;
-    }
-    if( GetVOC(FDS_SmInfo, FDS_OutputsVar) != 0 )
-    {
-        printf( "GetVOC() error!\n" );
-        return -1;
-    }
+// check the modified time and size of one watched file, mark it changed if either differs from the last check
+void FPMWatchStat( struct FPMWatch *_fw )
+{
+    struct stat tmp_st;
 
- while(1)
- {
-    sleep(1);
-    tmp_t2_SMT=getFileModifiedTime("SMT.csv");
-    if( tmp_t2_SMT !=tmp_t1_SMT )
+    if( stat(_fw->fn, &tmp_st) != 0 )
+        return;
+    if( tmp_st.st_mtim.tv_sec != _fw->mtime.tv_sec || tmp_st.st_mtim.tv_nsec != _fw->mtime.tv_nsec || tmp_st.st_size != _fw->size )
+        _fw->changed = 1;
+    _fw->mtime = tmp_st.st_mtim;
+    _fw->size = tmp_st.st_size;
+}
+
+// set the watched files of the working directory, all of them are marked changed so that they are read in at the first time
+void FPMWatchFiles( struct FPMWatch *_fw )
+{
+    int i=0;
+
+    memset( _fw, 0x0, sizeof(struct FPMWatch)*FPMWATCHNUM );
+    sprintf( _fw[FPMWATCHSMT].fn, "%s", "SMT.csv" );
+    sprintf( _fw[FPMWATCHRSM].fn, "%s", "RSMRlt.csv" );
+    sprintf( _fw[FPMWATCHDYN].fn, "%s", "Dyn.txt" );
+    for( i=0; i<FPMWATCHNUM; i++ )
     {
-        memset( SenMatx, '\0', sizeof(SenMatx));
-        if( readinSMT("SMT.csv", SenMatx) != 0 )
-        {
-            printf( "readinSMT() error!\n" );
-            return -1;
-        }
-        tmp_t1_SMT=tmp_t2_SMT;
-    } else {
-       printf( "no modification made to SMT.csv since %s.\n", ctime(&tmp_t1_SMT) ) ;
+        FPMWatchStat( &(_fw[i]) );
+        _fw[i].changed = 1;
     }
+}
+
+/*************************************************************************************************************************************************
+ * Function: start watching the files, all of them are marked changed so that they are read in at the first time
+ * _fw: output parameter indicating the watched files, _fw[FPMWATCHSMT], _fw[FPMWATCHRSM] and _fw[FPMWATCHDYN]
+ * Return: the inotify descriptor, -1 if inotify is not available and the files are checked every second
+ *************************************************************************************************************************************************/
+int FPMWatchInit( struct FPMWatch *_fw )
+{
+    int tmp_ifd=-1;
+
+    FPMWatchFiles( _fw );
 
-    tmp_t2_RSMRlt=getFileModifiedTime("RSMRlt.csv");
-    if( tmp_t2_RSMRlt!=tmp_t1_RSMRlt)
+    // the directory is watched instead of the files, a file replaced by rename() is still reported
+    tmp_ifd = inotify_init1( IN_NONBLOCK );
+    if( tmp_ifd < 0 )
+        printf( "inotify_init1() failed, the files are checked every second\n" );
+    else if( inotify_add_watch(tmp_ifd, ".", IN_CLOSE_WRITE | IN_MOVED_TO) < 0 )
     {
-        memset( FDS_RSMResults, '\0', sizeof(FDS_RSMResults));
-        if( readinRSMRlt("RSMRlt.csv", FDS_RSMResults) != 0 )
-        {
-            printf( "readinSMT() error!\n" );
-            return -1;
-        }
-        tmp_t1_RSMRlt=tmp_t2_RSMRlt;
-    } else {
-       printf( "no modification made to SMT.csv since %s.\n", ctime(&tmp_t1_RSMRlt) ) ;
+        printf( "inotify_add_watch() failed, the files are checked every second\n" );
+        close( tmp_ifd );
+        tmp_ifd = -1;
     }
+    return tmp_ifd;
+}
 
-    tmp_t2_Dyn = getFileModifiedTime("Dyn.txt");
-    if( tmp_t2_Dyn != tmp_t1_Dyn )
-    {
-        memset( FDS_OutputsRltSMT, '\0', sizeof(FDS_OutputsRltSMT));
-        memset( FDS_OutputsRltRSM, '\0', sizeof(FDS_OutputsRltRSM));
-        memset( FDS_DynIn, '\0', sizeof(FDS_DynIn));
-        if( readinDyn("Dyn.txt", FDS_DynIn ) != 0 )
-        {
-            printf( "readinDyn() error!\n" );
+/*************************************************************************************************************************************************
+ * the streaming ingest: besides Dyn.txt, FirePM can take the records of the dynamically changed input data from a Unix domain socket (-u) and
+ * a named pipe (-p), both served by the poll() loop of FPMWatchWait() so that many producers are multiplexed without threads. a record is a line
+ * of Dyn.txt ("Time,value1,value2,...\n") or the same text framed by a 4-byte big-endian length (a frame starts with a 0 byte, a line never
+ * does). the values are in the column order of Dyn.txt (the order of the configuration file if there is no Dyn.txt), and a producer may send a
+ * head line ("Time,alias1,alias2,...") first to give its own order.
+ * FirePM can also create a shared memory ring (-s, see FPMRingOpen()) carrying binary records in the column order of the configuration file,
+ * FPMWatchWait() then spins on the ring instead of sleeping in poll(), so a record is taken without any system call.
+ * the records are queued and predicted as soon as the loop wakes up, at most MAXLINENUM-2 of them at one time
+ *************************************************************************************************************************************************/
+#define FPMMAXCONNS 64
+
+struct FPMConn
+{
+    int fd;                   // -1: the slot is free
+    int keep;                 // 1: the named pipe, it is not closed at the end of a stream
+    int len;                  // the bytes in buf
+    int has_head;             // 1: head holds the column order of the producer
+    struct VarInCol head;     // the head line of the producer
+    char buf[MAXSTRINGSIZE];  // the bytes read but not yet consumed
+};
+
+struct FPMIngest
+{
+    int on;                                 // 1: the socket or the named pipe is opened
+    int lfd;                                // the listening socket, -1: no socket
+    int num;                                // the records queued
+    long seq;                               // the records received
+    struct FPMRing *ring;                   // the shared memory ring, NULL: no ring
+    long long stamp;                        // the stamp of the oldest record queued from the ring, 0: none
+    struct FPMConn conn[FPMMAXCONNS];
+    struct VarInCol rec[MAXLINENUM];        // the records queued, rec[1] ... rec[num] in the column order of the configuration file
+};
+
+struct FPMIngest FPMIng;
+
+// add a connection to the ingest, return -1 if there is no free slot
+int FPMIngestAdd( struct FPMIngest *_ing, int _fd, int _keep )
+{
+    int i=0;
+
+    for( i=0; i<FPMMAXCONNS; i++ )
+    {
+        if( _ing->conn[i].fd >= 0 )
+            continue;
+        memset( &(_ing->conn[i]), 0x0, sizeof(struct FPMConn) );
+        _ing->conn[i].fd = _fd;
+        _ing->conn[i].keep = _keep;
+        return 0;
+    }
+    return -1;
+}
+
+/*************************************************************************************************************************************************
+ * Function: open the Unix domain socket, the named pipe and the shared memory ring of the streaming ingest
+ * _ing: output parameter indicating the ingest
+ * _sock_fn: input parameter indicating the path of the socket, NULL: no socket
+ * _pipe_fn: input parameter indicating the path of the named pipe, NULL: no pipe
+ * _ring_fn: input parameter indicating the path of the ring (e.g. /dev/shm/FirePM.ring), it is created with the inputs of FDS_InputsVar,
+ *           NULL: no ring
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMIngestInit( struct FPMIngest *_ing, const char *_sock_fn, const char *_pipe_fn, const char *_ring_fn )
+{
+    int i=0;
+
+    memset( _ing, 0x0, sizeof(struct FPMIngest) );
+    _ing->lfd = -1;
+    for( i=0; i<FPMMAXCONNS; i++ )
+        _ing->conn[i].fd = -1;
+
+    if( _sock_fn != NULL )
+    {
+        struct sockaddr_un tmp_addr;
+
+        memset( &tmp_addr, 0x0, sizeof(tmp_addr) );
+        tmp_addr.sun_family = AF_UNIX;
+        if( strlen(_sock_fn) >= sizeof(tmp_addr.sun_path) )
+        {
+            printf( "the socket path is too long: [%s]\n", _sock_fn );
+            return -1;
+        }
+        sprintf( tmp_addr.sun_path, "%s", _sock_fn );
+        unlink( _sock_fn );
+        _ing->lfd = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+        if( _ing->lfd < 0 || bind(_ing->lfd, (struct sockaddr *)&tmp_addr, sizeof(tmp_addr)) != 0 || listen(_ing->lfd, FPMMAXCONNS) != 0 )
+        {
+            printf( "cannot listen on the socket [%s]: %s\n", _sock_fn, strerror(errno) );
+            return -1;
+        }
+        printf( "listening on the socket [%s]\n", _sock_fn );
+        _ing->on = 1;
+    }
+
+    if( _pipe_fn != NULL )
+    {
+        int tmp_fd = -1;
+
+        if( mkfifo(_pipe_fn, 0666) != 0 && errno != EEXIST )
+        {
+            printf( "mkfifo() error, _pipe_fn=[%s]: %s\n", _pipe_fn, strerror(errno) );
+            return -1;
+        }
+        // opened for reading and writing, so the pipe never reaches the end when the producers come and go
+        tmp_fd = open( _pipe_fn, O_RDWR | O_NONBLOCK | O_CLOEXEC );
+        if( tmp_fd < 0 || FPMIngestAdd(_ing, tmp_fd, 1) != 0 )
+        {
+            printf( "cannot open the named pipe [%s]: %s\n", _pipe_fn, strerror(errno) );
+            return -1;
+        }
+        printf( "reading the named pipe [%s]\n", _pipe_fn );
+        _ing->on = 1;
+    }
+
+    if( _ring_fn != NULL )
+    {
+        _ing->ring = FPMRingOpen( _ring_fn, FDS_InputsVar );
+        if( _ing->ring == NULL )
+            return -1;
+        printf( "reading the shared memory ring [%s]\n", _ring_fn );
+        _ing->on = 1;
+    }
+    return 0;
+}
+
+// queue the records of the shared memory ring, the columns of the ring are the columns of the configuration file
+void FPMIngestRing( struct FPMIngest *_ing )
+{
+    struct FPMRingRec tmp_r;
+    int i=0, j=0;
+
+    while( _ing->num < MAXLINENUM-2 && FPMRingGet(_ing->ring, &tmp_r) == 0 )
+    {
+        struct VarInCol *tmp_q = &(_ing->rec[++_ing->num]);
+
+        _ing->seq++;
+        if( _ing->stamp == 0 )
+        {
+            _ing->stamp = tmp_r.stamp;
+            FPMStatAdd( FPMSTAGEDETECT, FPMNowNs() - tmp_r.stamp );
+        }
+        memset( tmp_q, 0x0, sizeof(struct VarInCol) );
+        if( strlen(tmp_r.timestr) > 0 ) // the text of the producer, as Dyn.txt and the sockets keep it
+            sprintf( tmp_q->ColName, "%.31s", tmp_r.timestr );
+        else
+            sprintf( tmp_q->ColName, "%.15g", tmp_r.time );
+        for( i=0; i<_ing->ring->nin; i++ )
+        {
+            int tmp_len = 0;
+            for( j=0; j<tmp_r.ncoord[i] && j<FPMRINGCOORD; j++ ) // a geometric value is written as x1|x2|y1|y2|z1|z2
+                tmp_len += sprintf( tmp_q->ColVal[i]+tmp_len, j == 0 ? "%.17g" : "|%.17g", tmp_r.v[i][j] );
+        }
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: take one record of a producer, a head line sets the column order of the producer, a data line is queued in the column order of the
+ *           configuration file
+ * _ing: input/output parameter indicating the ingest
+ * _c: input/output parameter indicating the producer
+ * _line: input parameter indicating the record, it is changed
+ * Return: void
+ *************************************************************************************************************************************************/
+void FPMIngestRecord( struct FPMIngest *_ing, struct FPMConn *_c, char *_line )
+{
+    int i=0, j=0;
+    char *tmp_end = NULL;
+    struct VarInCol tmp_rec, *tmp_q = NULL;
+    const struct VarInCol *tmp_head = NULL; // the column order of the values, NULL: the order of the configuration file
+
+    if( strlen(trim(_line, NULL)) == 0 )
+        return;
+    memset( &tmp_rec, 0x0, sizeof(tmp_rec) );
+    DynLineParse( _line, &tmp_rec );
+    for( j=0; j<MAXINPUTSNUM; j++ )
+        trim( tmp_rec.ColVal[j], NULL );
+    strtod( trim(tmp_rec.ColName, NULL), &tmp_end );
+    if( tmp_end == tmp_rec.ColName || *tmp_end != '\0' ) // not a number, namely a head line
+    {
+        memcpy( &(_c->head), &tmp_rec, sizeof(tmp_rec) );
+        _c->has_head = 1;
+        return;
+    }
+
+    _ing->num++;
+    _ing->seq++;
+    tmp_q = &(_ing->rec[_ing->num]);
+    if( _c->has_head == 1 )
+        tmp_head = &(_c->head);
+    else if( strlen(FDS_DynIn[0].ColVal[0]) > 0 ) // a producer without a head line writes the columns of Dyn.txt
+        tmp_head = &(FDS_DynIn[0]);
+    memset( tmp_q, 0x0, sizeof(struct VarInCol) );
+    sprintf( tmp_q->ColName, "%s", tmp_rec.ColName );
+    for( i=0; i<MAXINPUTSNUM; i++ )
+    {
+        if( strlen(FDS_InputsVar[0].ColVal[i]) == 0 )
+            break;
+        if( tmp_head == NULL )
+        {
+            sprintf( tmp_q->ColVal[i], "%s", tmp_rec.ColVal[i] );
+            continue;
+        }
+        for( j=0; j<MAXINPUTSNUM; j++ )
+        {
+            if( strcmp(tmp_head->ColVal[j], FDS_InputsVar[0].ColVal[i]) == 0 )
+            {
+                sprintf( tmp_q->ColVal[i], "%s", tmp_rec.ColVal[j] );
+                break;
+            }
+        }
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: cut the bytes read from a producer into records, the bytes of an incomplete record are kept for the next read
+ * _ing: input/output parameter indicating the ingest
+ * _c: input/output parameter indicating the producer
+ * Return: 0: success
+ *         -1: failure, the stream is broken (a record is longer than MAXSTRINGSIZE)
+ *************************************************************************************************************************************************/
+int FPMIngestCut( struct FPMIngest *_ing, struct FPMConn *_c )
+{
+    int tmp_used = 0, rt = 0;
+
+    while( tmp_used < _c->len && _ing->num < MAXLINENUM-2 )
+    {
+        char tmp_line[MAXSTRINGSIZE];
+        char *tmp_p = _c->buf + tmp_used;
+        int tmp_left = _c->len - tmp_used, tmp_n = 0;
+
+        if( tmp_p[0] == '\0' ) // a record framed by its length
+        {
+            if( tmp_left < 4 )
+                break;
+            tmp_n = ((unsigned char)tmp_p[0] << 24) | ((unsigned char)tmp_p[1] << 16) | ((unsigned char)tmp_p[2] << 8) | (unsigned char)tmp_p[3];
+            if( tmp_n >= MAXSTRINGSIZE-4 )
+            {
+                rt = -1;
+                break;
+            }
+            if( tmp_left < 4+tmp_n )
+                break;
+            memcpy( tmp_line, tmp_p+4, tmp_n );
+            tmp_line[tmp_n] = '\0';
+            tmp_used += 4+tmp_n;
+        } else { // a record ended by '\n'
+            char *tmp_nl = memchr( tmp_p, '\n', tmp_left );
+            if( tmp_nl == NULL )
+            {
+                if( tmp_left == MAXSTRINGSIZE )
+                    rt = -1;
+                break;
+            }
+            tmp_n = tmp_nl - tmp_p;
+            memcpy( tmp_line, tmp_p, tmp_n );
+            tmp_line[tmp_n] = '\0';
+            tmp_used += tmp_n+1;
+        }
+        FPMIngestRecord( _ing, _c, tmp_line );
+    }
+
+    if( rt != 0 )
+        tmp_used = _c->len; // the rest of the stream cannot be cut into records
+    memmove( _c->buf, _c->buf+tmp_used, _c->len-tmp_used );
+    _c->len -= tmp_used;
+    return rt;
+}
+
+// close a producer, the named pipe is only emptied
+void FPMIngestClose( struct FPMConn *_c )
+{
+    _c->len = 0;
+    _c->has_head = 0;
+    if( _c->keep == 1 )
+        return;
+    close( _c->fd );
+    _c->fd = -1;
+}
+
+/*************************************************************************************************************************************************
+ * Function: read what the producers have sent and accept the new producers, it is called when poll() reports them readable
+ * _ing: input/output parameter indicating the ingest
+ * _pfd: input parameter indicating the poll() results of the listening socket (_pfd[0]) and the producers (_pfd[1+i] for conn[i])
+ * Return: void
+ *************************************************************************************************************************************************/
+void FPMIngestRead( struct FPMIngest *_ing, const struct pollfd *_pfd )
+{
+    int i=0;
+
+    if( _ing->lfd >= 0 && (_pfd[0].revents & POLLIN) )
+    {
+        int tmp_fd = -1;
+        while( (tmp_fd = accept(_ing->lfd, NULL, NULL)) >= 0 )
+        {
+            if( fcntl(tmp_fd, F_SETFL, O_NONBLOCK) != 0 || FPMIngestAdd(_ing, tmp_fd, 0) != 0 )
+            {
+                printf( "too many producers, a new one is refused\n" );
+                close( tmp_fd );
+            }
+        }
+    }
+
+    for( i=0; i<FPMMAXCONNS; i++ )
+    {
+        struct FPMConn *tmp_c = &(_ing->conn[i]);
+        ssize_t tmp_n = 0;
+
+        if( tmp_c->fd < 0 || _pfd[1+i].fd != tmp_c->fd || (_pfd[1+i].revents & (POLLIN | POLLHUP | POLLERR)) == 0 )
+            continue;
+        tmp_n = read( tmp_c->fd, tmp_c->buf+tmp_c->len, sizeof(tmp_c->buf)-tmp_c->len );
+        if( tmp_n == 0 || (tmp_n < 0 && errno != EAGAIN && errno != EINTR) ) // the producer is gone
+        {
+            FPMIngestClose( tmp_c );
+            continue;
+        }
+        if( tmp_n > 0 )
+            tmp_c->len += tmp_n;
+        if( FPMIngestCut(_ing, tmp_c) != 0 )
+        {
+            printf( "a record longer than [%d] bytes, the producer is dropped\n", MAXSTRINGSIZE );
+            FPMIngestClose( tmp_c );
+        }
+    }
+}
+
+/*************************************************************************************************************************************************
+ * Function: predict the queued records and append the predictions to _FPM_fn, the records are put into FDS_DynIn in the column order of the
+ *           configuration file for UpdateFPM(), the head line of Dyn.txt (FDS_DynIn[0]) is kept
+ * _ing: input/output parameter indicating the ingest
+ * _FPM_fn: input parameter indicating the file name of FirePM tool (FirepM.csv)
+ * _num: output parameter indicating the number of the predicted records, the caller should call it again when it is MAXLINENUM-2
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMIngestFlush( struct FPMIngest *_ing, char *_FPM_fn, int *_num )
+{
+    int i=0, rt=0, tmp_n=0;
+    struct VarInCol tmp_head;
+
+    // the records left in the buffers by a full queue are cut first
+    for( i=0; i<FPMMAXCONNS && _ing->num < MAXLINENUM-2; i++ )
+    {
+        if( _ing->conn[i].fd >= 0 && _ing->conn[i].len > 0 && FPMIngestCut(_ing, &(_ing->conn[i])) != 0 )
+            FPMIngestClose( &(_ing->conn[i]) );
+    }
+    if( _ing->ring != NULL )
+        FPMIngestRing( _ing );
+    *_num = _ing->num;
+    if( _ing->num == 0 )
+        return 0;
+
+    // UpdateFPM() stops at the first empty row, so only the rows of the records and the one after them are cleared
+    tmp_n = _ing->num;
+    memcpy( &tmp_head, &(FDS_DynIn[0]), sizeof(tmp_head) );
+    memset( FDS_DynIn, 0x0, sizeof(struct VarInCol)*(tmp_n+2) );
+    sprintf( FDS_DynIn[0].ColName, "%s", strlen(tmp_head.ColName) > 0 ? tmp_head.ColName : "Time" );
+    for( i=0; i<MAXINPUTSNUM; i++ )
+        sprintf( FDS_DynIn[0].ColVal[i], "%s", FDS_InputsVar[0].ColVal[i] );
+    memcpy( &(FDS_DynIn[1]), &(_ing->rec[1]), sizeof(struct VarInCol)*tmp_n );
+    printf( "predicting [%d] streamed records, [%ld] received\n", tmp_n, _ing->seq );
+    _ing->num = 0;
+
+    memset( FDS_OutputsRltSMT, '\0', sizeof(struct VarOutCol)*(tmp_n+2) );
+    memset( FDS_OutputsRltRSM, '\0', sizeof(struct VarOutCol)*(tmp_n+2) );
+    rt = UpdateFPM( _FPM_fn );
+    if( _ing->stamp != 0 )
+    {
+        long long tmp_ns = FPMNowNs() - _ing->stamp;
+        FPMStatAdd( FPMSTAGETOTAL, tmp_ns );
+        printf( "the oldest record of the ring is predicted in [%.1lf] us\n", tmp_ns/1000.0 );
+        _ing->stamp = 0;
+    }
+    memset( FDS_DynIn, 0x0, sizeof(struct VarInCol)*(tmp_n+1) );
+    memcpy( &(FDS_DynIn[0]), &tmp_head, sizeof(tmp_head) );
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * Function: poll the watched files and the producers of the streaming ingest, at most _timeout milliseconds
+ * _ifd: input parameter indicating the inotify descriptor returned by FPMWatchInit(), -1: the timer only
+ * _fw: input/output parameter indicating the watched files, the written ones are marked changed
+ * _ing: input/output parameter indicating the streaming ingest, the records received are queued in it
+ * _timeout: input parameter indicating the longest time to sleep in milliseconds, 0: do not sleep
+ * Return: 0: something is written or received
+ *         1: nothing
+ *************************************************************************************************************************************************/
+int FPMWatchPoll( int _ifd, struct FPMWatch *_fw, struct FPMIngest *_ing, int _timeout )
+{
+    struct pollfd tmp_pfd[2+FPMMAXCONNS]; // inotify, the listening socket and the producers
+    int i=0, rt=1;
+
+    memset( tmp_pfd, 0x0, sizeof(tmp_pfd) );
+    tmp_pfd[0].fd = _ifd;
+    tmp_pfd[1].fd = _ing->lfd;
+    for( i=0; i<FPMMAXCONNS; i++ ) // a full queue is predicted first, the producers wait in their buffers until then
+        tmp_pfd[2+i].fd = _ing->num < MAXLINENUM-2 ? _ing->conn[i].fd : -1;
+    for( i=0; i<2+FPMMAXCONNS; i++ )
+        tmp_pfd[i].events = POLLIN;
+    if( poll(tmp_pfd, 2+FPMMAXCONNS, _timeout) > 0 )
+    {
+        char tmp_events[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t tmp_len = 0;
+
+        rt = 0;
+        FPMIngestRead( _ing, &(tmp_pfd[1]) );
+        while( _ifd >= 0 && (tmp_len = read(_ifd, tmp_events, sizeof(tmp_events))) > 0 )
+        {
+            char *tmp_p = tmp_events;
+            for( ; tmp_p < tmp_events + tmp_len; tmp_p += sizeof(struct inotify_event) + ((struct inotify_event *)tmp_p)->len )
+            {
+                struct inotify_event *tmp_ev = (struct inotify_event *)tmp_p;
+                for( i=0; i<FPMWATCHNUM && tmp_ev->len > 0; i++ )
+                {
+                    if( strcmp(tmp_ev->name, _fw[i].fn) == 0 )
+                        _fw[i].changed = 1;
+                }
+            }
+        }
+    }
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * Function: sleep until one of the watched files is written or a producer of the streaming ingest sends something, or at most _timeout milliseconds.
+ *           with a shared memory ring it spins on the ring instead of sleeping, and polls the files and the other producers once a millisecond
+ * _ifd: input parameter indicating the inotify descriptor returned by FPMWatchInit(), -1: the timer only
+ * _fw: input/output parameter indicating the watched files, the written ones are marked changed
+ * _ing: input/output parameter indicating the streaming ingest, the records received are queued in it
+ * _timeout: input parameter indicating the longest time to sleep in milliseconds
+ * Return: 0: woken up by inotify or the ingest
+ *         1: woken up by the timer
+ *************************************************************************************************************************************************/
+int FPMWatchWait( int _ifd, struct FPMWatch *_fw, struct FPMIngest *_ing, int _timeout )
+{
+    int i=0, rt=1;
+
+    if( _ing->ring == NULL )
+        rt = FPMWatchPoll( _ifd, _fw, _ing, _timeout );
+    else
+    {
+        long long tmp_now = FPMNowNs(), tmp_end = tmp_now + _timeout*1000000LL, tmp_poll = tmp_now;
+
+        while( rt == 1 && tmp_now < tmp_end )
+        {
+            if( _ing->num < MAXLINENUM-2 && FPMRingReady(_ing->ring) )
+            {
+                FPMIngestRing( _ing );
+                return 0; // the files are checked again by the next wait
+            }
+            if( tmp_now >= tmp_poll )
+            {
+                rt = FPMWatchPoll( _ifd, _fw, _ing, 0 );
+                tmp_poll = tmp_now + 1000000LL;
+            }
+            FPMRingPause();
+            tmp_now = FPMNowNs();
+        }
+    }
+
+    // the timer fallback, and the writes inotify does not report
+    for( i=0; i<FPMWATCHNUM; i++ )
+        FPMWatchStat( &(_fw[i]) );
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * Function: read in the files of the working directory written since the last call (SMT.csv, RSMRlt.csv) and predict the records appended to
+ *           Dyn.txt
+ * _fw: input/output parameter indicating the watched files, the changed ones are read in and marked unchanged
+ * _tail: input/output parameter indicating the position reached in Dyn.txt
+ * _timer: input parameter, 1: woken up by the timer, the files not changed are reported
+ * _started: input parameter, 0: the first call, the records found in Dyn.txt are not counted as changes in the latency statistics
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMUpdateFiles( struct FPMWatch *_fw, struct DynTail *_tail, int _timer, int _started )
+{
+    if( _fw[FPMWATCHSMT].changed == 1 )
+    {
+        _fw[FPMWATCHSMT].changed = 0;
+        if( readinSMT("SMT.csv", &SenMatxNum) != 0 ) // e.g. a snapshot being written by hand, it is read in when it is written again
+            printf( "readinSMT() error, the former sensitivity matrix is kept!\n" );
+    } else if( _timer == 1 ) {
+       printf( "no modification made to SMT.csv since %s.\n", ctime(&(_fw[FPMWATCHSMT].mtime.tv_sec)) ) ;
+    }
+
+    if( _fw[FPMWATCHRSM].changed == 1 )
+    {
+        _fw[FPMWATCHRSM].changed = 0;
+        if( readinRSMRlt("RSMRlt.csv", FDS_RSMResults) != 0 ) // the same as SMT.csv
+            printf( "readinRSMRlt() error, the former fitting parameters are kept!\n" );
+        else
+            RSMCoefBuild( FDS_RSMResults, &RSMCoefs );
+    } else if( _timer == 1 ) {
+       printf( "no modification made to RSMRlt.csv since %s.\n", ctime(&(_fw[FPMWATCHRSM].mtime.tv_sec)) ) ;
+    }
+
+    if( _fw[FPMWATCHDYN].changed == 1 )
+    {
+        int tmp_num=0;
+        long long tmp_t0=0, tmp_detect=FPMSinceNs(&(_fw[FPMWATCHDYN].mtime));
+
+        _fw[FPMWATCHDYN].changed = 0;
+        if( tmp_detect < 0 ) // the file time is coarser than the clock
+            tmp_detect = 0;
+        do{ // only the appended records are predicted, a window of at most MAXLINENUM-2 records at one time
+            memset( FDS_OutputsRltSMT, '\0', sizeof(FDS_OutputsRltSMT));
+            memset( FDS_OutputsRltRSM, '\0', sizeof(FDS_OutputsRltRSM));
+            tmp_t0 = FPMNowNs();
+            if( readinDyn("Dyn.txt", _tail, FDS_DynIn, &tmp_num ) != 0 )
+            {
+                printf( "readinDyn() error!\n" );
+                return -1;
+            }
+            FPMStatAdd( FPMSTAGEPARSE, FPMNowNs() - tmp_t0 );
+            if( tmp_num > 0 && _started == 1 && tmp_detect >= 0 ) // Dyn.txt found at the start is not a change
+                FPMStatAdd( FPMSTAGEDETECT, tmp_detect );
+            tmp_detect = -1; // the next windows are not detected again
+            if( tmp_num > 0 && UpdateFPM("FirePM.csv") != 0 )
+            {
+                printf( "UpdateFPM() error !\n" );
+                return -1;
+            }
+            if( tmp_num > 0 && _started == 1 )
+                FPMStatAdd( FPMSTAGETOTAL, FPMSinceNs(&(_fw[FPMWATCHDYN].mtime)) );
+        }while( tmp_num == MAXLINENUM-2 );
+    } else if( _timer == 1 ) {
+       printf( "no modification made to Dyn.txt since %s.\n", ctime(&(_fw[FPMWATCHDYN].mtime.tv_sec))) ; 
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: read in the configuration file and the output base values of the working directory into FDS_InputsVar and FDS_OutputsVar
+ * _cfg_fn: input parameter indicating the configuration file (SM_Info.txt)
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMLoadConfig( char *_cfg_fn )
+{
+    memset( FDS_SmInfo, '\0', sizeof(FDS_SmInfo));
+    memset( FDS_InputsVar, '\0', sizeof(FDS_InputsVar));
+    memset( FDS_OutputsVar, '\0', sizeof(FDS_OutputsVar));
+    if ( readin(_cfg_fn, FDS_SmInfo) != 0 ){ 
+        printf( "read SMInfo to structure error!\n" );
+        return -1;
+    }
+    if( GenBaseOutputs(basefile, FDS_SmInfo) != 0 ) // the output base values are searched only once at startup
+    {
+        printf( "GenBaseOutputs() error!\n" );
+        return -1;
+    }
+    if( GetVIC(FDS_SmInfo, FDS_InputsVar) != 0 )
+    {
+        printf( "GetVIC() error!\n" );
+        return -1;
+    }
+    if( GetVOC(FDS_SmInfo, FDS_OutputsVar) != 0 )
+    {
+        printf( "GetVOC() error!\n" );
+        return -1;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * the multi-building mode (-b list): one FirePM monitors the buildings listed in a file, one line "<directory> [<configuration file>]" for every
+ * building (SM_Info.txt by default, a line starting with '#' is a comment). a directory holds the files of its building (SMT.csv, RSMRlt.csv,
+ * Dyn.txt and FirePM.csv) as the working directory of FirePM does for one building. the buildings are shared out among the worker processes (-j,
+ * the number of CPUs by default), every worker is pinned to a CPU and monitors its buildings in one event loop with one inotify descriptor.
+ * a building only keeps its own state (struct FPMBuilding, about 30 kilobytes), the large working arrays (the records of FDS_DynIn,
+ * FDS_OutputsRlt*, FDS_RSMResults, FDS_SmInfo) are shared by the buildings of a worker: the state of a building, including the head line of its
+ * Dyn.txt (FDS_DynIn[0]), is put into the globals used by UpdateFPM() when the building is updated (FPMBuildingEnter()) and taken back after
+ * that (FPMBuildingLeave())
+ *************************************************************************************************************************************************/
+#define FPMMAXWORKERS 256
+
+struct FPMBuilding
+{
+    char dir[1024];                  // the directory of the building
+    char cfg[256];                   // the configuration file in dir
+    int dfd;                         // the directory opened, -1: not opened
+    int wd;                          // the inotify watch of the directory, -1: no watch
+    int on;                          // 1: monitored, 0: stopped by an error
+    int started;                     // 1: the files found at the start have been read in
+    int touched;                     // 1: inotify reported a file of the building
+    struct FPMWatch fw[FPMWATCHNUM];
+    struct DynTail tail;
+    struct VarInCol head;            // FDS_DynIn[0], the head line of Dyn.txt, read only once by readinDyn()
+    struct VarInCol in[2];           // FDS_InputsVar
+    struct VarOutCol out[2];         // FDS_OutputsVar
+    struct SenMatrix sm;             // SenMatxNum
+    struct RSMCoef coef;             // RSMCoefs, built when RSMRlt.csv of the building is read in
+    struct SymTable sym_in;          // FPMSyms.in
+    struct SymTable sym_out;         // FPMSyms.out
+};
+
+// put the state of a building into the globals and make its directory the working directory
+void FPMBuildingEnter( struct FPMBuilding *_b )
+{
+    if( fchdir(_b->dfd) != 0 )
+        printf( "fchdir() error, building [%s]: %s\n", _b->dir, strerror(errno) );
+    memcpy( &(FDS_DynIn[0]), &(_b->head), sizeof(_b->head) );
+    memcpy( FDS_InputsVar, _b->in, sizeof(_b->in) );
+    memcpy( FDS_OutputsVar, _b->out, sizeof(_b->out) );
+    memcpy( &SenMatxNum, &(_b->sm), sizeof(_b->sm) );
+    memcpy( &RSMCoefs, &(_b->coef), sizeof(_b->coef) );
+    FPMSyms.in = _b->sym_in;
+    FPMSyms.out = _b->sym_out;
+}
+
+// take the state of a building back from the globals, the symbol tables stay with the building, and go back to the directory _home
+void FPMBuildingLeave( struct FPMBuilding *_b, int _home )
+{
+    memcpy( &(_b->head), &(FDS_DynIn[0]), sizeof(_b->head) );
+    memcpy( &(_b->sm), &SenMatxNum, sizeof(_b->sm) );
+    memcpy( &(_b->coef), &RSMCoefs, sizeof(_b->coef) );
+    memset( &(FPMSyms.in), 0x0, sizeof(struct SymTable) );  // not freed by the FPMSymsBuild() of the next building
+    memset( &(FPMSyms.out), 0x0, sizeof(struct SymTable) );
+    if( fchdir(_home) != 0 )
+        printf( "fchdir() error, the working directory: %s\n", strerror(errno) );
+}
+
+/*************************************************************************************************************************************************
+ * Function: read in the configuration file and the output base values of a building, SMT.csv, RSMRlt.csv and Dyn.txt are read in by the first
+ *           update
+ * _b: input/output parameter indicating the building, dir and cfg are set
+ * _home: input parameter indicating the working directory of FirePM
+ * Return: 0: success
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMBuildingLoad( struct FPMBuilding *_b, int _home )
+{
+    int rt=0;
+
+    _b->wd = -1;
+    _b->dfd = open( _b->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if( _b->dfd < 0 || fchdir(_b->dfd) != 0 )
+    {
+        printf( "cannot open the directory of the building [%s]: %s\n", _b->dir, strerror(errno) );
+        return -1;
+    }
+    printf( "loading building [%s], configuration file [%s]...\n", _b->dir, _b->cfg );
+    SenMatrixClear( &SenMatxNum );
+    memset( &RSMCoefs, 0x0, sizeof(RSMCoefs) );
+    rt = FPMLoadConfig( _b->cfg );
+    if( rt == 0 )
+    {
+        memcpy( _b->in, FDS_InputsVar, sizeof(_b->in) );
+        memcpy( _b->out, FDS_OutputsVar, sizeof(_b->out) );
+        _b->sym_in = FPMSyms.in;
+        _b->sym_out = FPMSyms.out;
+        FPMWatchFiles( _b->fw );
+        memset( &(FDS_DynIn[0]), 0x0, sizeof(struct VarInCol) ); // the head line of Dyn.txt is read in by the first update
+        FPMBuildingLeave( _b, _home );
+        _b->on = 1;
+    } else if( fchdir(_home) != 0 )
+        printf( "fchdir() error, the working directory: %s\n", strerror(errno) );
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * Function: read the buildings of one worker from the list file, building i (from 0) belongs to worker i % _nw
+ * _list_fn: input parameter indicating the list file
+ * _w: input parameter indicating the worker
+ * _nw: input parameter indicating the number of the workers
+ * _bs: output parameter holding the buildings of the worker, allocated by this function, NULL: only count the buildings
+ * Return: the number of the buildings of the worker, -1: failure
+ *************************************************************************************************************************************************/
+int FPMBuildingsRead( const char *_list_fn, int _w, int _nw, struct FPMBuilding **_bs )
+{
+    char Info[MAXSTRINGSIZE];
+    int i=0, n=0;
+    FILE *fp = fopen( _list_fn, "r" );
+
+    if( fp == NULL )
+    {
+        printf( "fopen() error, _list_fn=[%s]\n", _list_fn );
+        return -1;
+    }
+    if( _bs != NULL )
+        *_bs = NULL;
+    memset( Info, 0x0, sizeof(Info) );
+    while( fgets(Info, sizeof(Info), fp) != NULL )
+    {
+        struct FPMBuilding *tmp_bs = NULL;
+
+        if( strlen(trim(Info, NULL)) == 0 || Info[0] == '#' )
+            continue;
+        if( (i++) % _nw != _w )
+            continue;
+        if( _bs == NULL )
+        {
+            n++;
+            continue;
+        }
+        tmp_bs = realloc( *_bs, sizeof(struct FPMBuilding)*(n+1) );
+        if( tmp_bs == NULL )
+        {
+            printf( "FPMBuildingsRead() error: memory allocation for [%d] buildings failed!\n", n+1 );
+            fclose( fp );
+            return -1;
+        }
+        *_bs = tmp_bs;
+        memset( &(tmp_bs[n]), 0x0, sizeof(struct FPMBuilding) );
+        tmp_bs[n].dfd = -1;
+        tmp_bs[n].wd = -1;
+        if( sscanf(Info, "%1023s %255s", tmp_bs[n].dir, tmp_bs[n].cfg) < 2 )
+            sprintf( tmp_bs[n].cfg, "%s", "SM_Info.txt" );
+        n++;
+    }
+    fclose( fp );
+    return n;
+}
+
+/*************************************************************************************************************************************************
+ * Function: sleep until a file of a building is written, or at most _timeout milliseconds, and mark the written files changed. the files of all
+ *           the buildings are also checked by their modified time and size when the timer wakes up, when inotify has lost events, and at least
+ *           every _timeout milliseconds even if the events of some buildings keep waking the worker up
+ * _ifd: input parameter indicating the inotify descriptor of the worker, -1: the timer only
+ * _bs: input/output parameter indicating the buildings of the worker
+ * _num: input parameter indicating the number of the buildings
+ * _map: input parameter indicating the positions in _bs of the watched buildings, in the ascending order of their watches
+ * _nmap: input parameter indicating the length of _map
+ * _home: input parameter indicating the working directory of FirePM
+ * _timeout: input parameter indicating the longest time to sleep in milliseconds
+ * _full: input/output parameter indicating the time of the last check of all the buildings (FPMNowNs())
+ * Return: 0: woken up by inotify
+ *         1: woken up by the timer
+ *************************************************************************************************************************************************/
+int FPMWorkerWait( int _ifd, struct FPMBuilding *_bs, int _num, const int *_map, int _nmap, int _home, int _timeout, long long *_full )
+{
+    struct pollfd tmp_pfd;
+    int i=0, j=0, rt=1, tmp_all=0;
+    long long tmp_now=0;
+
+    memset( &tmp_pfd, 0x0, sizeof(tmp_pfd) );
+    tmp_pfd.fd = _ifd;
+    tmp_pfd.events = POLLIN;
+    if( poll(&tmp_pfd, 1, _timeout) > 0 )
+    {
+        char tmp_events[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t tmp_len = 0;
+
+        rt = 0;
+        while( (tmp_len = read(_ifd, tmp_events, sizeof(tmp_events))) > 0 )
+        {
+            char *tmp_p = tmp_events;
+            for( ; tmp_p < tmp_events + tmp_len; tmp_p += sizeof(struct inotify_event) + ((struct inotify_event *)tmp_p)->len )
+            {
+                struct inotify_event *tmp_ev = (struct inotify_event *)tmp_p;
+                struct FPMBuilding *tmp_b = NULL;
+                int tmp_lo = 0, tmp_hi = _nmap-1;
+
+                if( tmp_ev->mask & IN_Q_OVERFLOW ) // events are lost, all the buildings are checked
+                    tmp_all = 1;
+                if( _nmap == 0 || tmp_ev->len == 0 )
+                    continue;
+                // the building of a watch is found by a binary search in _map
+                while( tmp_lo < tmp_hi )
+                {
+                    int tmp_mid = (tmp_lo + tmp_hi) / 2;
+                    if( _bs[_map[tmp_mid]].wd < tmp_ev->wd )
+                        tmp_lo = tmp_mid + 1;
+                    else
+                        tmp_hi = tmp_mid;
+                }
+                tmp_b = &(_bs[_map[tmp_lo]]);
+                if( tmp_b->wd != tmp_ev->wd )
+                    continue;
+                for( j=0; j<FPMWATCHNUM; j++ )
+                {
+                    if( strcmp(tmp_ev->name, tmp_b->fw[j].fn) == 0 )
+                    {
+                        tmp_b->fw[j].changed = 1;
+                        tmp_b->touched = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // the timer fallback for all the buildings, and the modified time of the buildings reported by inotify
+    tmp_now = FPMNowNs();
+    if( rt == 1 || tmp_now - *_full >= _timeout*1000000LL )
+        tmp_all = 1;
+    if( tmp_all == 1 )
+        *_full = tmp_now;
+    for( i=0; i<_num; i++ )
+    {
+        if( _bs[i].on == 0 || (tmp_all == 0 && _bs[i].touched == 0) || fchdir(_bs[i].dfd) != 0 )
+            continue;
+        for( j=0; j<FPMWATCHNUM; j++ )
+            FPMWatchStat( &(_bs[i].fw[j]) );
+        _bs[i].touched = 0;
+    }
+    if( fchdir(_home) != 0 )
+        printf( "fchdir() error, the working directory: %s\n", strerror(errno) );
+    return rt;
+}
+
+/*************************************************************************************************************************************************
+ * Function: the event loop of one worker, it monitors the buildings of the worker and never returns unless all of them are stopped
+ * _list_fn: input parameter indicating the list file of the buildings
+ * _w: input parameter indicating the worker
+ * _nw: input parameter indicating the number of the workers
+ * Return: -1: failure
+ *************************************************************************************************************************************************/
+int FPMWorkerRun( const char *_list_fn, int _w, int _nw )
+{
+    struct FPMBuilding *tmp_bs = NULL;
+    int *tmp_map = NULL; // the positions in tmp_bs of the watched buildings, see FPMWorkerWait()
+    int i=0, j=0, tmp_num=0, tmp_on=0, tmp_ifd=-1, tmp_home=-1, tmp_wd=0, tmp_nmap=0;
+    long long tmp_full = FPMNowNs();
+
+    SenMatrixClear( &SenMatxNum );
+    memset( FDS_OutputsRltSMT, '\0', sizeof(FDS_OutputsRltSMT));
+    memset( FDS_DynIn, '\0', sizeof(FDS_DynIn));
+    tmp_num = FPMBuildingsRead( _list_fn, _w, _nw, &tmp_bs );
+    tmp_home = open( ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    tmp_ifd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if( tmp_num <= 0 || tmp_home < 0 )
+    {
+        printf( "worker [%d]: no building to monitor\n", _w );
+        return -1;
+    }
+    tmp_map = calloc( tmp_num, sizeof(int) );
+    if( tmp_map == NULL )
+    {
+        printf( "worker [%d]: memory allocation for [%d] buildings failed!\n", _w, tmp_num );
+        return -1;
+    }
+    if( tmp_ifd < 0 )
+        printf( "worker [%d]: inotify_init1() failed, the files are checked every second\n", _w );
+
+    for( i=0; i<tmp_num; i++ )
+    {
+        struct FPMBuilding *tmp_b = &(tmp_bs[i]);
+
+        if( FPMBuildingLoad(tmp_b, tmp_home) != 0 )
+        {
+            printf( "building [%s] cannot be loaded, it is not monitored\n", tmp_b->dir );
+            continue;
+        }
+        // the directory is watched instead of the files, a file replaced by rename() is still reported
+        if( tmp_ifd >= 0 )
+            tmp_b->wd = inotify_add_watch( tmp_ifd, tmp_b->dir, IN_CLOSE_WRITE | IN_MOVED_TO );
+        if( tmp_ifd >= 0 && tmp_b->wd <= tmp_wd )
+        {
+            printf( "building [%s] shares its directory with another building or cannot be watched, it is not monitored\n", tmp_b->dir );
+            tmp_b->wd = -1;
+            tmp_b->on = 0;
+            continue;
+        }
+        // the watches only increase, so tmp_map is in their ascending order, a building without a watch is left out
+        if( tmp_b->wd >= 0 )
+        {
+            tmp_wd = tmp_b->wd;
+            tmp_map[tmp_nmap++] = i;
+        }
+    }
+    for( i=0, j=0; i<tmp_num; i++ )
+        j += tmp_bs[i].on;
+    printf( "worker [%d]: monitoring [%d] buildings, [%ld] bytes for each\n", _w, j, (long)sizeof(struct FPMBuilding) );
+
+    while(1)
+    {
+        tmp_on = 0;
+        for( i=0; i<tmp_num; i++ )
+        {
+            struct FPMBuilding *tmp_b = &(tmp_bs[i]);
+
+            if( tmp_b->on == 0 )
+                continue;
+            tmp_on++;
+            for( j=0; j<FPMWATCHNUM && tmp_b->fw[j].changed == 0; j++ )
+                ;
+            if( j == FPMWATCHNUM )
+                continue;
+
+            printf( "updating building [%s]...\n", tmp_b->dir );
+            FPMBuildingEnter( tmp_b );
+            if( FPMUpdateFiles(tmp_b->fw, &(tmp_b->tail), 0, tmp_b->started) != 0 )
+            {
+                printf( "building [%s] failed to be updated, it is not monitored any more\n", tmp_b->dir );
+                tmp_b->on = 0;
+            }
+            FPMBuildingLeave( tmp_b, tmp_home );
+            tmp_b->started = 1;
+        }
+        if( tmp_on == 0 )
+        {
+            printf( "worker [%d]: no building is monitored any more\n", _w );
             return -1;
         }
-        if( UpdateFPM("FirePM.csv") != 0 )
+        fflush( stdout );
+        FPMStatDump( 0 );
+        FPMWorkerWait( tmp_ifd, tmp_bs, tmp_num, tmp_map, tmp_nmap, tmp_home, 1000, &tmp_full );
+    }
+    return -1;
+}
+
+// pin the calling process to the CPU _cpu, the system call is used directly so that _GNU_SOURCE is not needed for sched_setaffinity()
+int FPMWorkerPin( int _cpu )
+{
+    unsigned long tmp_mask[1024/(8*sizeof(unsigned long))];
+
+    memset( tmp_mask, 0x0, sizeof(tmp_mask) );
+    tmp_mask[_cpu/(8*sizeof(unsigned long))] |= 1UL << (_cpu % (8*sizeof(unsigned long)));
+    if( syscall(SYS_sched_setaffinity, 0, sizeof(tmp_mask), tmp_mask) != 0 )
+    {
+        printf( "sched_setaffinity() error, CPU [%d]: %s\n", _cpu, strerror(errno) );
+        return -1;
+    }
+    return 0;
+}
+
+/*************************************************************************************************************************************************
+ * Function: monitor the buildings listed in a file by a pool of worker processes, SIGUSR1 is passed to the workers, every worker writes its
+ *           latency statistics to FirePM.<worker>.stats
+ * _list_fn: input parameter indicating the list file of the buildings
+ * _nw: input parameter indicating the number of the workers, 0: the number of CPUs
+ * Return: 0: all the workers ended
+ *         -1: failure
+ *************************************************************************************************************************************************/
+int FPMFleetRun( const char *_list_fn, int _nw )
+{
+    pid_t tmp_pid[FPMMAXWORKERS];
+    int i=0, tmp_num=0, tmp_left=0, tmp_status=0;
+    long tmp_ncpu = sysconf( _SC_NPROCESSORS_ONLN );
+
+    tmp_num = FPMBuildingsRead( _list_fn, 0, 1, NULL );
+    if( tmp_num <= 0 )
+    {
+        printf( "no building is listed in [%s]\n", _list_fn );
+        return -1;
+    }
+    if( tmp_ncpu < 1 )
+        tmp_ncpu = 1;
+    if( tmp_ncpu > 1024 )
+        tmp_ncpu = 1024;
+    if( _nw <= 0 )
+        _nw = (int)tmp_ncpu;
+    if( _nw > tmp_num )
+        _nw = tmp_num;
+    if( _nw > FPMMAXWORKERS )
+        _nw = FPMMAXWORKERS;
+    printf( "monitoring [%d] buildings listed in [%s] by [%d] workers\n", tmp_num, _list_fn, _nw );
+    fflush( stdout );
+
+    for( i=0; i<_nw; i++ )
+    {
+        tmp_pid[i] = fork();
+        if( tmp_pid[i] == 0 )
+        {
+            FPMWorkerPin( i % (int)tmp_ncpu );
+            sprintf( FPMStatFn, "FirePM.%d.stats", i );
+            exit( FPMWorkerRun(_list_fn, i, _nw) == 0 ? 0 : 1 );
+        }
+        if( tmp_pid[i] < 0 )
         {
-            printf( "UpdateFPM() error !\n" );
+            printf( "fork() error, worker [%d]: %s\n", i, strerror(errno) );
+            break;
+        }
+    }
+    tmp_left = i;
+
+    while( tmp_left > 0 )
+    {
+        pid_t tmp_p = waitpid( -1, &tmp_status, 0 );
+        if( tmp_p > 0 )
+        {
+            tmp_left--;
+            printf( "worker process [%d] ended, [%d] left\n", (int)tmp_p, tmp_left );
+            continue;
+        }
+        if( errno != EINTR )
+            break;
+        if( FPMStatSignal == 1 ) // kill -USR1 to this process prints the statistics of all the workers
+        {
+            FPMStatSignal = 0;
+            for( i=0; i<_nw; i++ )
+            {
+                if( tmp_pid[i] > 0 )
+                    kill( tmp_pid[i], SIGUSR1 );
+            }
+        }
+    }
+    return 0;
+}
+
+int main( int argc, char ** argv )
+{
+    char *tmp_ret=NULL;
+    struct FPMWatch tmp_fw[FPMWATCHNUM];
+    struct DynTail tmp_tail;
+    int tmp_ifd=-1, tmp_timer=1, tmp_opt=0, tmp_started=0;
+    char *tmp_sock_fn=NULL, *tmp_pipe_fn=NULL, *tmp_ring_fn=NULL, *tmp_list_fn=NULL;
+    int tmp_nw=0;
+    struct sigaction tmp_sa;
+    
+    // -u path: also take the records of the dynamically changed input data from a Unix domain socket, -p path: from a named pipe,
+    // -s path: from a shared memory ring. -b list: monitor the buildings listed in a file by -j workers
+    while( (tmp_opt = getopt(argc, argv, "u:p:s:b:j:")) != -1 )
+    {
+        if( tmp_opt == 'u' )
+            tmp_sock_fn = optarg;
+        else if( tmp_opt == 'p' )
+            tmp_pipe_fn = optarg;
+        else if( tmp_opt == 's' )
+            tmp_ring_fn = optarg;
+        else if( tmp_opt == 'b' )
+            tmp_list_fn = optarg;
+        else if( tmp_opt == 'j' )
+            tmp_nw = atoi( optarg );
+        else
+        {
+            printf( "usage: %s [-u socket] [-p pipe] [-s ring] SM_Info.txt\n", argv[0] );
+            printf( "       %s -b buildings.txt [-j workers]\n", argv[0] );
+            return -1;
+        }
+    }
+
+    // kill -USR1 prints the latency statistics, they are also written to FPMStatFn every FPMSTATPERIOD seconds
+    memset( &tmp_sa, 0x0, sizeof(tmp_sa) );
+    tmp_sa.sa_handler = FPMStatOnSignal;
+    sigemptyset( &(tmp_sa.sa_mask) );
+    sigaction( SIGUSR1, &tmp_sa, NULL );
+    FPMStat.dumped = FPMNowNs();
+
+    if( tmp_list_fn != NULL )
+    {
+        if( argc != optind || tmp_sock_fn != NULL || tmp_pipe_fn != NULL || tmp_ring_fn != NULL )
+        {
+            printf( "-b takes the configuration files from the list, and the buildings only read their Dyn.txt\n" );
             return -1;
         }
-        tmp_t1_Dyn=tmp_t2_Dyn;
-    } else{
-       printf( "no modification made to Dyn.txt since %s.\n", ctime(&tmp_t1_Dyn)) ; 
+        return FPMFleetRun( tmp_list_fn, tmp_nw );
     }
+    if ( argc - optind != 1 )
+    {
+        int i=0;
+        for ( i=0; i<argc; i++ )
+           printf( "%s\n", argv[i] );
+        printf( "only one argument is needed, you have [%d] arguments\n" , argc);
+        printf( "usage: %s [-u socket] [-p pipe] [-s ring] SM_Info.txt\n", argv[0] );
+        printf( "       %s -b buildings.txt [-j workers]\n", argv[0] );
+        return -1;
+    }
+    SenMatrixClear( &SenMatxNum );
+    memset( FDS_OutputsRltSMT, '\0', sizeof(FDS_OutputsRltSMT));
+    memset( FDS_DynIn, '\0', sizeof(FDS_DynIn));
+    memset( &tmp_tail, '\0', sizeof(tmp_tail));
+
+    if( FPMLoadConfig(argv[optind]) != 0 )
+        return -1;
+
+ if( FPMIngestInit(&FPMIng, tmp_sock_fn, tmp_pipe_fn, tmp_ring_fn) != 0 )
+ {
+     printf( "FPMIngestInit() error!\n" );
+     return -1;
+ }
+ tmp_ifd = FPMWatchInit( tmp_fw );
+ while(1)
+ {
+    if( FPMUpdateFiles(tmp_fw, &tmp_tail, tmp_timer, tmp_started) != 0 )
+        return -1;
+
+    if( FPMIng.on == 1 )
+    {
+        int tmp_num=0;
+        do{ // the streamed records are predicted as soon as they are received
+            if( FPMIngestFlush(&FPMIng, "FirePM.csv", &tmp_num) != 0 )
+            {
+                printf( "UpdateFPM() error !\n" );
+                return -1;
+            }
+        }while( tmp_num == MAXLINENUM-2 );
+    }
+
+    FPMStatDump( 0 );
+    tmp_started = 1;
 
+    // react to the written files at once, the "no modification" lines are only printed once a second by the timer
+    tmp_timer = FPMWatchWait( tmp_ifd, tmp_fw, &FPMIng, 1000 );
   }
 
   return 0;
@@ -1,16 +1,88 @@
 #include  "FirePM.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*************************************************************************************************************************************************
+ * Function: put one record into the shared memory ring of FirePM, the values are put into the columns of the ring with the same alias
+ * _r: input/output parameter indicating the ring
+ * _head: input parameter indicating the aliases of the values ("Time,alias1,alias2,...")
+ * _str: input parameter indicating the record, a line of Dyn.txt
+ * _seq: input parameter indicating the sequence number of the record
+ * Return: 0: success
+ *         -1: failure, the ring is full
+ *************************************************************************************************************************************************/
+int PutRingRec( struct FPMRing *_r, const char *_head, const char *_str, unsigned long long _seq )
+{
+    char tmp_head[MAXSTRINGSIZE], tmp_str[MAXSTRINGSIZE];
+    char *tmp_hs = NULL, *tmp_vs = NULL, *tmp_alias = NULL, *tmp_val = NULL;
+    struct FPMRingRec tmp_rec;
+    int i=0, j=0;
+
+    memset( &tmp_rec, 0x0, sizeof(tmp_rec) );
+    snprintf( tmp_head, sizeof(tmp_head), "%s", _head );
+    snprintf( tmp_str, sizeof(tmp_str), "%s", _str );
+    tmp_alias = strtok_r( trim(tmp_head, NULL), ",", &tmp_hs );
+    tmp_val = strtok_r( trim(tmp_str, NULL), ",", &tmp_vs );
+    if( tmp_val == NULL )
+        return 0;
+    tmp_rec.seq = _seq;
+    tmp_rec.time = atof( tmp_val );
+    snprintf( tmp_rec.timestr, sizeof(tmp_rec.timestr), "%s", tmp_val );
+    while( (tmp_alias = strtok_r(NULL, ",", &tmp_hs)) != NULL && (tmp_val = strtok_r(NULL, ",", &tmp_vs)) != NULL )
+    {
+        for( i=0; i<_r->nin && strcmp(_r->alias[i], tmp_alias) != 0; i++ )
+            ;
+        if( i == _r->nin ) // not an input of FirePM
+            continue;
+        for( j=0; j<FPMRINGCOORD && tmp_val != NULL; j++ ) // a geometric value is x1|x2|y1|y2|z1|z2
+        {
+            tmp_rec.v[i][j] = strtod( tmp_val, &tmp_val );
+            tmp_val = (*tmp_val == '|') ? tmp_val+1 : NULL;
+        }
+        tmp_rec.ncoord[i] = j;
+    }
+    tmp_rec.stamp = FPMNowNs();
+    return FPMRingPut( _r, &tmp_rec );
+}
 
 //this is a tool  to simulate the generation process of the dynamically changed input file (Dyn.txt)
-int main()
+// -u path: send the records to the Unix domain socket of FirePM (FirePM -u path) instead of rewriting Dyn.txt
+// -s path: put the records into the shared memory ring of FirePM (FirePM -s path)
+int main( int argc, char ** argv )
 {
-    int record=0;
+    int record=0, sock=-1;
+    struct FPMRing *ring=NULL;
     char *HL = "Sequence,Var1,Var2,Var3,Var4\nTime,CDW,SY,EX,HRR\n";
+    char *HEAD = "Time,CDW,SY,EX,HRR\n"; // the head line sent to the socket, the aliases of the values put into the ring
     //char *HL = "Sequence,Var1,Var2,Var3\nTime,PT,NIP,VL\n";
     char tmp_line[MAXSTRINGSIZE];
     FILE *fp=NULL;
 
     
     memset(tmp_line, 0x0, sizeof(tmp_line) );
+    if( argc == 3 && strcmp(argv[1], "-u") == 0 )
+    {
+        struct sockaddr_un addr;
+
+        memset( &addr, 0x0, sizeof(addr) );
+        addr.sun_family = AF_UNIX;
+        snprintf( addr.sun_path, sizeof(addr.sun_path), "%s", argv[2] );
+        sock = socket( AF_UNIX, SOCK_STREAM, 0 );
+        if( sock < 0 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || write(sock, HEAD, strlen(HEAD)) < 0 )
+        {
+            printf( "connect to %s error !\n", argv[2] );
+            return -1;
+        }
+    } else if( argc == 3 && strcmp(argv[1], "-s") == 0 )
+    {
+        ring = FPMRingOpen( argv[2], NULL );
+        if( ring == NULL )
+            return -1;
+    } else if( argc != 1 )
+    {
+        printf( "usage: %s [-u socket | -s ring]\n", argv[0] );
+        return -1;
+    }
     
     while(1)
     {
@@ -22,14 +94,6 @@ int main()
 
         sleep(1);
 
-        fp= fopen("Dyn.txt", "w+" );
-        if( fp==NULL)
-        {
-            printf( "open Dyn.txt error !\n" );
-            return -1;
-        }
-
-        fprintf( fp, "%s", HL );       
         x1 = rand_double2( -44.8, -43.6 );
         SY = rand_double2( 0.01, 0.09 );
         EX = rand_double2( 0.05, 0.5 );
@@ -41,11 +105,33 @@ int main()
         VL = rand_double2( 0.7, 1.3);
         sprintf(str, "%d,%.2f,%.2f,%.2f\n", record++, PT, NIP, VL);	 
 */
-        fprintf(fp,str);
+        if( ring != NULL )
+        {
+            if( PutRingRec(ring, HEAD, str, record-1) != 0 ) // the sequence of the record written in str
+                printf( "the ring %s is full, a record is dropped\n", argv[2] );
+        } else if( sock >= 0 )
+        {
+            if( write(sock, str, strlen(str)) < 0 )
+            {
+                printf( "write to %s error !\n", argv[2] );
+                return -1;
+            }
+        } else { // Dyn.txt is published as a snapshot, FirePM never reads it half written
+            fp= FPMSnapCreate("Dyn.txt", 0);
+            if( fp==NULL)
+            {
+                printf( "open Dyn.txt error !\n" );
+                return -1;
+            }
+
+            fprintf( fp, "%s", HL );       
+            fprintf(fp,str);
+            if( FPMSnapPublish("Dyn.txt", fp, 0) != 0 )
+                return -1;
+        }
 
         printf("\t\t\t%s\r",trim(str,NULL));
         fflush(stdout);
-        fclose(fp);
     }
 
     return 0;
@@ -0,0 +1,28 @@
+#!/bin/bash
+# Rfds.sh: a stand-in of one FDS run to try ./DoA -s on a local machine without running FDS.
+# the lines of a finished CHID_devc.csv are appended to a new CHID_devc.csv one by one every DELAY seconds, as a running FDS writes them,
+# and the run ends as FDS does once the file CHID.stop appears in the directory of the new csv file.
+# usage: ./Rfds.sh finished_devc.csv new_dir/CHID_devc.csv [DELAY]
+#   e.g. mv IRP/P_EX_0D500000_devc.csv /tmp/ ; ./DoA -s 10 -f 30 SM_Info.txt & ./Rfds.sh /tmp/P_EX_0D500000_devc.csv IRP/P_EX_0D500000_devc.csv 0.05
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 finished_devc.csv new_dir/CHID_devc.csv [DELAY]"
+    exit 1
+fi
+src=$1
+dst=$2
+delay=${3:-0.1}
+stop="${dst%_*}.stop"
+
+rm -f "$dst" "$stop"
+n=0
+while IFS= read -r line || [ -n "$line" ]; do
+    printf '%s\n' "$line" >> "$dst"
+    n=$((n+1))
+    if [ -f "$stop" ]; then
+        echo "STOP: FDS stopped by user ($stop), $n lines of $src written"
+        exit 0
+    fi
+    sleep "$delay"
+done < "$src"
+echo "STOP: FDS completed successfully, $n lines of $src written"